@@ -0,0 +1,79 @@
+# sgl_embed_shaders(<target> [NAMESPACE <ns>] [HEADER <file.h>] FILES <files...>)
+#
+# bakes the files into a generated header of constexpr sgl::embedded_source values (internal/sgl_embed.h):
+# shaders/basic.vert becomes <ns>::basic_vert (default namespace "shaders", header "embedded_shaders.h").
+# the header is regenerated at build time whenever one of the files changes.
+# C++20 compilers have no #embed yet: the text goes into raw string literals
+
+if (CMAKE_SCRIPT_MODE_FILE)
+    # cmake -P mode: SGL_EMBED_OUTPUT, SGL_EMBED_NAMESPACE, SGL_EMBED_BASE, SGL_EMBED_FILES ('|' separated)
+    string(REPLACE "|" ";" files "${SGL_EMBED_FILES}")
+
+    set(content "// generated by sgl_embed_shaders(), do not edit\n\n#pragma once\n\n")
+    string(APPEND content "#include \"internal/sgl_embed.h\"\n\nnamespace ${SGL_EMBED_NAMESPACE} {\n")
+
+    foreach (file IN LISTS files)
+        get_filename_component(name "${file}" NAME)
+        string(MAKE_C_IDENTIFIER "${name}" id)
+        file(RELATIVE_PATH rel "${SGL_EMBED_BASE}" "${file}")
+        file(READ "${file}" text)
+
+        string(FIND "${text}" ")sgl_embed\"" clash)
+        if (NOT clash EQUAL -1)
+            message(FATAL_ERROR "sgl_embed_shaders: ${file} contains the raw string delimiter")
+        endif ()
+
+        string(APPEND content "    inline constexpr sgl::embedded_source ${id}{\n")
+        string(APPEND content "        \"${rel}\",\n        R\"sgl_embed(${text})sgl_embed\"\n    };\n")
+    endforeach ()
+
+    string(APPEND content "}\n")
+
+    # only touch the header when it changes, so dependents do not rebuild for nothing
+    file(WRITE "${SGL_EMBED_OUTPUT}.tmp" "${content}")
+    execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${SGL_EMBED_OUTPUT}.tmp" "${SGL_EMBED_OUTPUT}")
+    file(REMOVE "${SGL_EMBED_OUTPUT}.tmp")
+    return()
+endif ()
+
+set(SGL_EMBED_SCRIPT ${CMAKE_CURRENT_LIST_FILE})
+
+function(sgl_embed_shaders target)
+    cmake_parse_arguments(ARG "" "NAMESPACE;HEADER" "FILES" ${ARGN})
+
+    if (NOT ARG_FILES)
+        message(FATAL_ERROR "sgl_embed_shaders(${target}): no FILES")
+    endif ()
+    if (NOT ARG_NAMESPACE)
+        set(ARG_NAMESPACE shaders)
+    endif ()
+    if (NOT ARG_HEADER)
+        set(ARG_HEADER embedded_shaders.h)
+    endif ()
+
+    set(out_dir ${CMAKE_CURRENT_BINARY_DIR}/${target}_embed)
+    set(out ${out_dir}/${ARG_HEADER})
+
+    set(abs_files)
+    foreach (file IN LISTS ARG_FILES)
+        get_filename_component(abs "${file}" ABSOLUTE)
+        list(APPEND abs_files "${abs}")
+    endforeach ()
+    string(REPLACE ";" "|" files_arg "${abs_files}")
+
+    add_custom_command(
+            OUTPUT ${out}
+            COMMAND ${CMAKE_COMMAND}
+            -DSGL_EMBED_OUTPUT=${out}
+            -DSGL_EMBED_NAMESPACE=${ARG_NAMESPACE}
+            -DSGL_EMBED_BASE=${CMAKE_CURRENT_SOURCE_DIR}
+            -DSGL_EMBED_FILES=${files_arg}
+            -P ${SGL_EMBED_SCRIPT}
+            DEPENDS ${abs_files} ${SGL_EMBED_SCRIPT}
+            COMMENT "Embedding shaders for ${target}"
+            VERBATIM
+    )
+
+    target_sources(${target} PRIVATE ${out})
+    target_include_directories(${target} PRIVATE ${out_dir})
+endfunction()
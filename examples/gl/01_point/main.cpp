@@ -8,13 +8,12 @@ draw a point
 
 #include "glad/glad.h"
 
+#include "embedded_shaders.h"
+
 static constexpr int WIDTH = 1920;
 static constexpr int HEIGHT = 1080;
 static constexpr auto TITLE = __FILE__;
 
-static constexpr auto VERTEX_SHADER_PATH = "shaders/shader.vert";
-static constexpr auto FRAGMENT_SHADER_PATH = "shaders/shader.frag";
-
 struct vertex {
     sgl::gl_float pos[3]{};
     sgl::color color{};
@@ -49,7 +48,7 @@ int main() {
     sgl::vertex_buffer::unbind();
     sgl::vertex_array::unbind();
 
-    const auto shader = sgl::shader::create_from_files_try(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+    const auto shader = sgl::shader::create_from_source_try(shaders::shader_vert, shaders::shader_frag);
 
     glEnable(GL_PROGRAM_POINT_SIZE);
     glPointSize(30.f);
@@ -62,7 +61,7 @@ int main() {
         shader.use();
         vao.bind();
 
-        glDrawArrays(GL_POINTS, 0, vertices.size());
+        sgl::render::draw_arrays(GL_POINTS, 0, vertices.size());
 
         sgl::vertex_array::unbind();
 
@@ -8,13 +8,12 @@ draw a line
 
 #include "glad/glad.h"
 
+#include "embedded_shaders.h"
+
 static constexpr int WIDTH = 1920;
 static constexpr int HEIGHT = 1080;
 static constexpr auto TITLE = __FILE__;
 
-static constexpr auto VERTEX_SHADER_PATH = "shaders/shader.vert";
-static constexpr auto FRAGMENT_SHADER_PATH = "shaders/shader.frag";
-
 struct vertex {
     sgl::gl_float pos[3]{};
     sgl::color color{};
@@ -47,7 +46,7 @@ int main() {
     sgl::vertex_buffer::unbind();
     sgl::vertex_array::unbind();
 
-    const auto shader = sgl::shader::create_from_files_try(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+    const auto shader = sgl::shader::create_from_source_try(shaders::shader_vert, shaders::shader_frag);
 
     glLineWidth(5.f);
 
@@ -59,7 +58,7 @@ int main() {
         shader.use();
         vao.bind();
 
-        glDrawArrays(GL_LINES, 0, vertices.size());
+        sgl::render::draw_arrays(GL_LINES, 0, vertices.size());
 
         sgl::vertex_array::unbind();
 
@@ -8,13 +8,12 @@ draw a rect
 
 #include "glad/glad.h"
 
+#include "embedded_shaders.h"
+
 static constexpr int WIDTH = 1920;
 static constexpr int HEIGHT = 1080;
 static constexpr auto TITLE = __FILE__;
 
-static constexpr auto VERTEX_SHADER_PATH = "shaders/shader.vert";
-static constexpr auto FRAGMENT_SHADER_PATH = "shaders/shader.frag";
-
 struct vertex {
     sgl::gl_float pos[3]{};
     sgl::color color{};
@@ -63,7 +62,7 @@ int main() {
     sgl::vertex_buffer::unbind();
     sgl::vertex_array::unbind();
 
-    const auto shader = sgl::shader::create_from_files_try(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+    const auto shader = sgl::shader::create_from_source_try(shaders::shader_vert, shaders::shader_frag);
 
     sgl::render::set_clear_color(sgl::colors::gray);
 
@@ -73,7 +72,7 @@ int main() {
         shader.use();
         vao.bind();
 
-        glDrawElements(GL_TRIANGLES, ebo.count(), ebo.type(), nullptr);
+        sgl::render::draw_elements(GL_TRIANGLES, ebo.count(), ebo.type(), nullptr);
 
         sgl::vertex_array::unbind();
 
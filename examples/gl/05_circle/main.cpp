@@ -9,13 +9,12 @@ draw a circle
 
 #include "glad/glad.h"
 
+#include "embedded_shaders.h"
+
 static constexpr int WIDTH = 1920;
 static constexpr int HEIGHT = 1080;
 static constexpr auto TITLE = __FILE__;
 
-static constexpr auto VERTEX_SHADER_PATH = "shaders/shader.vert";
-static constexpr auto FRAGMENT_SHADER_PATH = "shaders/shader.frag";
-
 constexpr std::size_t NUM_SEGMENTS = 128;
 constexpr std::size_t VERT_COUNT = NUM_SEGMENTS + 2;
 constexpr float RADIUS = 0.5f;
@@ -52,7 +51,7 @@ int main() {
     sgl::vertex_buffer::unbind();
     sgl::vertex_array::unbind();
 
-    const auto shader = sgl::shader::create_from_files_try(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+    const auto shader = sgl::shader::create_from_source_try(shaders::shader_vert, shaders::shader_frag);
 
     sgl::render::set_clear_color(sgl::colors::gray);
 
@@ -62,7 +61,7 @@ int main() {
         shader.use();
         vao.bind();
 
-        glDrawArrays(GL_TRIANGLE_FAN, 0, static_cast<sgl::gl_sizei>(VERT_COUNT));
+        sgl::render::draw_arrays(GL_TRIANGLE_FAN, 0, static_cast<sgl::gl_sizei>(VERT_COUNT));
 
         sgl::vertex_array::unbind();
 
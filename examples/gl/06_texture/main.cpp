@@ -8,12 +8,12 @@ draw a rect with texture
 
 #include "glad/glad.h"
 
+#include "embedded_shaders.h"
+
 static constexpr int WIDTH = 1920;
 static constexpr int HEIGHT = 1080;
 static constexpr auto TITLE = __FILE__;
 
-static constexpr auto VERTEX_SHADER_PATH = "shaders/shader.vert";
-static constexpr auto FRAGMENT_SHADER_PATH = "shaders/shader.frag";
 static constexpr auto TEXTURE_PATH = "textures/img1.png";
 
 struct vertex {
@@ -71,7 +71,7 @@ int main() {
     sgl::vertex_buffer::unbind();
     sgl::vertex_array::unbind();
 
-    const auto shader = sgl::shader::create_from_files_try(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+    const auto shader = sgl::shader::create_from_source_try(shaders::shader_vert, shaders::shader_frag);
 
     shader.use();
     constexpr sgl::gl_int v0 = 0;
@@ -86,7 +86,7 @@ int main() {
 
         shader.use();
         vao.bind();
-        glDrawElements(GL_TRIANGLES, static_cast<sgl::gl_sizei>(indices.size()), GL_UNSIGNED_SHORT, nullptr);
+        sgl::render::draw_elements(GL_TRIANGLES, static_cast<sgl::gl_sizei>(indices.size()), GL_UNSIGNED_SHORT, nullptr);
 
         window.swap_buffers();
         sgl::window::poll_events();
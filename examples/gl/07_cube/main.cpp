@@ -12,13 +12,12 @@ draw spinning cubes and spinning camera
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+#include "embedded_shaders.h"
+
 static constexpr int WIDTH = 1920;
 static constexpr int HEIGHT = 1080;
 static constexpr auto TITLE = __FILE__;
 
-static constexpr auto VERTEX_SHADER_PATH = "shaders/shader.vert";
-static constexpr auto FRAGMENT_SHADER_PATH = "shaders/shader.frag";
-
 static constexpr auto CAM_RADIUS = 12.f;
 
 using vec3 = glm::vec<3, sgl::gl_float>;
@@ -137,7 +136,7 @@ int main() {
     sgl::vertex_buffer::unbind();
     sgl::vertex_array::unbind();
 
-    const auto shader = sgl::shader::create_from_files_try(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+    const auto shader = sgl::shader::create_from_source_try(shaders::shader_vert, shaders::shader_frag);
 
     constexpr auto cam_target = glm::vec3(0.f, 0.f, 0.f);
     constexpr auto cam_up = glm::vec3(0.f, 1.f, 0.f);
@@ -183,7 +182,7 @@ int main() {
             model = glm::rotate(model, angle, glm::vec3(1.f, 1.f, 1.f));
 
             SGL_VERIFY(shader.set_uniform_mat4(U_MODEL, glm::value_ptr(model)));
-            glDrawElements(GL_TRIANGLES, static_cast<sgl::gl_sizei>(indices.size()), GL_UNSIGNED_INT, nullptr);
+            sgl::render::draw_elements(GL_TRIANGLES, static_cast<sgl::gl_sizei>(indices.size()), GL_UNSIGNED_INT, nullptr);
         }
 
         window.swap_buffers();
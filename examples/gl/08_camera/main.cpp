@@ -15,13 +15,12 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+#include "embedded_shaders.h"
+
 static constexpr int WIDTH = 1920;
 static constexpr int HEIGHT = 1080;
 static constexpr auto TITLE = __FILE__;
 
-static constexpr auto VERTEX_SHADER_PATH = "shaders/shader.vert";
-static constexpr auto FRAGMENT_SHADER_PATH = "shaders/shader.frag";
-
 using vec3 = glm::vec<3, sgl::gl_float>;
 
 struct vertex {
@@ -125,7 +124,6 @@ int main() {
         .width = WIDTH, .height = HEIGHT, .title = TITLE, .cursor_enabled = false
     });
 
-
     auto cam = sgl::camera::create(
         45.f,
         static_cast<float>(WIDTH) / static_cast<float>(HEIGHT),
@@ -155,7 +153,7 @@ int main() {
     sgl::vertex_buffer::unbind();
     sgl::vertex_array::unbind();
 
-    const auto shader = sgl::shader::create_from_files_try(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+    const auto shader = sgl::shader::create_from_source_try(shaders::shader_vert, shaders::shader_frag);
 
     shader.use(); {
         const auto proj = cam.projection();
@@ -220,7 +218,7 @@ void render_scene(const sgl::shader &shader, const sgl::vertex_array &vao, const
 
         SGL_VERIFY(shader.set_uniform_mat4(U_MODEL, glm::value_ptr(model)));
 
-        glDrawElements(
+        sgl::render::draw_elements(
             GL_TRIANGLES,
             static_cast<sgl::gl_sizei>(g_indices.size()),
             GL_UNSIGNED_INT,
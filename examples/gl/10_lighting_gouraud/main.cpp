@@ -17,16 +17,12 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+#include "embedded_shaders.h"
+
 static constexpr int WIDTH = 1920;
 static constexpr int HEIGHT = 1080;
 static constexpr auto TITLE = __FILE__;
 
-static constexpr auto OBJECT_VS_PATH = "shaders/object.vert";
-static constexpr auto OBJECT_FS_PATH = "shaders/object.frag";
-
-static constexpr auto LIGHT_VS_PATH = "shaders/light.vert";
-static constexpr auto LIGHT_FS_PATH = "shaders/light.frag";
-
 using vec3 = glm::vec<3, sgl::gl_float>;
 
 struct vertex {
@@ -153,8 +149,8 @@ int main() {
     cam.set_move_speed(MOVE_SPEED);
     cam.set_sens(MOVE_SENSE);
 
-    const auto obj_shader = sgl::shader::create_from_files_try(OBJECT_VS_PATH, OBJECT_FS_PATH);
-    const auto light_shader = sgl::shader::create_from_files_try(LIGHT_VS_PATH, LIGHT_FS_PATH);
+    const auto obj_shader = sgl::shader::create_from_source_try(shaders::object_vert, shaders::object_frag);
+    const auto light_shader = sgl::shader::create_from_source_try(shaders::light_vert, shaders::light_frag);
 
     const auto projection = cam.projection();
     constexpr auto light_color = glm::vec3{1.f, 1.f, 1.f};
@@ -255,7 +251,7 @@ void render_object(const sgl::shader &shader, const sgl::vertex_array &vao, cons
         SGL_VERIFY(shader.set_uniform_vec3(U_OBJECT_COLOR, glm::value_ptr(g_cube_colors[i])));
         SGL_VERIFY(shader.set_uniform_mat4(U_MODEL, glm::value_ptr(model)));
 
-        glDrawElements(
+        sgl::render::draw_elements(
             GL_TRIANGLES,
             static_cast<sgl::gl_sizei>(g_indices.size()),
             GL_UNSIGNED_INT,
@@ -276,7 +272,7 @@ void render_light(const sgl::shader &shader, const sgl::vertex_array &vao, const
     SGL_VERIFY(shader.set_uniform_mat4(U_MODEL, glm::value_ptr(model)));
 
     vao.bind();
-    glDrawElements(
+    sgl::render::draw_elements(
         GL_TRIANGLES,
         static_cast<sgl::gl_sizei>(g_indices.size()),
         GL_UNSIGNED_INT,
@@ -0,0 +1,98 @@
+/*
+texture upload throughput per client format: GL_RGB (unpack alignment 1) against
+converting to 4-byte pixels first (rgb_to_rgba / rgb_to_bgra), RGBA as the lower bound
+*/
+
+#include "sgl.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "glad/glad.h"
+
+static constexpr int WIDTH = 640;
+static constexpr int HEIGHT = 360;
+static constexpr auto TITLE = __FILE__;
+
+static constexpr int TEX_SIZE = 2048;
+static constexpr int ITERATIONS = 32;
+
+struct upload_path {
+    const char *name;
+    GLenum format;
+    GLenum type;
+    bool convert; // time the conversion from rgb as part of the path
+    void (*convert_fn)(const std::uint8_t *, std::uint8_t *, std::size_t, std::uint8_t) noexcept;
+};
+
+static double run(
+    const upload_path &path, GLuint tex, const std::vector<std::uint8_t> &rgb, std::vector<std::uint8_t> &scratch
+) {
+    constexpr std::size_t count = static_cast<std::size_t>(TEX_SIZE) * TEX_SIZE;
+
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, path.format == GL_RGB ? 1 : 4);
+    glFinish();
+
+    const double start = sgl::time();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        const void *pixels = rgb.data();
+        if (path.convert_fn) {
+            if (path.convert || i == 0) {
+                path.convert_fn(rgb.data(), scratch.data(), count, 255);
+            }
+            pixels = scratch.data();
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEX_SIZE, TEX_SIZE, path.format, path.type, pixels);
+    }
+    glFinish();
+
+    return (sgl::time() - start) / ITERATIONS;
+}
+
+int main() {
+    const auto window = sgl::window::create_try({.width = WIDTH, .height = HEIGHT, .title = TITLE, .vsync = false});
+
+    constexpr std::size_t count = static_cast<std::size_t>(TEX_SIZE) * TEX_SIZE;
+
+    std::vector<std::uint8_t> rgb(count * 3);
+    for (std::size_t i = 0; i < rgb.size(); ++i) {
+        rgb[i] = static_cast<std::uint8_t>(i * 31 + (i >> 11));
+    }
+    std::vector<std::uint8_t> scratch(count * 4);
+
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, TEX_SIZE, TEX_SIZE);
+
+    const upload_path paths[] = {
+        {"GL_RGB, alignment 1", GL_RGB, GL_UNSIGNED_BYTE, false, nullptr},
+        {"rgb_to_rgba + GL_RGBA", GL_RGBA, GL_UNSIGNED_BYTE, true, sgl::rgb_to_rgba},
+        {"rgb_to_bgra + GL_BGRA", GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, true, sgl::rgb_to_bgra},
+        {"GL_RGBA, no conversion", GL_RGBA, GL_UNSIGNED_BYTE, false, sgl::rgb_to_rgba},
+        {"GL_BGRA, no conversion", GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, false, sgl::rgb_to_bgra},
+    };
+
+    sgl::log_info("{}x{} uploads, {} iterations, conversion kernels: {}",
+        TEX_SIZE, TEX_SIZE, ITERATIONS, sgl::pixel_convert_isa());
+
+    for (const auto &path: paths) {
+        run(path, tex, rgb, scratch); // warm up driver paths and caches
+        const double s = run(path, tex, rgb, scratch);
+        sgl::log_info("{:<24} {:8.3f} ms  {:8.1f} Mpix/s", path.name, s * 1e3, static_cast<double>(count) / s * 1e-6);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glDeleteTextures(1, &tex);
+
+    // the conversion on its own
+    const double start = sgl::time();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        sgl::rgb_to_rgba(rgb.data(), scratch.data(), count);
+    }
+    const double s = (sgl::time() - start) / ITERATIONS;
+    sgl::log_info("{:<24} {:8.3f} ms  {:8.1f} Mpix/s", "rgb_to_rgba only", s * 1e3, static_cast<double>(count) / s * 1e-6);
+
+    return EXIT_SUCCESS;
+}
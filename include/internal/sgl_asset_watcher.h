@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "sgl_expected.h"
+#include "sgl_shader.h"
+#include "sgl_texture.h"
+
+namespace sgl {
+    enum class asset_watcher_error {
+        invalid_params = 0,
+        inotify_failed,
+        count
+    };
+
+    // hot reload. an inotify thread collects changed files, update() (GL thread, once per frame) rebuilds the
+    // shaders and textures that use them and move-assigns the result into the watched object, so every
+    // reference to it sees the new program / texture. failed rebuilds keep the old object and log why.
+    // watched objects must stay at their address until unwatch() or the watcher is gone
+    class asset_watcher {
+    public:
+        using error = asset_watcher_error;
+        using result = expected<asset_watcher, error>;
+
+        // ctors and assignments
+
+        asset_watcher(const asset_watcher &) = delete;
+
+        asset_watcher &operator=(const asset_watcher &) = delete;
+
+        asset_watcher(asset_watcher &&other) noexcept;
+
+        asset_watcher &operator=(asset_watcher &&other) noexcept;
+
+        ~asset_watcher();
+
+        // fabrics
+
+        static result create() noexcept;
+
+        // try wrappers
+
+        static asset_watcher create_try() noexcept;
+
+        // api
+
+        // the shader and every file it #includes (sgl_shader_include.h)
+        bool watch(shader &target, std::string vertex_path, std::string fragment_path) noexcept;
+
+        bool watch(texture_2d &target, std::string path, const texture_2d_params &params = {}) noexcept;
+
+        void unwatch(const shader &target) noexcept { unwatch_object(&target); }
+
+        void unwatch(const texture_2d &target) noexcept { unwatch_object(&target); }
+
+        // GL thread, at a point where nothing is mid-draw. returns the number of objects rebuilt
+        std::size_t update() noexcept;
+
+        inline constexpr static const char *err_to_str(error e) noexcept {
+            switch (e) {
+                case error::invalid_params: return "invalid params";
+                case error::inotify_failed: return "inotify_init1() failed";
+                default: return "unknown asset_watcher_error";
+            }
+        }
+
+    private:
+        struct state;
+
+        explicit asset_watcher(std::unique_ptr<state> s) noexcept;
+
+        void unwatch_object(const void *target) noexcept;
+
+        void destroy() noexcept;
+
+        std::unique_ptr<state> m_state;
+    };
+}
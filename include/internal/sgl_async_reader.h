@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sgl {
+    enum class async_reader_backend {
+        io_uring, // one I/O thread keeps up to queue_depth reads in flight in the kernel
+        thread_pool, // blocking pread() on the shared workers (no io_uring or it is disabled)
+    };
+
+    struct async_reader_params {
+        std::uint32_t queue_depth = 64; // reads in flight at once, io_uring only
+        bool force_thread_pool = false;
+    };
+
+    // a whole file, read off the calling thread
+    struct file_read {
+        std::string path;
+        std::vector<std::uint8_t> bytes;
+        int error = 0; // errno, 0 on success
+        double io_ms = 0.0; // queued -> last byte read
+
+        [[nodiscard]] bool ok() const noexcept { return error == 0; }
+
+        [[nodiscard]] std::string_view text() const noexcept {
+            return {reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+        }
+    };
+
+    // batched whole-file reads. with io_uring a single thread submits every queued read in one
+    // io_uring_enter() and reaps completions as they land, so hundreds of small files cost a handful of
+    // syscalls instead of open/read/close each on the caller. completed files are handed to the shared
+    // workers (sgl_job.h), the callback runs there and is the place to decode. no GL in callbacks
+    class async_reader {
+    public:
+        using read_callback = std::function<void(file_read &&)>;
+
+        // ctors and assignments
+
+        async_reader(const async_reader &) = delete;
+
+        async_reader &operator=(const async_reader &) = delete;
+
+        async_reader(async_reader &&other) noexcept;
+
+        async_reader &operator=(async_reader &&other) noexcept;
+
+        // waits for reads already in the kernel, queued ones complete with ECANCELED
+        ~async_reader();
+
+        // fabrics
+
+        // falls back to the thread pool when io_uring_setup() is unavailable (old kernel, seccomp)
+        static async_reader create(const async_reader_params &params = {}) noexcept;
+
+        // api
+
+        void read(std::string path, read_callback on_done) noexcept;
+
+        // one lock and one wakeup for the whole batch
+        void read_batch(std::span<const std::string> paths, const read_callback &on_done) noexcept;
+
+        [[nodiscard]] async_reader_backend backend() const noexcept;
+
+        inline constexpr static const char *backend_name(async_reader_backend b) noexcept {
+            switch (b) {
+                case async_reader_backend::io_uring: return "io_uring";
+                case async_reader_backend::thread_pool: return "thread pool";
+                default: return "unknown";
+            }
+        }
+
+    private:
+        struct ring_state;
+
+        explicit async_reader(std::unique_ptr<ring_state> ring) noexcept;
+
+        void destroy() noexcept;
+
+        std::unique_ptr<ring_state> m_ring; // null: thread pool backend
+    };
+
+    struct asset_pipeline_stats {
+        std::size_t files = 0;
+        std::size_t failed = 0; // read errors, decode still saw them
+        std::size_t bytes = 0;
+        double io_ms = 0.0; // wall: first submit -> last read completed
+        double decode_ms = 0.0; // summed over workers
+        double upload_ms = 0.0; // summed on the GL thread
+        double wall_ms = 0.0; // first submit -> last upload
+    };
+
+    // read -> decode -> upload with the three stages overlapping: files are decoded on the workers as
+    // soon as they land, their GL steps queue up for pump() on the GL thread
+    class asset_pipeline {
+    public:
+        using upload_fn = std::function<void()>;
+        // runs on a worker with the file (check ok()), returns the GL step or an empty function
+        using decode_fn = std::function<upload_fn(file_read &)>;
+
+        // fabrics
+
+        static asset_pipeline create(const async_reader_params &params = {}) noexcept;
+
+        // api
+
+        void add(std::string path, decode_fn decode) noexcept;
+
+        void add(std::span<const std::string> paths, const decode_fn &decode) noexcept;
+
+        // GL thread. runs finished upload steps until budget_ms is spent (0: all of them), returns the count
+        std::size_t pump(double budget_ms = 0.0) noexcept;
+
+        // GL thread. pumps until everything added so far is uploaded, logs the stage timings
+        void finish() noexcept;
+
+        // added but not uploaded yet
+        [[nodiscard]] std::size_t pending() const noexcept;
+
+        [[nodiscard]] asset_pipeline_stats stats() const noexcept;
+
+        [[nodiscard]] async_reader_backend backend() const noexcept { return m_reader.backend(); }
+
+    private:
+        struct shared_state;
+
+        asset_pipeline(async_reader reader, std::shared_ptr<shared_state> state) noexcept;
+
+        async_reader::read_callback make_callback(decode_fn decode) const noexcept;
+
+        // decode jobs outlive a moved-from or destroyed pipeline, they keep the state alive
+        std::shared_ptr<shared_state> m_state;
+        async_reader m_reader;
+    };
+}
@@ -58,6 +58,9 @@ namespace sgl {
             return projection() * view();
         }
 
+        // approximate on-screen diameter in pixels of a bounding sphere
+        [[nodiscard]] float projected_size(const glm::vec3 &center, float radius, int viewport_height) const noexcept;
+
     private:
         void update_vecs() noexcept;
 
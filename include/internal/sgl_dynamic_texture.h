@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "sgl_expected.h"
+#include "sgl_type.h"
+#include "sgl_texture.h"
+
+namespace sgl {
+    enum class dynamic_texture_error {
+        invalid_params = 0,
+        texture_failed,
+        gl_gen_failed,
+        count
+    };
+
+    struct texture_rect {
+        gl_int x = 0;
+        gl_int y = 0;
+        gl_int width = 0;
+        gl_int height = 0;
+
+        bool operator==(const texture_rect &) const noexcept = default;
+    };
+
+    struct dynamic_texture_params {
+        gl_int width = 0;
+        gl_int height = 0;
+        gl_int channels = 4;
+
+        // dirty rects are rounded out to this grid, then merged
+        gl_int tile_size = 64;
+
+        texture_2d_params texture{
+            .wrap_s = texture_wrap::clamp_to_edge,
+            .wrap_t = texture_wrap::clamp_to_edge,
+            .min_filter = texture_min_filter::linear,
+            .mag_filter = texture_mag_filter::linear,
+            .generate_mipmaps = false,
+            .flip_vertically_on_load = false,
+        };
+    };
+
+    // a texture re-uploaded every frame (video, UI canvas). only the tiles touched by mark_dirty() are sent,
+    // through two alternating pixel unpack buffers so the CPU fills one while the GPU still reads the other
+    class dynamic_texture {
+    public:
+        using error = dynamic_texture_error;
+        using result = expected<dynamic_texture, error>;
+
+        // ctors and assignments
+
+        dynamic_texture(const dynamic_texture &) = delete;
+
+        dynamic_texture &operator=(const dynamic_texture &) = delete;
+
+        dynamic_texture(dynamic_texture &&other) noexcept;
+
+        dynamic_texture &operator=(dynamic_texture &&other) noexcept;
+
+        ~dynamic_texture();
+
+        // fabrics
+
+        static result create(const dynamic_texture_params &params) noexcept;
+
+        // try wrappers
+
+        static dynamic_texture create_try(const dynamic_texture_params &params) noexcept;
+
+        // api
+
+        // clipped to the texture, accumulates until the next upload()
+        void mark_dirty(const texture_rect &rect) noexcept;
+
+        void mark_all_dirty() noexcept;
+
+        // frame is the full image, tightly packed, same layout as the texture. returns bytes uploaded
+        gl_sizeiptr upload(const void *frame) noexcept;
+
+        gl_sizeiptr update(const void *frame, std::span<const texture_rect> dirty) noexcept {
+            for (const auto &r: dirty) {
+                mark_dirty(r);
+            }
+            return upload(frame);
+        }
+
+        void bind(gl_uint unit) const noexcept { m_texture.bind(unit); }
+
+        [[nodiscard]] const texture_2d &texture() const noexcept { return m_texture; }
+
+        [[nodiscard]] bool has_dirty() const noexcept { return m_dirty_count > 0; }
+
+        // merged rects sent by the last upload()
+        [[nodiscard]] const std::vector<texture_rect> &last_rects() const noexcept { return m_rects; }
+
+        inline constexpr static const char *err_to_str(error e) noexcept {
+            switch (e) {
+                case error::invalid_params: return "invalid params";
+                case error::texture_failed: return "texture creation failed";
+                case error::gl_gen_failed: return "glGenBuffers() failed";
+                default: return "unknown dynamic_texture_error";
+            }
+        }
+
+    private:
+        dynamic_texture(texture_2d texture, const dynamic_texture_params &params) noexcept;
+
+        // turns dirty tiles into as few rects as possible and clears them
+        void coalesce() noexcept;
+
+        void destroy() noexcept;
+
+        texture_2d m_texture;
+        gl_int m_channels = 0;
+        gl_int m_tile_size = 0;
+        gl_int m_tiles_x = 0;
+        gl_int m_tiles_y = 0;
+
+        std::vector<std::uint8_t> m_dirty; // one flag per tile
+        std::size_t m_dirty_count = 0;
+        std::vector<texture_rect> m_rects;
+
+        std::array<gl_uint, 2> m_pbos{};
+        std::array<gl_sizeiptr, 2> m_pbo_sizes{};
+        std::size_t m_next_pbo = 0;
+    };
+}
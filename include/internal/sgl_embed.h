@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "sgl_hash.h"
+
+namespace sgl {
+    // a file baked into the binary by the sgl_embed_shaders() CMake function (cmake/sgl_embed.cmake):
+    //   sgl_embed_shaders(app FILES shaders/basic.vert shaders/basic.frag)
+    //   #include "embedded_shaders.h"
+    //   auto s = sgl::shader::create_from_source_try(shaders::basic_vert, shaders::basic_frag);
+    // no file I/O and no working-directory dependency at runtime
+    struct embedded_source {
+        std::string_view name; // path relative to the CMakeLists.txt that embedded it
+        std::string_view text;
+        std::uint64_t hash = 0; // fnv1a_64(text), folded by the compiler: a ready cache key
+
+        constexpr embedded_source(std::string_view name_, std::string_view text_) noexcept
+            : name{name_}, text{text_}, hash{fnv1a_64(text_)} {
+        }
+
+        constexpr operator std::string_view() const noexcept { return text; }
+    };
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sgl_type.h"
+
+namespace sgl {
+    class gpu_profiler;
+}
+
+// keeps the last frames (frame / swap timings, metrics counters, gpu_profiler scopes, resource creations) in
+// preallocated rings and writes them as a Chrome trace when a frame goes over budget, so a hitch can be
+// looked at after the fact. with SGL_PROFILER the trace also has the cpu zones of those frames.
+// window::swap_buffers() closes the frame. off until enable(), then end_frame() copies a few hundred bytes
+// and never allocates; only a dump does, on a worker. GL thread only
+namespace sgl::flight_recorder {
+    struct params {
+        double budget_ms = 1000.0 / 30.0; // a longer frame triggers a dump
+        std::size_t frames = 120; // kept
+        double cooldown_sec = 10.0; // between automatic dumps, hitches in between are only counted
+        int post_frames = 4; // recorded after the hitch before dumping, so its gpu results are in
+        const char *path_prefix = "sgl_hitch"; // <prefix>_<frame index>.json
+    };
+
+    enum class resource_kind {
+        shader = 0,
+        texture,
+        vertex_buffer,
+        element_buffer,
+        framebuffer,
+        count
+    };
+
+    [[nodiscard]] const char *resource_kind_name(resource_kind kind) noexcept;
+
+    // allocates the rings, restarts recording
+    void enable(const params &p = {}) noexcept;
+
+    void disable() noexcept;
+
+    [[nodiscard]] bool enabled() noexcept;
+
+    // its last_frame_events() are copied at each end_frame() once a new frame resolved. nullptr detaches;
+    // detach before the profiler goes away
+    void attach(const gpu_profiler *profiler) noexcept;
+
+    namespace detail {
+        inline bool g_enabled = false;
+
+        void record_resource(resource_kind kind, gl_uint id, std::uint64_t bytes) noexcept;
+    }
+
+    inline void resource_created(resource_kind kind, gl_uint id, std::uint64_t bytes = 0) noexcept {
+        if (detail::g_enabled) {
+            detail::record_resource(kind, id, bytes);
+        }
+    }
+
+    // swap_begin_ns / end_ns: profiler_now_ns() around the swap. the frame runs from the previous end_ns
+    void end_frame(std::uint64_t swap_begin_ns, std::uint64_t end_ns) noexcept;
+
+    // writes what the rings hold now (on a worker), regardless of budget and cooldown
+    bool dump(const char *path) noexcept;
+
+    [[nodiscard]] std::uint64_t dumps() noexcept;
+
+    // over-budget frames that fell into a cooldown
+    [[nodiscard]] std::uint64_t suppressed() noexcept;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "sgl_metrics.h"
+
+namespace sgl {
+    struct frame_time_stats {
+        std::uint64_t frames = 0; // in the window
+        double fps = 0.0;
+        double avg_ms = 0.0;
+        double p50_ms = 0.0;
+        double p95_ms = 0.0;
+        double p99_ms = 0.0;
+        double max_ms = 0.0;
+        std::uint64_t stutters = 0; // in the window
+        std::uint64_t total_stutters = 0;
+    };
+
+    // the last frame_window frame durations: a ring other threads can copy lock-free, plus a rolling
+    // time_histogram (samples leaving the ring are removed from it) for percentiles. a stutter is a
+    // frame longer than stutter_factor x the rolling median. record() and stats(): one thread
+    class frame_time_tracker {
+    public:
+        static constexpr std::size_t frame_window = 512;
+
+        explicit frame_time_tracker(double stutter_factor = 2.0) noexcept : m_stutter_factor{stutter_factor} {
+        }
+
+        frame_time_tracker(const frame_time_tracker &) = delete;
+
+        frame_time_tracker &operator=(const frame_time_tracker &) = delete;
+
+        void record(double ms) noexcept;
+
+        [[nodiscard]] frame_time_stats stats() const noexcept;
+
+        // any thread: the most recent durations, oldest first. returns how many were written
+        std::size_t copy_recent(std::span<float> out) const noexcept;
+
+        [[nodiscard]] std::uint64_t frames() const noexcept { return m_head.load(std::memory_order_acquire); }
+
+        void set_stutter_factor(double factor) noexcept { m_stutter_factor = factor; }
+
+    private:
+        static_assert((frame_window & (frame_window - 1)) == 0);
+
+        std::array<std::atomic<float>, frame_window> m_ring{};
+        std::array<bool, frame_window> m_stutter{}; // parallel to m_ring
+        std::atomic<std::uint64_t> m_head{0};
+
+        time_histogram m_histogram;
+        double m_stutter_factor;
+        double m_median_ms = 0.0; // refreshed every few frames
+        std::uint64_t m_window_stutters = 0;
+        std::uint64_t m_total_stutters = 0;
+    };
+}
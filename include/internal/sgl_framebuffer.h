@@ -0,0 +1,141 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "sgl_expected.h"
+#include "sgl_type.h"
+
+namespace sgl {
+    enum class framebuffer_error {
+        invalid_params = 0,
+        gl_gen_failed,
+        incomplete,
+        count
+    };
+
+    struct framebuffer_params {
+        gl_sizei width = 0;
+        gl_sizei height = 0;
+
+        gl_enum color_format = 0x8058u; // GL_RGBA8, 0 = no color attachment
+        gl_enum depth_format = 0x88F0u; // GL_DEPTH24_STENCIL8, 0 = no depth attachment
+
+        // > 0: multisampled renderbuffers, resolve with blit_to() before sampling
+        gl_sizei samples = 0;
+
+        // single-sampled attachments are textures (sampleable) or renderbuffers (write-only)
+        bool color_texture = true;
+        bool depth_texture = false;
+
+        bool operator==(const framebuffer_params &) const noexcept = default;
+    };
+
+    class framebuffer {
+    public:
+        using error = framebuffer_error;
+        using result = expected<framebuffer, error>;
+
+        // ctors and assignments
+
+        framebuffer(const framebuffer &) = delete;
+
+        framebuffer &operator=(const framebuffer &) = delete;
+
+        framebuffer(framebuffer &&other) noexcept;
+
+        framebuffer &operator=(framebuffer &&other) noexcept;
+
+        ~framebuffer();
+
+        // fabrics
+
+        static result create(const framebuffer_params &params) noexcept;
+
+        // try wrappers
+
+        static framebuffer create_try(const framebuffer_params &params) noexcept;
+
+        // api
+
+        // binds for drawing and sets the viewport to the target size
+        void bind() const noexcept;
+
+        static void bind_default(gl_sizei width, gl_sizei height) noexcept;
+
+        // copies (and resolves MSAA) color and/or depth into dst. filter: GL_NEAREST / GL_LINEAR, 0 picks linear
+        // for a scaled color-only blit. false (nothing copied) for a scaled MSAA resolve or a linear depth /
+        // stencil blit, GL rejects both
+        bool blit_to(const framebuffer &dst, bool color = true, bool depth = false, gl_enum filter = 0) const noexcept;
+
+        bool blit_to_default(gl_sizei width, gl_sizei height, gl_enum filter = 0) const noexcept;
+
+        // the contents are not needed anymore: lets tilers skip storing them (GL 4.3 / ARB_invalidate_subdata)
+        void invalidate(bool color, bool depth) const noexcept;
+
+        void bind_color_texture(gl_uint unit) const noexcept;
+
+        void bind_depth_texture(gl_uint unit) const noexcept;
+
+        [[nodiscard]] gl_uint id() const noexcept { return m_id; }
+        [[nodiscard]] gl_uint color_texture() const noexcept { return m_color_tex; }
+        [[nodiscard]] gl_uint depth_texture() const noexcept { return m_depth_tex; }
+        [[nodiscard]] const framebuffer_params &params() const noexcept { return m_params; }
+        [[nodiscard]] gl_sizei width() const noexcept { return m_params.width; }
+        [[nodiscard]] gl_sizei height() const noexcept { return m_params.height; }
+
+        inline constexpr static const char *err_to_str(error e) noexcept {
+            switch (e) {
+                case error::invalid_params: return "invalid params";
+                case error::gl_gen_failed: return "glGenFramebuffers() failed";
+                case error::incomplete: return "framebuffer incomplete";
+                default: return "unknown framebuffer_error";
+            }
+        }
+
+    private:
+        explicit framebuffer(const framebuffer_params &params) noexcept : m_params{params} {
+        }
+
+        bool blit(gl_uint dst_id, gl_sizei dw, gl_sizei dh, gl_bitfield mask, gl_enum filter) const noexcept;
+
+        void destroy() noexcept;
+
+        framebuffer_params m_params{};
+        gl_uint m_id = 0;
+        gl_uint m_color_tex = 0;
+        gl_uint m_color_rbo = 0;
+        gl_uint m_depth_tex = 0;
+        gl_uint m_depth_rbo = 0;
+    };
+
+    // reuses transient render targets with equal params across frames
+    class framebuffer_pool {
+    public:
+        // a free target matching params, created on miss. nullptr on failure
+        [[nodiscard]] framebuffer *acquire(const framebuffer_params &params) noexcept;
+
+        // early return for reuse within the same frame
+        void release(const framebuffer *fb) noexcept;
+
+        // releases everything and destroys targets unused for max_idle_frames
+        void end_frame() noexcept;
+
+        void set_max_idle_frames(int frames) noexcept { m_max_idle_frames = frames; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return m_entries.size(); }
+
+        void clear() noexcept { m_entries.clear(); }
+
+    private:
+        struct entry {
+            framebuffer fb;
+            bool in_use = false;
+            bool used = false; // acquired during the current frame
+            int idle_frames = 0;
+        };
+
+        std::vector<std::unique_ptr<entry> > m_entries;
+        int m_max_idle_frames = 3;
+    };
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// GL call interposition. configure with -DSGL_GL_TRACE=ON: every GL entry point sgl uses is then routed
+// through a table of wrappers that count calls per entry point (and per frame, metrics::counter::gl_calls)
+// and can keep a trace with arguments. otherwise GL calls go straight to the driver and these are stubs
+
+#ifndef SGL_GL_TRACE
+#define SGL_GL_TRACE 0
+#endif
+
+namespace sgl::gl_trace {
+    struct call_count {
+        const char *name = nullptr;
+        std::uint64_t count = 0;
+    };
+
+    [[nodiscard]] constexpr bool available() noexcept { return SGL_GL_TRACE != 0; }
+
+    // a fake driver instead of a window and context: gen / create calls return increasing ids, status and
+    // completeness queries succeed, the version reads 4.6, everything else does nothing. for measuring sgl's
+    // own cpu cost and asserting call counts without a GPU or display. call before anything touches GL.
+    // false without SGL_GL_TRACE or once a real context was loaded
+    bool use_null_backend() noexcept;
+
+    [[nodiscard]] bool null_backend() noexcept;
+
+    // all entry points, since reset()
+    [[nodiscard]] std::uint64_t calls() noexcept;
+
+    // name as in GL: "glDrawElements"
+    [[nodiscard]] std::uint64_t calls(std::string_view name) noexcept;
+
+    // entry points called since reset(), most called first
+    [[nodiscard]] std::vector<call_count> counts() noexcept;
+
+    // counts and trace
+    void reset() noexcept;
+
+    // keeps the last capacity calls with their arguments, 0 stops. allocates here only
+    void set_trace(std::size_t capacity) noexcept;
+
+    // one call per line, oldest first: "glBindBuffer(34962, 3)"
+    [[nodiscard]] std::string trace_text() noexcept;
+
+    bool write_trace(const char *path) noexcept;
+
+    namespace detail {
+        // wraps the loaded entry points, ensure_glad() calls it after loading
+        void install() noexcept;
+    }
+}
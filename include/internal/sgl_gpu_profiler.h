@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sgl_expected.h"
+#include "sgl_type.h"
+
+namespace sgl {
+    enum class gpu_profiler_error {
+        invalid_params = 0,
+        unsupported,
+        gl_gen_failed,
+        count
+    };
+
+    struct gpu_profiler_params {
+        int frame_latency = 4; // frames in flight before a result is read, ring size
+        bool pipeline_statistics = false; // GL 4.6 / ARB_pipeline_statistics_query, outermost scopes only
+    };
+
+    // aggregated over every resolved frame since reset(). a scope entered several times in a frame counts as
+    // one sample (the sum)
+    struct gpu_scope_stats {
+        std::string name;
+        std::uint64_t samples = 0;
+        double last_ms = 0.0;
+        double min_ms = 0.0;
+        double avg_ms = 0.0;
+        double max_ms = 0.0;
+        // last frame, pipeline_statistics only
+        std::uint64_t vertices = 0;
+        std::uint64_t primitives = 0;
+        std::uint64_t fragments = 0;
+    };
+
+    // one scope of the last resolved frame, GL_TIMESTAMP nanoseconds (to_cpu_ns() converts)
+    struct gpu_timing_event {
+        const char *name = nullptr;
+        std::uint64_t begin_ns = 0;
+        std::uint64_t end_ns = 0;
+        int depth = 0;
+    };
+
+    // GL_TIMESTAMP queries around named scopes (so they nest), recorded into a ring of per-frame query pools
+    // and read back frame_latency frames later, only once GL_QUERY_RESULT_AVAILABLE says so: never stalls.
+    // when the GPU is further behind than the ring, that frame is not recorded (dropped_frames()).
+    // with SGL_PROFILER resolved scopes also go to the cpu profiler's trace, on a gpu track.
+    // one instance per GL context, GL thread only
+    class gpu_profiler {
+    public:
+        using error = gpu_profiler_error;
+        using result = expected<gpu_profiler, error>;
+
+        // ctors and assignments
+
+        gpu_profiler(const gpu_profiler &) = delete;
+
+        gpu_profiler &operator=(const gpu_profiler &) = delete;
+
+        gpu_profiler(gpu_profiler &&other) noexcept;
+
+        gpu_profiler &operator=(gpu_profiler &&other) noexcept;
+
+        ~gpu_profiler();
+
+        // fabrics
+
+        static result create(const gpu_profiler_params &params = {}) noexcept;
+
+        // try wrappers
+
+        static gpu_profiler create_try(const gpu_profiler_params &params = {}) noexcept;
+
+        // api
+
+        // once per frame, before the first scope: closes the previous frame, collects finished ones
+        void new_frame() noexcept;
+
+        // name must outlive the profiler (a literal)
+        void push(const char *name) noexcept;
+
+        void pop() noexcept;
+
+        [[nodiscard]] const std::vector<gpu_scope_stats> &scopes() const noexcept { return m_scopes; }
+
+        // nullptr when the scope was never resolved
+        [[nodiscard]] const gpu_scope_stats *find(std::string_view name) const noexcept;
+
+        // whole frames, new_frame() to new_frame()
+        [[nodiscard]] const gpu_scope_stats &frame() const noexcept { return m_frame_stats; }
+
+        [[nodiscard]] const std::vector<gpu_timing_event> &last_frame_events() const noexcept {
+            return m_last_events;
+        }
+
+        [[nodiscard]] std::uint64_t dropped_frames() const noexcept { return m_dropped; }
+
+        // GL_TIMESTAMP -> profiler_now_ns() (sgl_profiler.h), offset sampled at create() and reset()
+        [[nodiscard]] std::uint64_t to_cpu_ns(std::uint64_t gpu_ns) const noexcept {
+            return static_cast<std::uint64_t>(static_cast<std::int64_t>(gpu_ns) + m_clock_offset_ns);
+        }
+
+        [[nodiscard]] bool has_pipeline_statistics() const noexcept { return m_params.pipeline_statistics; }
+
+        void reset() noexcept;
+
+        // one line per scope, slowest average first
+        void log_report() const noexcept;
+
+        inline constexpr static const char *err_to_str(error e) noexcept {
+            switch (e) {
+                case error::invalid_params: return "invalid params";
+                case error::unsupported: return "timer queries are not supported (GL 3.3 / ARB_timer_query)";
+                case error::gl_gen_failed: return "glGenQueries() failed";
+                default: return "unknown gpu_profiler_error";
+            }
+        }
+
+    private:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+        static constexpr std::size_t stat_count = 3; // vertices, primitives, fragment invocations
+
+        struct record {
+            std::size_t scope = 0;
+            std::size_t begin = 0; // into frame_slot::timestamps
+            std::size_t end = npos;
+            std::size_t stats = npos; // into frame_slot::stats
+            int depth = 0;
+        };
+
+        struct frame_slot {
+            std::vector<gl_uint> timestamps;
+            std::vector<std::array<gl_uint, stat_count> > stats;
+            std::size_t used_timestamps = 0;
+            std::size_t used_stats = 0;
+            std::vector<record> records;
+            std::size_t frame_begin = npos;
+            std::size_t frame_end = npos;
+            bool pending = false;
+        };
+
+        explicit gpu_profiler(const gpu_profiler_params &params) noexcept : m_params{params} {
+        }
+
+        [[nodiscard]] std::size_t scope_index(const char *name) noexcept;
+
+        bool timestamp(frame_slot &s, std::size_t &index) noexcept;
+
+        bool resolve(frame_slot &s) noexcept;
+
+        void sync_clocks() noexcept;
+
+        void destroy() noexcept;
+
+        gpu_profiler_params m_params;
+        std::vector<frame_slot> m_slots;
+        std::size_t m_current = 0;
+        bool m_recording = false;
+        std::vector<std::size_t> m_stack; // open records, npos while not recording
+        std::vector<const char *> m_keys; // parallel to m_scopes, literal pointers compared first
+        std::vector<gpu_scope_stats> m_scopes;
+        std::vector<double> m_frame_sums; // scratch for resolve(), parallel to m_scopes
+        gpu_scope_stats m_frame_stats;
+        std::vector<gpu_timing_event> m_last_events;
+        std::uint64_t m_dropped = 0;
+        std::int64_t m_clock_offset_ns = 0;
+    };
+
+    // RAII push/pop
+    class gpu_scope {
+    public:
+        gpu_scope(gpu_profiler &profiler, const char *name) noexcept : m_profiler{profiler} {
+            m_profiler.push(name);
+        }
+
+        gpu_scope(const gpu_scope &) = delete;
+
+        gpu_scope &operator=(const gpu_scope &) = delete;
+
+        ~gpu_scope() { m_profiler.pop(); }
+
+    private:
+        gpu_profiler &m_profiler;
+    };
+}
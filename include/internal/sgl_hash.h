@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace sgl {
+    // 64-bit FNV-1a. constexpr so names and sources can be hashed at compile time, stable across runs
+    // and platforms (it is stored in pack files)
+
+    inline constexpr std::uint64_t fnv1a_64_offset = 0xcbf29ce484222325ull;
+    inline constexpr std::uint64_t fnv1a_64_prime = 0x100000001b3ull;
+
+    constexpr std::uint64_t fnv1a_64(std::string_view s, std::uint64_t h = fnv1a_64_offset) noexcept {
+        for (const char c: s) {
+            h ^= static_cast<std::uint8_t>(c);
+            h *= fnv1a_64_prime;
+        }
+        return h;
+    }
+
+    constexpr std::uint64_t fnv1a_64(const std::uint8_t *data, std::size_t size,
+                                     std::uint64_t h = fnv1a_64_offset) noexcept {
+        for (std::size_t i = 0; i < size; ++i) {
+            h ^= data[i];
+            h *= fnv1a_64_prime;
+        }
+        return h;
+    }
+}
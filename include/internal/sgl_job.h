@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace sgl::detail {
+    // fixed pool of background workers shared by everything sgl does off the GL thread.
+    // jobs must not touch GL: results are handed back and uploaded by the caller.
+
+    void submit_job(std::function<void()> job) noexcept;
+
+    std::size_t worker_count() noexcept;
+
+    template<typename F>
+    auto async(F &&f) noexcept -> std::future<std::invoke_result_t<std::decay_t<F> > > {
+        using ret_t = std::invoke_result_t<std::decay_t<F> >;
+
+        auto task = std::make_shared<std::packaged_task<ret_t()> >(std::forward<F>(f));
+        auto fut = task->get_future();
+        submit_job([task = std::move(task)] { (*task)(); });
+        return fut;
+    }
+}
@@ -1,15 +1,30 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <utility>
 #include <cassert>
 
 #include "fmt/base.h"
 
+// below this level log calls compile to nothing (fatal always stays): 0 debug, 1 info, 2 warn, 3 error.
+// default: debug in debug builds, info otherwise
+#ifndef SGL_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define SGL_LOG_MIN_LEVEL 1
+#else
+#define SGL_LOG_MIN_LEVEL 0
+#endif
+#endif
+
 namespace sgl {
     enum class log_level {
-        info = 0,
+        debug = 0,
+        info,
         warn,
         error,
         fatal,
@@ -17,45 +32,161 @@ namespace sgl {
         count
     };
 
+    // runtime on/off switch per area of sgl
+    enum class log_subsystem {
+        general = 0,
+        window,
+        shader,
+        texture,
+        buffer, // vertex / element buffers, vertex arrays, readback
+        framebuffer,
+        assets, // packs, file io, hot reload
+        profiling, // profilers, metrics, flight recorder, gl_trace
+
+        count
+    };
+
+    // records are formatted on the calling thread into a fixed size slot (longer ones are cut) of a lock-free
+    // MPSC ring, a background thread writes them. a full ring drops records (counted, reported later) instead
+    // of blocking. fatal flushes the ring, writes synchronously and aborts. SGL_DLOG_* (sgl_log_deferred.h) leave
+    // the formatting to that thread too
+    inline constexpr std::size_t log_ring_size = 1024;
+    inline constexpr std::size_t log_max_message = 480;
+
+    [[nodiscard]] constexpr bool log_compiled(log_level level) noexcept {
+        return level == log_level::fatal || static_cast<int>(level) >= SGL_LOG_MIN_LEVEL;
+    }
+
+    void set_log_level(log_level min_level) noexcept;
+
+    void set_log_enabled(log_subsystem subsystem, bool enabled) noexcept;
+
+    [[nodiscard]] bool log_enabled(log_subsystem subsystem) noexcept;
+
+    // blocks until every record logged so far is written
+    void log_flush() noexcept;
+
+    // records lost to a full ring so far
+    [[nodiscard]] std::uint64_t log_dropped() noexcept;
+
     namespace detail {
         const char *level_name(log_level level) noexcept;
 
+        const char *subsystem_name(log_subsystem subsystem) noexcept;
+
         FILE *stream_for(log_level level) noexcept;
+
+        inline std::atomic<int> g_log_min_level{0};
+        inline std::atomic<std::uint32_t> g_log_subsystems{~std::uint32_t{0}};
+
+        [[nodiscard]] inline bool log_wanted(log_subsystem subsystem, log_level level) noexcept {
+            return level == log_level::fatal ||
+                   (static_cast<int>(level) >= g_log_min_level.load(std::memory_order_relaxed) &&
+                    (g_log_subsystems.load(std::memory_order_relaxed) >> static_cast<unsigned>(subsystem) & 1u));
+        }
+
+        void log_submit(log_level level, log_subsystem subsystem, const char *text, std::size_t size) noexcept;
+
+        [[noreturn]] void log_fatal_submit(const char *text, std::size_t size) noexcept;
     }
 
     template<typename... Args>
-    void log(log_level level, fmt::format_string<Args...> fmt, Args &&... args) noexcept {
+    void log(log_subsystem subsystem, log_level level, fmt::format_string<Args...> fmt, Args &&... args) noexcept {
         assert(level < log_level::count);
 
-        FILE *out = detail::stream_for(level);
+        if (!detail::log_wanted(subsystem, level)) {
+            return;
+        }
+
+        char buf[log_max_message];
+        std::size_t size = 0;
         try {
-            fmt::print(out, "[{}]: ", detail::level_name(level));
-            fmt::println(out, fmt, std::forward<Args>(args)...);
+            const auto res = fmt::format_to_n(buf, sizeof(buf), fmt, std::forward<Args>(args)...);
+            size = res.size;
         } catch (...) {
-            std::fputs("[LOG]: formatting failed", stderr);
+            constexpr char failed[] = "[LOG]: formatting failed";
+            size = sizeof(failed) - 1;
+            std::memcpy(buf, failed, size);
         }
+
         if (level == log_level::fatal) {
-            std::abort();
+            detail::log_fatal_submit(buf, size);
+        }
+        detail::log_submit(level, subsystem, buf, size);
+    }
+
+    template<typename... Args>
+    void log(log_level level, fmt::format_string<Args...> fmt, Args &&... args) noexcept {
+        log(log_subsystem::general, level, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void log_debug(log_subsystem subsystem, fmt::format_string<Args...> fmt, Args &&... args) noexcept {
+        if constexpr (log_compiled(log_level::debug)) {
+            log(subsystem, log_level::debug, fmt, std::forward<Args>(args)...);
+        } else {
+            static_cast<void>(subsystem);
+            static_cast<void>(fmt);
+            (static_cast<void>(args), ...);
+        }
+    }
+
+    template<typename... Args>
+    void log_debug(fmt::format_string<Args...> fmt, Args &&... args) noexcept {
+        log_debug(log_subsystem::general, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void log_info(log_subsystem subsystem, fmt::format_string<Args...> fmt, Args &&... args) noexcept {
+        if constexpr (log_compiled(log_level::info)) {
+            log(subsystem, log_level::info, fmt, std::forward<Args>(args)...);
+        } else {
+            static_cast<void>(subsystem);
+            static_cast<void>(fmt);
+            (static_cast<void>(args), ...);
         }
     }
 
     template<typename... Args>
     void log_info(fmt::format_string<Args...> fmt, Args &&... args) noexcept {
-        log(log_level::info, fmt, std::forward<Args>(args)...);
+        log_info(log_subsystem::general, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void log_warn(log_subsystem subsystem, fmt::format_string<Args...> fmt, Args &&... args) noexcept {
+        if constexpr (log_compiled(log_level::warn)) {
+            log(subsystem, log_level::warn, fmt, std::forward<Args>(args)...);
+        } else {
+            static_cast<void>(subsystem);
+            static_cast<void>(fmt);
+            (static_cast<void>(args), ...);
+        }
     }
 
     template<typename... Args>
     void log_warn(fmt::format_string<Args...> fmt, Args &&... args) noexcept {
-        log(log_level::warn, fmt, std::forward<Args>(args)...);
+        log_warn(log_subsystem::general, fmt, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void log_error(log_subsystem subsystem, fmt::format_string<Args...> fmt, Args &&... args) noexcept {
+        if constexpr (log_compiled(log_level::error)) {
+            log(subsystem, log_level::error, fmt, std::forward<Args>(args)...);
+        } else {
+            static_cast<void>(subsystem);
+            static_cast<void>(fmt);
+            (static_cast<void>(args), ...);
+        }
     }
 
     template<typename... Args>
     void log_error(fmt::format_string<Args...> fmt, Args &&... args) noexcept {
-        log(log_level::error, fmt, std::forward<Args>(args)...);
+        log_error(log_subsystem::general, fmt, std::forward<Args>(args)...);
     }
 
     template<typename... Args>
-    void log_fatal(fmt::format_string<Args...> fmt, Args &&... args) noexcept {
-        log(log_level::fatal, fmt, std::forward<Args>(args)...);
+    [[noreturn]] void log_fatal(fmt::format_string<Args...> fmt, Args &&... args) noexcept {
+        log(log_subsystem::general, log_level::fatal, fmt, std::forward<Args>(args)...);
+        std::abort();
     }
 }
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "sgl_log.h"
+
+// deferred logging for hot paths: SGL_DLOG_* copy the arguments as raw bytes into the log ring next to a static
+// call site (format string, argument types), the writer thread formats them later. in binary mode
+// (set_log_binary) nothing is formatted at all, sgl_logdec / decode_log() turn the file into text.
+// arguments are limited to what can be copied: integers, floating point, bool, char, strings (copied inline,
+// cut to fit a record) and void pointers. each call site can be rate limited (set_log_rate_limit), dropped
+// records are counted and reported as "suppressed N" with the next one logged from there or on log_flush()
+//
+//   SGL_DLOG_WARN(sgl::log_subsystem::shader, "uniform '{}' not found", name);
+
+namespace sgl {
+    enum class log_arg_type : std::uint8_t {
+        i64 = 0,
+        u64,
+        f32,
+        f64,
+        boolean,
+        character,
+        pointer,
+        string,
+
+        count
+    };
+
+    // per call site: at most per_interval records each interval_sec, 0 turns it off (default)
+    void set_log_rate_limit(std::uint32_t per_interval, double interval_sec = 1.0) noexcept;
+
+    // writes records unformatted to path from now on (nullptr: back to text on stdout / stderr).
+    // the file is in host byte order, read it with decode_log()
+    bool set_log_binary(const char *path) noexcept;
+
+    // binary log -> text lines, as they would have been printed
+    bool decode_log(const char *path, std::FILE *out) noexcept;
+
+    namespace detail {
+        struct log_site {
+            log_level level = log_level::info;
+            log_subsystem subsystem = log_subsystem::general;
+            const char *format = nullptr;
+            const char *file = nullptr;
+            int line = 0;
+            const log_arg_type *types = nullptr;
+            std::size_t arg_count = 0;
+
+            // rate limit window, suppressed records not reported yet
+            std::atomic<std::uint64_t> window_start_ns{0};
+            std::atomic<std::uint32_t> window_count{0};
+            std::atomic<std::uint64_t> suppressed{0};
+
+            // sites that suppressed something are listed once, for the summaries on log_flush()
+            std::atomic<bool> listed{false};
+            log_site *next = nullptr;
+        };
+
+        inline std::atomic<std::uint32_t> g_log_rate_limit{0};
+
+        // slow path of log_admit(): counts the window, lists the site when it suppresses
+        bool log_rate_check(log_site &site) noexcept;
+
+        [[nodiscard]] inline bool log_admit(log_site &site) noexcept {
+            return g_log_rate_limit.load(std::memory_order_relaxed) == 0 || log_rate_check(site);
+        }
+
+        void log_submit_deferred(const log_site &site, std::uint64_t suppressed, const char *payload,
+                                 std::size_t size) noexcept;
+
+        void log_submit_summary(const log_site &site, std::uint64_t suppressed) noexcept;
+
+        // a summary record for every listed site with something suppressed, log_flush() calls it
+        void log_submit_summaries() noexcept;
+
+        // "[WARNING][shader]: ", shared by the writer thread and decode_log()
+        void log_write_prefix(std::FILE *out, log_level level, log_subsystem subsystem) noexcept;
+
+        // a call site as the writer thread or decode_log() see it
+        struct log_site_view {
+            log_level level = log_level::info;
+            log_subsystem subsystem = log_subsystem::general;
+            std::string_view format;
+            std::string_view file;
+            int line = 0;
+            const log_arg_type *types = nullptr;
+            std::size_t arg_count = 0;
+        };
+
+        // one line: the payload formatted with the site's format string. scratch is reused between calls
+        void log_write_record(std::FILE *out, const log_site_view &site, std::uint64_t suppressed,
+                              const char *payload, std::size_t size, std::string &scratch) noexcept;
+
+        void log_write_summary(std::FILE *out, const log_site_view &site, std::uint64_t suppressed) noexcept;
+
+        // binary log: the magic, then chunks starting with their tag. a site is written once per file, before
+        // the first record referring to it
+        inline constexpr char log_binary_magic[8] = "SGLLOG1";
+
+        enum class log_chunk : char {
+            site = 'S', // u32 id, u8 level, u8 subsystem, u32 line, u16 + file, u16 + format, u8 + arg types
+            record = 'R', // u32 site id, u64 suppressed, u16 + payload
+            text = 'T', // u8 level, u8 subsystem, u8 truncated, u16 + text
+            summary = 'X' // u32 site id, u64 suppressed
+        };
+
+        template<typename T>
+        struct log_dependent_false : std::false_type {};
+
+        template<typename T>
+        consteval log_arg_type log_arg_type_of() noexcept {
+            using U = std::remove_cvref_t<T>;
+            if constexpr (std::is_same_v<U, bool>) {
+                return log_arg_type::boolean;
+            } else if constexpr (std::is_same_v<U, char>) {
+                return log_arg_type::character;
+            } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+                return log_arg_type::i64;
+            } else if constexpr (std::is_integral_v<U>) {
+                return log_arg_type::u64;
+            } else if constexpr (std::is_same_v<U, float>) {
+                return log_arg_type::f32;
+            } else if constexpr (std::is_same_v<U, double>) {
+                return log_arg_type::f64;
+            } else if constexpr (std::is_convertible_v<const U &, std::string_view>) {
+                return log_arg_type::string;
+            } else if constexpr (std::is_pointer_v<std::decay_t<U>>) {
+                return log_arg_type::pointer;
+            } else {
+                static_assert(log_dependent_false<U>::value, "SGL_DLOG: argument can't be copied into a record");
+                return log_arg_type::count;
+            }
+        }
+
+        // bytes an argument takes at least: strings are a 16 bit length and their characters
+        constexpr std::size_t log_arg_size(log_arg_type type) noexcept {
+            switch (type) {
+                case log_arg_type::i64:
+                case log_arg_type::u64:
+                case log_arg_type::f64:
+                case log_arg_type::pointer:
+                    return 8;
+                case log_arg_type::f32:
+                    return 4;
+                case log_arg_type::boolean:
+                case log_arg_type::character:
+                    return 1;
+                case log_arg_type::string:
+                default:
+                    return 2;
+            }
+        }
+
+        template<typename... Args>
+        struct log_arg_list {};
+
+        // only for decltype in SGL_DLOG, deduces like log_deferred() does
+        template<typename... Args>
+        log_arg_list<Args...> log_arg_list_of(Args &&...) noexcept;
+
+        template<typename List>
+        inline constexpr std::array<log_arg_type, 0> log_arg_types{};
+
+        template<typename... Args>
+        inline constexpr std::array<log_arg_type, sizeof...(Args)> log_arg_types<log_arg_list<Args...>>{
+            log_arg_type_of<Args>()...
+        };
+
+        class log_packer {
+        public:
+            log_packer(char *buf, std::size_t capacity) noexcept : m_buf(buf), m_capacity(capacity) {}
+
+            // reserve: bytes the arguments after this one need at least
+            template<typename T>
+            void put(const T &v, std::size_t reserve) noexcept {
+                constexpr log_arg_type type = log_arg_type_of<T>();
+                if constexpr (type == log_arg_type::string) {
+                    std::string_view s;
+                    if constexpr (std::is_pointer_v<T>) {
+                        if (v) {
+                            s = v;
+                        }
+                    } else {
+                        s = v;
+                    }
+                    const std::size_t room = m_capacity - m_size - reserve - 2;
+                    const auto n = static_cast<std::uint16_t>(std::min(s.size(), room));
+                    write(n);
+                    if (n) {
+                        std::memcpy(m_buf + m_size, s.data(), n);
+                        m_size += n;
+                    }
+                } else if constexpr (type == log_arg_type::pointer) {
+                    write(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(v)));
+                } else if constexpr (type == log_arg_type::i64) {
+                    write(static_cast<std::int64_t>(v));
+                } else if constexpr (type == log_arg_type::u64) {
+                    write(static_cast<std::uint64_t>(v));
+                } else {
+                    write(v);
+                }
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+        private:
+            template<typename T>
+            void write(const T &v) noexcept {
+                std::memcpy(m_buf + m_size, &v, sizeof(T));
+                m_size += sizeof(T);
+            }
+
+            char *m_buf;
+            std::size_t m_capacity;
+            std::size_t m_size = 0;
+        };
+
+        template<typename... Args>
+        void log_deferred(log_site &site, fmt::format_string<Args...> fmt, Args &&... args) noexcept {
+            static_cast<void>(fmt); // checked at compile time, the site keeps the string
+
+            if (!log_wanted(site.subsystem, site.level) || !log_admit(site)) {
+                return;
+            }
+
+            using list = log_arg_list<Args...>;
+            static_assert([] {
+                std::size_t total = 0;
+                for (const log_arg_type t: log_arg_types<list>) {
+                    total += log_arg_size(t);
+                }
+                return total <= log_max_message && sizeof...(Args) <= 255;
+            }(), "SGL_DLOG: too many arguments for a record");
+
+            // what the arguments after each one need at least, so a long string can't crowd them out
+            [[maybe_unused]] constexpr std::array<std::size_t, sizeof...(Args)> reserve = [] {
+                std::array<std::size_t, sizeof...(Args)> r{};
+                std::size_t after = 0;
+                for (std::size_t i = r.size(); i-- > 0;) {
+                    r[i] = after;
+                    after += log_arg_size(log_arg_types<list>[i]);
+                }
+                return r;
+            }();
+
+            char buf[log_max_message];
+            log_packer packer{buf, sizeof(buf)};
+            [[maybe_unused]] std::size_t i = 0;
+            (packer.put(args, reserve[i++]), ...);
+
+            std::uint64_t suppressed = 0;
+            if (site.suppressed.load(std::memory_order_relaxed) != 0) {
+                suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+            }
+            log_submit_deferred(site, suppressed, buf, packer.size());
+        }
+    }
+}
+
+#define SGL_DLOG(level_, subsystem_, format_, ...)                                                                   \
+    do {                                                                                                             \
+        if constexpr (::sgl::log_compiled(level_)) {                                                                 \
+            using sgl_dlog_args_ = decltype(::sgl::detail::log_arg_list_of(__VA_ARGS__));                            \
+            static constinit ::sgl::detail::log_site sgl_dlog_site_{                                                 \
+                level_, subsystem_, format_, __FILE__, __LINE__,                                                     \
+                ::sgl::detail::log_arg_types<sgl_dlog_args_>.data(),                                                 \
+                ::sgl::detail::log_arg_types<sgl_dlog_args_>.size()                                                  \
+            };                                                                                                       \
+            ::sgl::detail::log_deferred(sgl_dlog_site_, format_ __VA_OPT__(,) __VA_ARGS__);                          \
+        }                                                                                                            \
+    } while (false)
+
+#define SGL_DLOG_DEBUG(subsystem_, format_, ...) \
+    SGL_DLOG(::sgl::log_level::debug, subsystem_, format_ __VA_OPT__(,) __VA_ARGS__)
+#define SGL_DLOG_INFO(subsystem_, format_, ...) \
+    SGL_DLOG(::sgl::log_level::info, subsystem_, format_ __VA_OPT__(,) __VA_ARGS__)
+#define SGL_DLOG_WARN(subsystem_, format_, ...) \
+    SGL_DLOG(::sgl::log_level::warn, subsystem_, format_ __VA_OPT__(,) __VA_ARGS__)
+#define SGL_DLOG_ERROR(subsystem_, format_, ...) \
+    SGL_DLOG(::sgl::log_level::error, subsystem_, format_ __VA_OPT__(,) __VA_ARGS__)
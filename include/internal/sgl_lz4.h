@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sgl {
+    // LZ4 block format (no frame header, no checksums): compatible with LZ4_compress_default /
+    // LZ4_decompress_safe. the size of the decompressed data is stored by the caller
+
+    [[nodiscard]] constexpr std::size_t lz4_compress_bound(std::size_t size) noexcept {
+        return size + size / 255 + 16;
+    }
+
+    // greedy single-probe matcher: fast, ratio a bit below the reference compressor. replaces out
+    void lz4_compress(const std::uint8_t *src, std::size_t size, std::vector<std::uint8_t> &out) noexcept;
+
+    // bounds-checked, false on malformed input or when the output is not exactly dst_size bytes
+    bool lz4_decompress(const std::uint8_t *src, std::size_t size, std::uint8_t *dst, std::size_t dst_size) noexcept;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "sgl_expected.h"
+
+namespace sgl {
+    enum class mapped_file_error {
+        invalid_params = 0,
+        open_failed,
+        stat_failed,
+        mmap_failed,
+        read_failed,
+        count
+    };
+
+    // read-ahead hint for the mapping
+    enum class file_access {
+        sequential, // MADV_SEQUENTIAL + MADV_WILLNEED: parsed front to back (images, shaders)
+        random, // MADV_RANDOM: sparse lookups (archives)
+    };
+
+    // read-only view of a whole file. big files are mmap'ed, small ones are read with a single pread
+    // into an owned buffer: below a few pages the copy is cheaper than setting up the mapping and faulting it in
+    class mapped_file {
+    public:
+        using error = mapped_file_error;
+        using result = expected<mapped_file, error>;
+
+        static constexpr std::size_t small_file_size = 64 * 1024;
+
+        // ctors and assignments
+
+        mapped_file(const mapped_file &) = delete;
+
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        mapped_file(mapped_file &&other) noexcept;
+
+        mapped_file &operator=(mapped_file &&other) noexcept;
+
+        ~mapped_file();
+
+        // fabrics
+
+        static result create(const char *path, file_access access = file_access::sequential) noexcept;
+
+        static result create(const std::string &path, file_access access = file_access::sequential) noexcept {
+            return create(path.c_str(), access);
+        }
+
+        // api
+
+        [[nodiscard]] const std::uint8_t *data() const noexcept { return m_data; }
+        [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+        [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+        // false for small files that were read instead
+        [[nodiscard]] bool is_mapped() const noexcept { return m_data && !m_owned; }
+
+        [[nodiscard]] std::span<const std::uint8_t> bytes() const noexcept { return {m_data, m_size}; }
+
+        // not null-terminated
+        [[nodiscard]] std::string_view text() const noexcept {
+            return {reinterpret_cast<const char *>(m_data), m_size};
+        }
+
+        inline constexpr static const char *err_to_str(error e) noexcept {
+            switch (e) {
+                case error::invalid_params: return "invalid params";
+                case error::open_failed: return "open() failed";
+                case error::stat_failed: return "fstat() failed";
+                case error::mmap_failed: return "mmap() failed";
+                case error::read_failed: return "pread() failed";
+                default: return "unknown mapped_file_error";
+            }
+        }
+
+    private:
+        mapped_file(const std::uint8_t *data, std::size_t size, std::unique_ptr<std::uint8_t[]> owned) noexcept
+            : m_data{data}, m_size{size}, m_owned{std::move(owned)} {
+        }
+
+        void destroy() noexcept;
+
+        const std::uint8_t *m_data = nullptr;
+        std::size_t m_size = 0;
+        std::unique_ptr<std::uint8_t[]> m_owned; // small-file path
+    };
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sgl {
+    // HDR-style log-linear histogram of durations: 16 sub-buckets per power of two (at most 6.25% error),
+    // 1 us resolution, up to ~70 min. fixed size, record() never allocates
+    class time_histogram {
+    public:
+        void record(double ms) noexcept;
+
+        // undoes one record(ms), for rolling windows. max_ms() keeps the largest ever recorded
+        void remove(double ms) noexcept;
+
+        // p in [0, 100]
+        [[nodiscard]] double percentile(double p) const noexcept;
+
+        [[nodiscard]] double max_ms() const noexcept { return m_max_ms; }
+
+        [[nodiscard]] double avg_ms() const noexcept {
+            return m_count ? m_sum_ms / static_cast<double>(m_count) : 0.0;
+        }
+
+        [[nodiscard]] std::uint64_t count() const noexcept { return m_count; }
+
+        // samples strictly above ms
+        [[nodiscard]] std::uint64_t count_above(double ms) const noexcept;
+
+        void reset() noexcept;
+
+    private:
+        static constexpr int sub_bits = 4;
+        static constexpr std::size_t sub_count = std::size_t{1} << sub_bits;
+        static constexpr int max_exponent = 31;
+        static constexpr std::size_t bucket_count = (max_exponent - sub_bits + 2) * sub_count;
+
+        [[nodiscard]] static std::size_t bucket_of(std::uint64_t us) noexcept;
+
+        [[nodiscard]] static double bucket_value_ms(std::size_t index) noexcept;
+
+        std::array<std::uint32_t, bucket_count> m_counts{};
+        std::uint64_t m_count = 0;
+        double m_sum_ms = 0.0;
+        double m_max_ms = 0.0;
+    };
+}
+
+// renderer counters. sgl bumps them where the GL work happens (render::draw_*, binds, uploads, creations),
+// window::swap_buffers() closes the frame. counters are relaxed atomics, everything else is GL thread only
+namespace sgl::metrics {
+    enum class counter {
+        draw_calls = 0,
+        triangles,
+        state_changes, // program, vertex array, texture, sampler, framebuffer binds and render:: state
+        uniform_uploads,
+        buffer_bytes, // uploaded
+        texture_bytes, // uploaded
+        shaders_created,
+        textures_created,
+        gl_calls, // SGL_GL_TRACE builds only
+        count
+    };
+
+    inline constexpr std::size_t counter_count = static_cast<std::size_t>(counter::count);
+
+    [[nodiscard]] const char *counter_name(counter c) noexcept;
+
+    namespace detail {
+        inline std::array<std::atomic<std::uint64_t>, counter_count> g_counters{};
+    }
+
+    inline void add(counter c, std::uint64_t n = 1) noexcept {
+        detail::g_counters[static_cast<std::size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    struct frame {
+        std::uint64_t index = 0;
+        double frame_ms = 0.0;
+        std::array<std::uint64_t, counter_count> counters{};
+
+        [[nodiscard]] std::uint64_t operator[](counter c) const noexcept {
+            return counters[static_cast<std::size_t>(c)];
+        }
+    };
+
+    // everything since the previous dump / reset()
+    struct summary {
+        std::int64_t unix_ms = 0; // wall clock at summarize()
+        std::uint64_t frames = 0;
+        double seconds = 0.0;
+        std::array<std::uint64_t, counter_count> totals{};
+        double frame_avg_ms = 0.0;
+        double frame_p50_ms = 0.0;
+        double frame_p95_ms = 0.0;
+        double frame_p99_ms = 0.0;
+        double frame_max_ms = 0.0;
+
+        [[nodiscard]] double per_frame(counter c) const noexcept {
+            return frames ? static_cast<double>(totals[static_cast<std::size_t>(c)]) / static_cast<double>(frames)
+                          : 0.0;
+        }
+    };
+
+    enum class dump_format {
+        json, // one object per line (JSON Lines)
+        csv // header row when the file is new
+    };
+
+    // closes the frame: snapshots and zeroes the counters, records the frame time, dumps when due
+    void end_frame() noexcept;
+
+    [[nodiscard]] const frame &last_frame() noexcept;
+
+    [[nodiscard]] summary summarize() noexcept;
+
+    [[nodiscard]] const time_histogram &frame_times() noexcept;
+
+    // starts a new summary window
+    void reset() noexcept;
+
+    // appends summarize() to path every interval_sec (written on a worker), then reset(). nullptr or
+    // interval_sec <= 0 stops
+    void set_periodic_dump(const char *path, dump_format format, double interval_sec = 1.0) noexcept;
+
+    [[nodiscard]] std::string to_json(const summary &s) noexcept;
+
+    [[nodiscard]] std::string csv_header() noexcept;
+
+    [[nodiscard]] std::string to_csv(const summary &s) noexcept;
+
+    // appends one record
+    bool write(const char *path, dump_format format, const summary &s) noexcept;
+}
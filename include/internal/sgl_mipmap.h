@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sgl_type.h"
+
+namespace sgl {
+    struct mip_level {
+        gl_int width = 0;
+        gl_int height = 0;
+        std::vector<std::uint8_t> pixels; // tightly packed, channels bytes per pixel
+    };
+
+    struct mip_chain_params {
+        bool srgb = false; // color channels are sRGB encoded: filter in linear space
+        bool premultiply_alpha = false; // output premultiplied levels (2 and 4 channels only)
+        gl_int max_levels = 0; // 0 = full chain down to 1x1
+    };
+
+    struct mip_chain {
+        gl_int channels = 0;
+        std::vector<mip_level> levels; // [0] is the base level
+    };
+
+    // builds the chain down to 1x1 (or max_levels) with a 2x2 box filter on the CPU.
+    // safe to call from any thread, does not touch GL
+    mip_chain build_mip_chain(
+        const std::uint8_t *data, gl_int width, gl_int height, gl_int channels, const mip_chain_params &params
+    ) noexcept;
+
+    gl_int mip_level_count(gl_int width, gl_int height) noexcept;
+}
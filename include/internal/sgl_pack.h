@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sgl_expected.h"
+#include "sgl_mapped_file.h"
+
+namespace sgl {
+    // .sglpack: many asset files in one mapping. a table of contents sorted by the FNV-1a hash of the
+    // normalized path (binary search, names are kept to settle collisions), entries stored raw or as
+    // one LZ4 block each, data 16-byte aligned. build with tools/pack (sgl_pack <dir> <out.sglpack>)
+
+    enum class pack_error {
+        invalid_params = 0,
+        open_failed,
+        file_invalid,
+        count
+    };
+
+    struct pack_entry {
+        std::string_view name;
+        std::size_t size = 0; // unpacked
+        std::size_t stored_size = 0;
+        bool compressed = false;
+    };
+
+    // input of pack::write: name inside the pack and file to read it from
+    struct pack_source {
+        std::string name;
+        std::string path;
+    };
+
+    class pack {
+    public:
+        using error = pack_error;
+        using result = expected<pack, error>;
+
+        // ctors and assignments
+
+        pack(const pack &) = delete;
+
+        pack &operator=(const pack &) = delete;
+
+        pack(pack &&other) noexcept;
+
+        pack &operator=(pack &&other) noexcept;
+
+        ~pack() = default;
+
+        // fabrics
+
+        static result create(const char *path) noexcept;
+
+        static result create(const std::string &path) noexcept {
+            return create(path.c_str());
+        }
+
+        // compress: LZ4 where it saves at least 1/16, already compressed formats are stored as they are
+        static bool write(const char *path, std::span<const pack_source> sources, bool compress = true) noexcept;
+
+        // api
+
+        [[nodiscard]] std::size_t size() const noexcept { return m_count; }
+
+        [[nodiscard]] pack_entry entry(std::size_t index) const noexcept;
+
+        [[nodiscard]] bool contains(std::string_view path) const noexcept { return find(path) != npos; }
+
+        // index for entry() / view_at() / read_at(), npos when missing: one lookup for several calls
+        [[nodiscard]] std::size_t find(std::string_view path) const noexcept;
+
+        // raw entries only: the bytes inside the mapping, empty otherwise
+        [[nodiscard]] std::span<const std::uint8_t> view(std::string_view path) const noexcept {
+            return view_at(find(path));
+        }
+
+        [[nodiscard]] std::span<const std::uint8_t> view_at(std::size_t index) const noexcept;
+
+        // unpacks into out, false when missing or corrupt
+        bool read(std::string_view path, std::vector<std::uint8_t> &out) const noexcept {
+            return read_at(find(path), out);
+        }
+
+        bool read_at(std::size_t index, std::vector<std::uint8_t> &out) const noexcept;
+
+        // './' prefixes dropped, '\' -> '/'
+        static std::string normalize_path(std::string_view path) noexcept;
+
+        inline constexpr static const char *err_to_str(error e) noexcept {
+            switch (e) {
+                case error::invalid_params: return "invalid params";
+                case error::open_failed: return "failed to open file";
+                case error::file_invalid: return "not a valid sgl pack";
+                default: return "unknown pack_error";
+            }
+        }
+
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    private:
+        pack(mapped_file file, std::size_t count, std::size_t toc_offset, std::size_t names_offset) noexcept
+            : m_file{std::move(file)}, m_count{count}, m_toc_offset{toc_offset}, m_names_offset{names_offset} {
+        }
+
+        mapped_file m_file;
+        std::size_t m_count = 0;
+        std::size_t m_toc_offset = 0;
+        std::size_t m_names_offset = 0;
+    };
+
+    // mounted packs are searched (last mounted first) before the file system by every sgl loader:
+    // shaders, images, .sgltex, read_text_file. thread-safe
+    bool mount_pack(const char *path) noexcept;
+
+    void unmount_packs() noexcept;
+
+    // a file from a mounted pack or else from disk (mapped_file)
+    class asset_file {
+    public:
+        using error = mapped_file_error;
+        using result = expected<asset_file, error>;
+
+        // fabrics
+
+        static result create(const char *path, file_access access = file_access::sequential) noexcept;
+
+        // api
+
+        [[nodiscard]] const std::uint8_t *data() const noexcept { return m_bytes.data(); }
+        [[nodiscard]] std::size_t size() const noexcept { return m_bytes.size(); }
+        [[nodiscard]] bool empty() const noexcept { return m_bytes.empty(); }
+        [[nodiscard]] bool from_pack() const noexcept { return m_pack != nullptr; }
+
+        [[nodiscard]] std::span<const std::uint8_t> bytes() const noexcept { return m_bytes; }
+
+        [[nodiscard]] std::string_view text() const noexcept {
+            return {reinterpret_cast<const char *>(m_bytes.data()), m_bytes.size()};
+        }
+
+    private:
+        asset_file() noexcept = default;
+
+        std::shared_ptr<const pack> m_pack; // keeps a raw view valid after unmount_packs()
+        std::optional<mapped_file> m_file;
+        std::vector<std::uint8_t> m_unpacked;
+        std::span<const std::uint8_t> m_bytes;
+    };
+}
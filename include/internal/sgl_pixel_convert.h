@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sgl_type.h"
+
+namespace sgl {
+    // 8-bit pixel repacking for uploads. count is in pixels, src and dst must not overlap.
+    // kernels are picked once at runtime (AVX2, SSSE3 or scalar), any thread, no GL
+
+    // 3-byte rows are the slow driver path: expand to 4-byte pixels before glTexImage2D
+    void rgb_to_rgba(const std::uint8_t *src, std::uint8_t *dst, std::size_t count, std::uint8_t alpha = 255) noexcept;
+
+    void rgb_to_bgra(const std::uint8_t *src, std::uint8_t *dst, std::size_t count, std::uint8_t alpha = 255) noexcept;
+
+    // in place, rgb *= a / 255 in storage space (no sRGB decode, see build_mip_chain for that)
+    void premultiply_rgba(std::uint8_t *pixels, std::size_t count) noexcept;
+
+    // one channel of interleaved pixels into an R8 plane, e.g. gray stored as RGB
+    void extract_channel(
+        const std::uint8_t *src, gl_int channels, gl_int channel, std::uint8_t *dst, std::size_t count
+    ) noexcept;
+
+    // in place through 256-entry tables, alpha (channel 2 of 2 and 4 of 4) is left untouched
+    void srgb_to_linear(std::uint8_t *pixels, gl_int channels, std::size_t count) noexcept;
+
+    void linear_to_srgb(std::uint8_t *pixels, gl_int channels, std::size_t count) noexcept;
+
+    // float -> IEEE half, round to nearest even. F16C when the CPU has it
+    void float_to_half(const float *src, std::uint16_t *dst, std::size_t count) noexcept;
+
+    // rgb floats (channels 3 or 4, alpha ignored) -> GL_R11F_G11F_B10F texels, red in the low bits.
+    // negatives become 0, values above the format max are clamped to it
+    void pack_r11g11b10f(const float *src, gl_int channels, std::uint32_t *dst, std::size_t count) noexcept;
+
+    // "avx2", "ssse3" or "scalar"
+    const char *pixel_convert_isa() noexcept;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "sgl_type.h"
+
+namespace sgl {
+    // 8-bit gray, gray+alpha, RGB or RGBA, rows top-down and tightly packed
+
+    bool encode_png(
+        const std::uint8_t *pixels, gl_sizei width, gl_sizei height, gl_int channels, std::vector<std::uint8_t> &out
+    ) noexcept;
+
+    bool write_png(const char *path, const std::uint8_t *pixels, gl_sizei width, gl_sizei height, gl_int channels) noexcept;
+
+    // takes ownership of the pixels and encodes + writes on a worker thread
+    std::future<bool> write_png_async(
+        std::string path, std::vector<std::uint8_t> pixels, gl_sizei width, gl_sizei height, gl_int channels
+    ) noexcept;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// cpu zone profiler. configure with -DSGL_PROFILER=ON, otherwise SGL_ZONE expands to nothing and the
+// recording functions are empty stubs
+
+#ifndef SGL_PROFILER
+#define SGL_PROFILER 0
+#endif
+
+#define SGL_ZONE_CONCAT_IMPL(a, b) a##b
+#define SGL_ZONE_CONCAT(a, b) SGL_ZONE_CONCAT_IMPL(a, b)
+
+#if SGL_PROFILER
+// times the rest of the enclosing block. name must be a literal (only the pointer is stored)
+#define SGL_ZONE(name) const ::sgl::profiler_zone SGL_ZONE_CONCAT(sgl_zone_, __LINE__){name}
+#else
+#define SGL_ZONE(name) static_cast<void>(0)
+#endif
+
+namespace sgl {
+    // events kept per thread, older ones are overwritten
+    inline constexpr std::size_t profiler_ring_size = 1 << 16;
+
+    [[nodiscard]] inline std::uint64_t profiler_now_ns() noexcept {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count());
+    }
+
+    // shown as the thread's name in the trace
+    void profiler_set_thread_name(const char *name) noexcept;
+
+    // Chrome trace event JSON (chrome://tracing, ui.perfetto.dev) of every event still in the rings,
+    // gpu_profiler scopes on their own track. false without SGL_PROFILER
+    bool profiler_write_chrome_trace(const char *path) noexcept;
+
+    // drops every recorded event
+    void profiler_clear() noexcept;
+
+    namespace detail {
+        // Chrome trace building blocks, also used by the flight recorder
+
+        void append_json_string(std::string &out, std::string_view s) noexcept;
+
+        // ",{...}" thread names and cpu zones overlapping [begin_ns, end_ns], ts relative to origin_ns.
+        // appends nothing without SGL_PROFILER
+        void profiler_append_cpu_events(std::string &out, std::uint64_t begin_ns, std::uint64_t end_ns,
+                                        std::uint64_t origin_ns) noexcept;
+
+        // lock-free: each thread writes only into its own ring
+        void profiler_record(const char *name, std::uint64_t begin_ns, std::uint64_t end_ns, std::uint32_t depth,
+                             bool gpu) noexcept;
+
+        inline thread_local std::uint32_t profiler_depth = 0;
+    }
+
+    class profiler_zone {
+    public:
+        explicit profiler_zone(const char *name) noexcept : m_name{name}, m_depth{detail::profiler_depth++},
+                                                            m_begin{profiler_now_ns()} {
+        }
+
+        profiler_zone(const profiler_zone &) = delete;
+
+        profiler_zone &operator=(const profiler_zone &) = delete;
+
+        ~profiler_zone() {
+            detail::profiler_record(m_name, m_begin, profiler_now_ns(), m_depth, false);
+            --detail::profiler_depth;
+        }
+
+    private:
+        const char *m_name;
+        std::uint32_t m_depth;
+        std::uint64_t m_begin;
+    };
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sgl_type.h"
+
+namespace sgl {
+    // "Quite OK Image" format: lossless, decodes several times faster than PNG. rows top-down
+
+    struct qoi_image {
+        gl_int width = 0;
+        gl_int height = 0;
+        gl_int channels = 0; // 3 or 4
+        std::vector<std::uint8_t> pixels;
+    };
+
+    [[nodiscard]] bool is_qoi(const std::uint8_t *data, std::size_t size) noexcept;
+
+    // false on a malformed or truncated stream
+    bool decode_qoi(const std::uint8_t *data, std::size_t size, qoi_image &out) noexcept;
+
+    // channels 3 or 4
+    bool encode_qoi(
+        const std::uint8_t *pixels, gl_int width, gl_int height, gl_int channels, std::vector<std::uint8_t> &out
+    ) noexcept;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "sgl_expected.h"
+#include "sgl_type.h"
+
+namespace sgl {
+    class framebuffer;
+
+    enum class readback_error {
+        invalid_params = 0,
+        gl_gen_failed,
+        count
+    };
+
+    struct readback_image {
+        gl_sizei width = 0;
+        gl_sizei height = 0;
+        std::vector<std::uint8_t> pixels; // RGBA8, rows top-down
+        std::uint64_t frame = 0; // value of frame() when requested
+    };
+
+    using readback_callback = std::function<void(readback_image image)>;
+
+    struct readback_params {
+        gl_sizei ring_size = 3; // in-flight requests, also the typical latency in frames
+    };
+
+    // glReadPixels into a ring of pixel pack buffers fenced with glFenceSync. results are mapped only
+    // once the GPU is done, so the pipeline never stalls on a readback
+    class readback_queue {
+    public:
+        using error = readback_error;
+        using result = expected<readback_queue, error>;
+
+        // ctors and assignments
+
+        readback_queue(const readback_queue &) = delete;
+
+        readback_queue &operator=(const readback_queue &) = delete;
+
+        readback_queue(readback_queue &&other) noexcept;
+
+        readback_queue &operator=(readback_queue &&other) noexcept;
+
+        ~readback_queue();
+
+        // fabrics
+
+        static result create(const readback_params &params = {}) noexcept;
+
+        // try wrappers
+
+        static readback_queue create_try(const readback_params &params = {}) noexcept;
+
+        // api
+
+        // reads from the current read framebuffer. false when every slot is in flight (request dropped)
+        bool request(gl_int x, gl_int y, gl_sizei width, gl_sizei height, readback_callback cb) noexcept;
+
+        bool request(const framebuffer &fb, readback_callback cb) noexcept;
+
+        // non-blocking: delivers finished requests in order. call once per frame
+        void poll() noexcept;
+
+        // delivers every in-flight request, waiting up to 1s for each. false when one timed out: it and the
+        // later ones stay in flight
+        bool flush() noexcept;
+
+        [[nodiscard]] std::uint64_t frame() const noexcept { return m_frame; }
+
+        [[nodiscard]] std::size_t in_flight() const noexcept;
+
+        inline constexpr static const char *err_to_str(error e) noexcept {
+            switch (e) {
+                case error::invalid_params: return "invalid params";
+                case error::gl_gen_failed: return "glGenBuffers() failed";
+                default: return "unknown readback_error";
+            }
+        }
+
+    private:
+        struct slot {
+            gl_uint pbo = 0;
+            void *fence = nullptr; // GLsync
+            gl_sizeiptr capacity = 0;
+            gl_sizei width = 0;
+            gl_sizei height = 0;
+            std::uint64_t frame = 0;
+            std::uint64_t seq = 0;
+            readback_callback cb;
+        };
+
+        readback_queue() noexcept = default;
+
+        [[nodiscard]] slot *oldest_in_flight() noexcept;
+
+        bool deliver(slot &s, bool wait) noexcept;
+
+        void destroy() noexcept;
+
+        std::vector<slot> m_slots;
+        std::uint64_t m_frame = 0;
+        std::uint64_t m_next_seq = 0;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "sgl_color.h"
+#include "sgl_type.h"
 
 namespace sgl::render {
     void set_clear_color(float r, float g, float b, float a) noexcept;
@@ -26,4 +27,17 @@ namespace sgl::render {
     void set_polygon_mode_point() noexcept;
 
     void set_line_width(float width) noexcept;
+
+    // glDraw* counted by sgl::metrics (draw calls, triangles)
+
+    void draw_arrays(gl_enum mode, gl_int first, gl_sizei count) noexcept;
+
+    void draw_arrays_instanced(gl_enum mode, gl_int first, gl_sizei count, gl_sizei instances) noexcept;
+
+    // offset in bytes into the bound element buffer
+    void draw_elements(gl_enum mode, gl_sizei count, gl_enum index_type, const void *offset = nullptr) noexcept;
+
+    void draw_elements_instanced(
+        gl_enum mode, gl_sizei count, gl_enum index_type, gl_sizei instances, const void *offset = nullptr
+    ) noexcept;
 }
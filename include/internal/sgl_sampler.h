@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "sgl_expected.h"
+#include "sgl_type.h"
+#include "sgl_texture.h"
+
+namespace sgl {
+    enum class sampler_error {
+        invalid_params = 0,
+        gl_gen_failed,
+        count
+    };
+
+    struct sampler_params {
+        texture_wrap wrap_s = texture_wrap::repeat;
+        texture_wrap wrap_t = texture_wrap::repeat;
+
+        texture_min_filter min_filter = texture_min_filter::linear_mipmap_linear;
+        texture_mag_filter mag_filter = texture_mag_filter::linear;
+
+        bool operator==(const sampler_params &) const noexcept = default;
+    };
+
+    // the sampler part of texture params
+    constexpr sampler_params to_sampler_params(const texture_2d_params &p) noexcept {
+        return {.wrap_s = p.wrap_s, .wrap_t = p.wrap_t, .min_filter = p.min_filter, .mag_filter = p.mag_filter};
+    }
+
+    class sampler {
+    public:
+        using error = sampler_error;
+        using result = expected<sampler, error>;
+
+        // ctors and assignments
+
+        sampler(const sampler &) = delete;
+
+        sampler &operator=(const sampler &) = delete;
+
+        sampler(sampler &&other) noexcept;
+
+        sampler &operator=(sampler &&other) noexcept;
+
+        ~sampler();
+
+        // fabrics
+
+        static result create(const sampler_params &params) noexcept;
+
+        // try wrappers
+
+        static sampler create_try(const sampler_params &params) noexcept;
+
+        // api
+
+        // overrides the sampling state of whatever texture is bound to the unit
+        void bind(gl_uint unit) const noexcept;
+
+        static void unbind(gl_uint unit) noexcept;
+
+        [[nodiscard]] gl_uint id() const noexcept { return m_id; }
+        [[nodiscard]] const sampler_params &params() const noexcept { return m_params; }
+
+        inline constexpr static const char *err_to_str(error e) noexcept {
+            switch (e) {
+                case error::invalid_params: return "invalid params";
+                case error::gl_gen_failed: return "glGenSamplers() failed";
+                default: return "unknown sampler_error";
+            }
+        }
+
+    private:
+        explicit sampler(gl_uint id, const sampler_params &params) noexcept : m_id{id}, m_params{params} {
+        }
+
+        void destroy() noexcept;
+
+        gl_uint m_id = 0;
+        sampler_params m_params{};
+    };
+
+    // one sampler object per distinct state. pointers stay valid until clear()
+    class sampler_cache {
+    public:
+        [[nodiscard]] const sampler *get(const sampler_params &params) noexcept;
+
+        [[nodiscard]] const sampler *get(const texture_2d_params &params) noexcept {
+            return get(to_sampler_params(params));
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return m_samplers.size(); }
+
+        void clear() noexcept { m_samplers.clear(); }
+
+    private:
+        static std::uint64_t key_of(const sampler_params &params) noexcept;
+
+        std::unordered_map<std::uint64_t, sampler> m_samplers;
+    };
+}
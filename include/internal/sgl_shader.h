@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "sgl_type.h"
@@ -45,6 +46,9 @@ namespace sgl {
             return create_from_source(vertex_src.c_str(), fragment_src.c_str());
         }
 
+        // need not be null-terminated: mapped files, sources baked in by sgl_embed_shaders (sgl_embed.h)
+        static result create_from_source(std::string_view vertex_src, std::string_view fragment_src) noexcept;
+
         static result create_from_files(const char *vertex_path, const char *fragment_path) noexcept;
 
         static result create_from_files(const std::string &vertex_path, const std::string &fragment_path) noexcept {
@@ -63,6 +67,8 @@ namespace sgl {
             return create_from_source_try(vertex_src.c_str(), fragment_src.c_str());
         }
 
+        static shader create_from_source_try(std::string_view vertex_src, std::string_view fragment_src) noexcept;
+
         static shader create_from_files_try(const char *vertex_path, const char *fragment_path) noexcept;
 
         static shader create_from_files_try(
@@ -156,7 +162,7 @@ namespace sgl {
         }
 
     private:
-        static gl_uint compile_shader(gl_enum type, const char *src, error &out_err) noexcept;
+        static gl_uint compile_shader(gl_enum type, std::string_view src, error &out_err) noexcept;
 
         static bool check_compile(gl_uint shader_id, const char *type_name) noexcept;
 
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sgl {
+    // GLSL has no #include: `#include "file"` lines (after #version, path relative to the including file)
+    // are replaced by that file, only the first time it is included. #line directives keep compiler messages
+    // pointing at the right line: source string 0 is the shader itself, includes count up from 1. files are read
+    // through asset_file
+
+    struct shader_source {
+        std::string text;
+        std::vector<std::string> files; // the shader first, then everything it pulled in
+    };
+
+    // false with a message on a missing file, an include cycle or a malformed directive
+    bool expand_shader_includes(const char *path, shader_source &out, std::string &error) noexcept;
+
+    // cheap test before paying for the expansion
+    [[nodiscard]] bool has_shader_includes(std::string_view src) noexcept;
+}
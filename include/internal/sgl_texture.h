@@ -1,37 +1,49 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <future>
+#include <span>
+#include <vector>
 
 #include "sgl_expected.h"
 #include "sgl_type.h"
+#include "sgl_mipmap.h"
+#include "sgl_texture_format.h"
 
 namespace sgl {
     enum class texture_error {
         invalid_params = 0,
         stbi_load_failed,
         gl_gen_failed,
+        file_invalid,
         count
     };
 
-    enum class texture_wrap {
-        repeat,
-        mirrored_repeat,
-        clamp_to_edge,
-        clamp_to_border,
+    enum class texture_wrap : gl_enum {
+        repeat = 0x2901u, // GL_REPEAT
+        mirrored_repeat = 0x8370u, // GL_MIRRORED_REPEAT
+        clamp_to_edge = 0x812Fu, // GL_CLAMP_TO_EDGE
+        clamp_to_border = 0x812Du, // GL_CLAMP_TO_BORDER
     };
 
-    enum class texture_min_filter {
-        nearest,
-        linear,
-        nearest_mipmap_nearest,
-        linear_mipmap_nearest,
-        nearest_mipmap_linear,
-        linear_mipmap_linear,
+    enum class texture_min_filter : gl_enum {
+        nearest = 0x2600u, // GL_NEAREST
+        linear = 0x2601u, // GL_LINEAR
+        nearest_mipmap_nearest = 0x2700u, // GL_NEAREST_MIPMAP_NEAREST
+        linear_mipmap_nearest = 0x2701u, // GL_LINEAR_MIPMAP_NEAREST
+        nearest_mipmap_linear = 0x2702u, // GL_NEAREST_MIPMAP_LINEAR
+        linear_mipmap_linear = 0x2703u, // GL_LINEAR_MIPMAP_LINEAR
     };
 
-    enum class texture_mag_filter {
-        nearest,
-        linear,
+    enum class texture_mag_filter : gl_enum {
+        nearest = 0x2600u, // GL_NEAREST
+        linear = 0x2601u, // GL_LINEAR
+    };
+
+    enum class texture_hdr_format : gl_enum {
+        rgba16f = 0x881Au, // GL_RGBA16F
+        r11g11b10f = 0x8C3Au, // GL_R11F_G11F_B10F: half the size, unsigned, no alpha
     };
 
     struct texture_2d_params {
@@ -45,12 +57,47 @@ namespace sgl {
         bool flip_vertically_on_load = true;
 
         bool srgb = false;
+
+        // build mips on the CPU (gamma-correct for srgb) instead of glGenerateMipmap
+        bool cpu_mipmaps = false;
+        // store premultiplied color, implies the CPU path
+        bool premultiply_alpha = false;
+
+        // analyze the pixels and pick a smaller internal format, implies the CPU path
+        texture_compaction compaction = texture_compaction::none;
+        // with compaction: keep only x/y in RG8
+        bool normal_map = false;
+
+        // storage for float images (.hdr)
+        texture_hdr_format hdr_format = texture_hdr_format::rgba16f;
+    };
+
+    struct texture_compaction_stats {
+        std::size_t textures = 0;
+        gl_sizeiptr saved_bytes = 0;
+    };
+
+    // decoded pixels + prebuilt mips, ready for a single upload on the GL thread
+    struct texture_2d_data {
+        mip_chain mips;
+        texture_2d_params params;
+        texture_format_choice format; // internal format and swizzle picked by compaction
+    };
+
+    // float image already packed into params.hdr_format, level 0 only
+    struct texture_2d_hdr_data {
+        gl_int width = 0;
+        gl_int height = 0;
+        std::vector<std::uint8_t> pixels; // 4 halves (rgba16f) or one uint32 (r11g11b10f) per texel
+        texture_2d_params params;
     };
 
     class texture_2d {
     public:
         using error = texture_error;
         using result = expected<texture_2d, error>;
+        using data_result = expected<texture_2d_data, error>;
+        using hdr_data_result = expected<texture_2d_hdr_data, error>;
 
         // ctors and assignments
 
@@ -66,6 +113,7 @@ namespace sgl {
 
         // fabrics
 
+        // .hdr/float images -> create_from_hdr_file, .sgltex -> create_from_sgltex, .qoi, the rest via stb_image
         static result create_from_file(const char *path) noexcept;
 
         static result create_from_file(const std::string &path) noexcept {
@@ -78,6 +126,73 @@ namespace sgl {
             return create_from_file(path.c_str(), params);
         }
 
+        static result create_from_data(const texture_2d_data &data) noexcept;
+
+        // .sgltex from write_sgltex() (see sgl_texconv): the levels are uploaded straight from the mapped file.
+        // the file decides format and mips, params only the sampling state
+        static result create_from_sgltex(const char *path, const texture_2d_params &params = {}) noexcept;
+
+        static result create_from_sgltex(const std::string &path, const texture_2d_params &params = {}) noexcept {
+            return create_from_sgltex(path.c_str(), params);
+        }
+
+        // any file stbi can decode to floats, .hdr files also go here from create_from_file()
+        static result create_from_hdr_file(const char *path, const texture_2d_params &params) noexcept;
+
+        static result create_from_hdr_file(const std::string &path, const texture_2d_params &params) noexcept {
+            return create_from_hdr_file(path.c_str(), params);
+        }
+
+        static result create_from_hdr_data(const texture_2d_hdr_data &data) noexcept;
+
+        // tightly packed 8-bit pixels in memory, rows bottom-up as GL expects. null pixels = uninitialized
+        static result create_from_pixels(
+            const void *pixels, gl_int width, gl_int height, gl_int channels, const texture_2d_params &params
+        ) noexcept;
+
+        // allocates all levels without data, fill them with set_level_data()
+        static result create_empty(
+            gl_int width, gl_int height, gl_int channels, gl_int levels, const texture_2d_params &params,
+            gl_enum internal_format_override = 0
+        ) noexcept;
+
+        // cpu side (no GL, any thread)
+
+        static data_result load_data(const char *path, const texture_2d_params &params) noexcept;
+
+        static data_result load_data(const std::string &path, const texture_2d_params &params) noexcept {
+            return load_data(path.c_str(), params);
+        }
+
+        // decode + mip generation on a worker thread, finish with create_from_data() on the GL thread
+        static std::future<data_result> load_async(const char *path, const texture_2d_params &params) noexcept;
+
+        static std::future<data_result> load_async(const std::string &path, const texture_2d_params &params) noexcept {
+            return load_async(path.c_str(), params);
+        }
+
+        // mips, compaction format and flags as-is, 3-channel levels expanded to 4
+        static bool write_sgltex(const char *path, const texture_2d_data &data) noexcept;
+
+        static bool write_sgltex(const std::string &path, const texture_2d_data &data) noexcept {
+            return write_sgltex(path.c_str(), data);
+        }
+
+        static hdr_data_result load_hdr_data(const char *path, const texture_2d_params &params) noexcept;
+
+        static hdr_data_result load_hdr_data(const std::string &path, const texture_2d_params &params) noexcept {
+            return load_hdr_data(path.c_str(), params);
+        }
+
+        // decode + half/packed-float conversion on a worker thread, finish with create_from_hdr_data()
+        static std::future<hdr_data_result> load_hdr_async(const char *path, const texture_2d_params &params) noexcept;
+
+        static std::future<hdr_data_result> load_hdr_async(
+            const std::string &path, const texture_2d_params &params
+        ) noexcept {
+            return load_hdr_async(path.c_str(), params);
+        }
+
         // try wrappers
 
         static texture_2d create_from_file_try(const char *path) noexcept;
@@ -92,25 +207,78 @@ namespace sgl {
             return create_from_file_try(path.c_str(), params);
         }
 
+        static texture_2d create_from_data_try(const texture_2d_data &data) noexcept;
+
+        static texture_2d create_from_hdr_file_try(const char *path, const texture_2d_params &params) noexcept;
+
+        static texture_2d create_from_hdr_file_try(const std::string &path, const texture_2d_params &params) noexcept {
+            return create_from_hdr_file_try(path.c_str(), params);
+        }
+
+        static texture_2d create_from_hdr_data_try(const texture_2d_hdr_data &data) noexcept;
+
+        static texture_2d create_from_pixels_try(
+            const void *pixels, gl_int width, gl_int height, gl_int channels, const texture_2d_params &params
+        ) noexcept;
+
         // api
 
         void bind(gl_uint unit) const noexcept;
 
         static void unbind(gl_uint unit) noexcept;
 
+        // pixels are tightly packed in format(), level size is derived from the base size.
+        // 3-channel data is expanded to 4-byte pixels on the way (see rgb_to_rgba)
+        void set_level_data(gl_int level, const void *pixels) const noexcept;
+
+        // glTexSubImage2D into level 0. row_length is the source stride in pixels (0 = width), format the
+        // layout of pixels (0 = format()). 3-channel client memory is expanded to 4-byte pixels on the way.
+        // with a GL_PIXEL_UNPACK_BUFFER bound, pixels is an offset into it: stage GL_RGBA there and pass it
+        void update_region(
+            gl_int x, gl_int y, gl_int width, gl_int height, const void *pixels, gl_int row_length = 0,
+            gl_enum format = 0
+        ) const noexcept;
+
+        // rebuilds levels 1.. from level 0 on the GPU
+        void generate_mipmaps() const noexcept;
+
+        // GL_TEXTURE_SWIZZLE_RGBA, e.g. {GL_RED, GL_RED, GL_RED, GL_ONE} to sample R8 as gray
+        void set_swizzle(const std::array<gl_enum, 4> &swizzle) const noexcept;
+
+        // restricts sampling to [level, levels() - 1]
+        void set_base_level(gl_int level) const noexcept;
+
         [[nodiscard]] gl_uint id() const noexcept { return m_id; }
 
         [[nodiscard]] gl_int width() const noexcept { return m_width; }
         [[nodiscard]] gl_int height() const noexcept { return m_height; }
+        [[nodiscard]] gl_int levels() const noexcept { return m_levels; }
 
         [[nodiscard]] gl_enum internal_format() const noexcept { return m_internal_format; }
         [[nodiscard]] gl_enum format() const noexcept { return m_format; }
 
+        [[nodiscard]] gl_sizeiptr vram_bytes() const noexcept {
+            return texture_vram_bytes(m_internal_format, m_width, m_height, m_levels);
+        }
+
+        // textures shrunk by texture_2d_params::compaction since startup
+        static texture_compaction_stats compaction_stats() noexcept;
+
         constexpr static const char *err_to_str(error e) noexcept;
 
     private:
-        explicit texture_2d(gl_uint id, gl_int w, gl_int h, gl_enum internal_format, gl_enum format) noexcept
-            : m_id{id}, m_width{w}, m_height{h}, m_internal_format{internal_format}, m_format{format} {
+        static bool pick_formats(int channels, bool srgb, gl_enum &format, gl_int &internal_format) noexcept;
+
+        // load_hdr_data() on bytes the caller already mapped, path is only for the log
+        static hdr_data_result decode_hdr_data(
+            std::span<const std::uint8_t> bytes, const char *path, const texture_2d_params &params
+        ) noexcept;
+
+        explicit texture_2d(
+            gl_uint id, gl_int w, gl_int h, gl_enum internal_format, gl_enum format, gl_int levels = 1
+        ) noexcept
+            : m_id{id}, m_width{w}, m_height{h}, m_levels{levels}, m_internal_format{internal_format},
+              m_format{format} {
         }
 
         void destroy() noexcept;
@@ -118,6 +286,7 @@ namespace sgl {
         gl_uint m_id = 0;
         gl_int m_width = 0;
         gl_int m_height = 0;
+        gl_int m_levels = 0;
         gl_enum m_internal_format = 0;
         gl_enum m_format = 0;
     };
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <span>
+
+#include "sgl_type.h"
+
+namespace sgl {
+    class texture_2d;
+    class sampler;
+
+    struct texture_bind {
+        gl_uint unit = 0;
+        const texture_2d *texture = nullptr; // nullptr unbinds the unit
+        const sgl::sampler *sampler = nullptr; // nullptr uses the texture's own state
+    };
+
+    // binds a whole material in one go: glBindTextures/glBindSamplers per contiguous unit range
+    // with ARB_multi_bind (GL 4.4), otherwise one bind per changed unit. redundant binds are skipped
+    void bind_textures(std::span<const texture_bind> binds) noexcept;
+
+    // call after binding textures or samplers with raw GL
+    void invalidate_texture_binds() noexcept;
+}
+
+namespace sgl::detail {
+    // keep the bind cache coherent with texture_2d::bind / sampler::bind and object deletion
+
+    void on_texture_bound(gl_uint unit, gl_uint id) noexcept;
+
+    void on_sampler_bound(gl_uint unit, gl_uint id) noexcept;
+
+    void on_texture_deleted(gl_uint id) noexcept;
+
+    void on_sampler_deleted(gl_uint id) noexcept;
+}
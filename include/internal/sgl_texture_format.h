@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "sgl_type.h"
+
+namespace sgl {
+    enum class texture_compaction {
+        none = 0,
+        lossless, // R8/RG8 + swizzle for gray images, drops constant alpha
+        lossy, // also RGB565 for opaque color and RGB5_A1 for 1-bit alpha (linear textures only)
+    };
+
+    struct pixel_analysis {
+        bool opaque = true; // no alpha channel or every alpha is 255
+        bool binary_alpha = true; // every alpha is 0 or 255
+        bool gray = true; // r == g == b for every pixel (3 and 4 channels)
+    };
+
+    struct texture_format_choice {
+        gl_int source_channels = 0;
+        gl_int channels = 0; // per pixel after repack_pixels()
+        gl_enum internal_format = 0; // 0 = the default for channels
+        std::array<gl_enum, 4> swizzle{0x1903u, 0x1904u, 0x1905u, 0x1906u}; // GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA
+
+        [[nodiscard]] bool is_identity() const noexcept {
+            return internal_format == 0 && channels == source_channels;
+        }
+    };
+
+    // single pass over the pixels, any thread
+    pixel_analysis analyze_pixels(const std::uint8_t *data, gl_int width, gl_int height, gl_int channels) noexcept;
+
+    // normal_map: keep x/y only (RG8), z has to be rebuilt in the shader as sqrt(1 - x^2 - y^2)
+    texture_format_choice choose_texture_format(
+        const pixel_analysis &analysis, gl_int channels, bool srgb, texture_compaction compaction, bool normal_map
+    ) noexcept;
+
+    // drops the channels the choice does not keep, empty when nothing changes
+    std::vector<std::uint8_t> repack_pixels(
+        const std::uint8_t *data, gl_int width, gl_int height, const texture_format_choice &choice
+    ) noexcept;
+
+    // estimate with all levels, 3-byte formats counted as 4 since drivers pad them
+    gl_sizeiptr texture_vram_bytes(gl_enum internal_format, gl_int width, gl_int height, gl_int levels) noexcept;
+
+    const char *internal_format_name(gl_enum internal_format) noexcept;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+
+#include "sgl_expected.h"
+#include "sgl_type.h"
+#include "sgl_texture.h"
+
+namespace sgl {
+    struct texture_streamer_params {
+        gl_sizeiptr frame_budget_bytes = 8 * 1024 * 1024; // shared by all streamed textures
+    };
+
+    // uploads mip chains coarsest level first and raises GL_TEXTURE_BASE_LEVEL as finer levels arrive,
+    // so big textures are visible on the first frame. one instance per GL context
+    class texture_streamer {
+    public:
+        using handle = std::size_t;
+        using error = texture_error;
+
+        // fabrics
+
+        static texture_streamer create(const texture_streamer_params &params = {}) noexcept;
+
+        // api
+
+        // takes the cpu mips (e.g. from texture_2d::load_async), nothing is uploaded until update()
+        expected<handle, error> add(texture_2d_data data) noexcept;
+
+        // wanted on-screen size in texels (see camera::projected_size). default: full resolution
+        void request_resolution(handle h, float texels) noexcept;
+
+        // call once per frame on the GL thread
+        void update() noexcept;
+
+        [[nodiscard]] const texture_2d &texture(handle h) const noexcept;
+
+        // finest level uploaded so far, levels() when nothing is resident yet
+        [[nodiscard]] gl_int resident_level(handle h) const noexcept;
+
+        [[nodiscard]] bool is_complete(handle h) const noexcept { return resident_level(h) == 0; }
+
+        void set_frame_budget(gl_sizeiptr bytes) noexcept { m_params.frame_budget_bytes = bytes; }
+
+        [[nodiscard]] gl_sizeiptr frame_budget() const noexcept { return m_params.frame_budget_bytes; }
+
+        [[nodiscard]] gl_sizeiptr uploaded_last_frame() const noexcept { return m_uploaded_last_frame; }
+
+        [[nodiscard]] gl_sizeiptr pending_bytes() const noexcept { return m_pending_bytes; }
+
+    private:
+        struct entry {
+            texture_2d tex;
+            mip_chain mips;
+            gl_int resident = 0;
+            gl_int wanted = 0;
+        };
+
+        explicit texture_streamer(const texture_streamer_params &params) noexcept : m_params{params} {
+        }
+
+        [[nodiscard]] entry *pick_next() noexcept;
+
+        texture_streamer_params m_params;
+        std::deque<entry> m_entries; // stable addresses for texture()
+        gl_sizeiptr m_uploaded_last_frame = 0;
+        gl_sizeiptr m_pending_bytes = 0;
+    };
+}
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <utility>
 
 #include "sgl_expected.h"
 #include "sgl_config.h"
+#include "sgl_frame_stats.h"
 
 // forward decl
 struct GLFWwindow;
@@ -24,7 +26,8 @@ namespace sgl {
         const char *title;
         int min_gl_ver_major = default_min_gl_ver_major, min_gl_ver_minor = default_min_gl_ver_minor;
         int fps = 60;
-        bool show_fps = true;
+        bool show_fps = true; // fps, p99 frame time and stutters in the title
+        double title_interval_sec = 0.5; // title refresh rate limit
         bool vsync = true;
         bool cursor_enabled = true;
         bool fullscreen = false; // borderless fullscreen
@@ -67,8 +70,13 @@ namespace sgl {
 
         [[nodiscard]] bool should_close() const noexcept;
 
+        // also records the frame time (swap to swap)
         void swap_buffers() const noexcept;
 
+        [[nodiscard]] frame_time_stats frame_stats() const noexcept;
+
+        [[nodiscard]] const frame_time_tracker &frame_times() const noexcept;
+
         [[nodiscard]] int width() const noexcept;
 
         [[nodiscard]] int height() const noexcept;
@@ -107,18 +115,20 @@ namespace sgl {
         static int s_window_count;
 
     private:
-        struct fps_state {
-            bool enabled = false;
-            double last_time = 0.0;
-            int frames = 0;
-            double interval_sec = 1.0;
-            double cur_fps = 0.0;
+        struct frame_state {
+            // behind a pointer: the tracker is large and not movable
+            std::unique_ptr<frame_time_tracker> times = std::make_unique<frame_time_tracker>();
+            double last_swap = -1.0;
+            bool show_fps = false;
+            double title_interval_sec = 0.5;
+            double last_title_time = 0.0;
             std::string base_title;
+            std::string title; // currently set
         };
 
-        mutable fps_state m_fps_state;
+        mutable frame_state m_frame_state;
 
-        void count_fps() const noexcept;
+        void update_title() const noexcept;
 
     private:
         explicit window(GLFWwindow *handle) noexcept : m_window{handle} {
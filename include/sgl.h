@@ -6,6 +6,7 @@
 #include "internal/sgl_util.h"
 #include "internal/sgl_render.h"
 #include "internal/sgl_log.h"
+#include "internal/sgl_log_deferred.h"
 #include "internal/sgl_shader.h"
 #include "internal/sgl_expected.h"
 #include "internal/sgl_type.h"
@@ -15,8 +16,33 @@
 #include "internal/sgl_vertex_array.h"
 #include "internal/sgl_math.h"
 #include "internal/sgl_texture.h"
+#include "internal/sgl_mipmap.h"
+#include "internal/sgl_pixel_convert.h"
+#include "internal/sgl_texture_format.h"
+#include "internal/sgl_texture_streamer.h"
+#include "internal/sgl_dynamic_texture.h"
+#include "internal/sgl_sampler.h"
+#include "internal/sgl_texture_bind.h"
+#include "internal/sgl_framebuffer.h"
+#include "internal/sgl_readback.h"
+#include "internal/sgl_gpu_profiler.h"
+#include "internal/sgl_profiler.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_frame_stats.h"
+#include "internal/sgl_flight_recorder.h"
+#include "internal/sgl_gl_trace.h"
+#include "internal/sgl_png.h"
 #include "internal/sgl_time.h"
 #include "internal/sgl_file.h"
+#include "internal/sgl_mapped_file.h"
+#include "internal/sgl_async_reader.h"
+#include "internal/sgl_hash.h"
+#include "internal/sgl_embed.h"
+#include "internal/sgl_lz4.h"
+#include "internal/sgl_pack.h"
+#include "internal/sgl_shader_include.h"
+#include "internal/sgl_asset_watcher.h"
+#include "internal/sgl_qoi.h"
 #include "internal/sgl_key.h"
 #include "internal/sgl_input.h"
 #include "internal/sgl_camera.h"
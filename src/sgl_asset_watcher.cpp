@@ -0,0 +1,327 @@
+#include "internal/sgl_asset_watcher.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "internal/sgl_log.h"
+#include "internal/sgl_shader_include.h"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    // events land on the directory: editors that save by writing a temp file and renaming it over the
+    // original would orphan a watch on the file itself. no IN_CREATE: a new file is still empty or half written
+    // then, its IN_CLOSE_WRITE follows
+    constexpr std::uint32_t watch_mask = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+    std::string absolute_path(const std::string &path) {
+        std::error_code ec;
+        const fs::path p = fs::weakly_canonical(fs::absolute(path, ec), ec);
+        return ec ? fs::absolute(path).lexically_normal().string() : p.string();
+    }
+}
+
+namespace sgl {
+    struct asset_watcher::state {
+        struct entry {
+            const void *target = nullptr;
+            shader *shader_target = nullptr;
+            texture_2d *texture_target = nullptr;
+            std::string vertex_path; // or the texture path
+            std::string fragment_path;
+            texture_2d_params params;
+            std::vector<std::string> files; // absolute, everything the object is built from
+        };
+
+        int inotify_fd = -1;
+        int wake_fd = -1;
+
+        std::mutex mutex; // changed and dirs, shared with the thread
+        std::unordered_set<std::string> changed;
+        std::unordered_map<int, std::string> dirs; // watch descriptor -> directory
+
+        std::vector<entry> entries; // GL thread only
+        std::unordered_set<std::string> watched_dirs;
+
+        std::jthread thread;
+
+        ~state() {
+            if (thread.joinable()) {
+                thread.request_stop();
+                const std::uint64_t one = 1;
+                [[maybe_unused]] const auto n = ::write(wake_fd, &one, sizeof(one));
+                thread.join();
+            }
+            if (inotify_fd >= 0) {
+                ::close(inotify_fd);
+            }
+            if (wake_fd >= 0) {
+                ::close(wake_fd);
+            }
+        }
+
+        void run(const std::stop_token &st) noexcept {
+            alignas(inotify_event) std::array<char, 4096> buf{};
+            std::array<pollfd, 2> fds{pollfd{inotify_fd, POLLIN, 0}, pollfd{wake_fd, POLLIN, 0}};
+
+            while (!st.stop_requested()) {
+                if (::poll(fds.data(), fds.size(), -1) < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    log_error(log_subsystem::assets, "asset_watcher: poll() failed, errno {}", errno);
+                    return;
+                }
+                if (fds[1].revents & POLLIN) {
+                    return;
+                }
+
+                const ssize_t n = ::read(inotify_fd, buf.data(), buf.size());
+                if (n <= 0) {
+                    continue;
+                }
+
+                std::lock_guard lock{mutex};
+                for (ssize_t off = 0; off < n;) {
+                    const auto *ev = reinterpret_cast<const inotify_event *>(buf.data() + off);
+                    off += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+
+                    const auto dir = dirs.find(ev->wd);
+                    if (ev->len > 0 && dir != dirs.end()) {
+                        changed.insert(dir->second + "/" + ev->name);
+                    }
+                }
+            }
+        }
+
+        void watch_dirs_of(const std::vector<std::string> &files) noexcept {
+            for (const auto &file: files) {
+                const std::string dir = fs::path{file}.parent_path().string();
+                if (!watched_dirs.insert(dir).second) {
+                    continue;
+                }
+
+                const int wd = ::inotify_add_watch(inotify_fd, dir.c_str(), watch_mask);
+                if (wd < 0) {
+                    log_warn(log_subsystem::assets, "asset_watcher: cannot watch '{}', errno {}", dir, errno);
+                    watched_dirs.erase(dir);
+                    continue;
+                }
+
+                std::lock_guard lock{mutex};
+                dirs[wd] = dir;
+            }
+        }
+
+        // the shader files plus their includes. the two paths alone when expansion fails
+        static std::vector<std::string> shader_files(const entry &e, shader_source &vs, shader_source &fs_src,
+                                                     bool &expanded) noexcept {
+            std::string err;
+            expanded = expand_shader_includes(e.vertex_path.c_str(), vs, err) &&
+                       expand_shader_includes(e.fragment_path.c_str(), fs_src, err);
+            if (!expanded) {
+                log_error(log_subsystem::assets, "asset_watcher: {}", err);
+                return {absolute_path(e.vertex_path), absolute_path(e.fragment_path)};
+            }
+
+            std::vector<std::string> files;
+            for (const auto *list: {&vs.files, &fs_src.files}) {
+                for (const auto &f: *list) {
+                    files.push_back(absolute_path(f));
+                }
+            }
+            std::sort(files.begin(), files.end());
+            files.erase(std::unique(files.begin(), files.end()), files.end());
+            return files;
+        }
+
+        bool reload(entry &e) noexcept {
+            if (e.texture_target) {
+                auto res = texture_2d::create_from_file(e.vertex_path.c_str(), e.params);
+                if (!res) {
+                    log_error(log_subsystem::assets, "asset_watcher: keeping the old '{}'", e.vertex_path);
+                    return false;
+                }
+                *e.texture_target = std::move(*res);
+                log_info(log_subsystem::assets, "asset_watcher: reloaded texture '{}'", e.vertex_path);
+                return true;
+            }
+
+            shader_source vs, fs_src;
+            bool expanded = false;
+            e.files = shader_files(e, vs, fs_src, expanded);
+            watch_dirs_of(e.files);
+            if (!expanded) {
+                return false;
+            }
+
+            auto res = shader::create_from_source(std::string_view{vs.text}, std::string_view{fs_src.text});
+            if (!res) {
+                log_error(log_subsystem::assets, "asset_watcher: keeping the old shader '{}' / '{}'",
+                          e.vertex_path, e.fragment_path);
+                return false;
+            }
+            *e.shader_target = std::move(*res);
+            log_info(log_subsystem::assets, "asset_watcher: reloaded shader '{}' / '{}'",
+                     e.vertex_path, e.fragment_path);
+            return true;
+        }
+    };
+
+    // ctors and assignments
+
+    asset_watcher::asset_watcher(std::unique_ptr<state> s) noexcept : m_state{std::move(s)} {
+    }
+
+    asset_watcher::asset_watcher(asset_watcher &&other) noexcept : m_state{std::move(other.m_state)} {
+    }
+
+    asset_watcher &asset_watcher::operator=(asset_watcher &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        destroy();
+
+        m_state = std::move(other.m_state);
+
+        return *this;
+    }
+
+    asset_watcher::~asset_watcher() {
+        destroy();
+    }
+
+    // fabrics
+
+    asset_watcher::result asset_watcher::create() noexcept {
+        auto s = std::make_unique<state>();
+
+        s->inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (s->inotify_fd < 0) {
+            log_error(log_subsystem::assets, "asset_watcher: inotify_init1() failed, errno {}", errno);
+            return unexpected{error::inotify_failed};
+        }
+
+        s->wake_fd = ::eventfd(0, EFD_CLOEXEC);
+        if (s->wake_fd < 0) {
+            log_error(log_subsystem::assets, "asset_watcher: eventfd() failed, errno {}", errno);
+            return unexpected{error::inotify_failed};
+        }
+
+        s->thread = std::jthread{[p = s.get()](std::stop_token st) { p->run(st); }};
+
+        return asset_watcher{std::move(s)};
+    }
+
+    // try wrappers
+
+    asset_watcher asset_watcher::create_try() noexcept {
+        auto res = create();
+        if (!res) {
+            log_fatal("failed to create asset_watcher: {}", err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
+    // api
+
+    bool asset_watcher::watch(shader &target, std::string vertex_path, std::string fragment_path) noexcept {
+        if (!m_state || vertex_path.empty() || fragment_path.empty()) {
+            return false;
+        }
+
+        unwatch_object(&target);
+
+        state::entry e;
+        e.target = &target;
+        e.shader_target = &target;
+        e.vertex_path = std::move(vertex_path);
+        e.fragment_path = std::move(fragment_path);
+
+        shader_source vs, fs_src;
+        bool expanded = false;
+        e.files = state::shader_files(e, vs, fs_src, expanded);
+        m_state->watch_dirs_of(e.files);
+
+        m_state->entries.push_back(std::move(e));
+        return true;
+    }
+
+    bool asset_watcher::watch(texture_2d &target, std::string path, const texture_2d_params &params) noexcept {
+        if (!m_state || path.empty()) {
+            return false;
+        }
+
+        unwatch_object(&target);
+
+        state::entry e;
+        e.target = &target;
+        e.texture_target = &target;
+        e.files = {absolute_path(path)};
+        e.vertex_path = std::move(path);
+        e.params = params;
+        m_state->watch_dirs_of(e.files);
+
+        m_state->entries.push_back(std::move(e));
+        return true;
+    }
+
+    std::size_t asset_watcher::update() noexcept {
+        if (!m_state) {
+            return 0;
+        }
+
+        std::unordered_set<std::string> changed;
+        {
+            std::lock_guard lock{m_state->mutex};
+            if (m_state->changed.empty()) {
+                return 0;
+            }
+            changed.swap(m_state->changed);
+        }
+
+        std::size_t reloaded = 0;
+        for (auto &e: m_state->entries) {
+            const bool affected = std::any_of(e.files.begin(), e.files.end(), [&](const std::string &f) {
+                return changed.contains(f);
+            });
+            if (affected && m_state->reload(e)) {
+                ++reloaded;
+            }
+        }
+        return reloaded;
+    }
+
+    // internal
+
+    void asset_watcher::unwatch_object(const void *target) noexcept {
+        if (!m_state) {
+            return;
+        }
+
+        auto &entries = m_state->entries;
+        entries.erase(
+            std::remove_if(entries.begin(), entries.end(), [target](const auto &e) { return e.target == target; }),
+            entries.end()
+        );
+    }
+
+    void asset_watcher::destroy() noexcept {
+        // stops and joins the thread, closes the descriptors
+        m_state.reset();
+    }
+}
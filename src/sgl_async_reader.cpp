@@ -0,0 +1,707 @@
+#include "internal/sgl_async_reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define SGL_HAS_IO_URING 1
+#else
+#define SGL_HAS_IO_URING 0
+#endif
+
+#include "internal/sgl_job.h"
+#include "internal/sgl_log.h"
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    double ms_since(clock::time_point start) noexcept {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    }
+
+    struct request {
+        std::string path;
+        sgl::async_reader::read_callback on_done;
+        clock::time_point queued;
+    };
+
+    void deliver(request &req, sgl::file_read &&file) noexcept {
+        file.path = std::move(req.path);
+        file.io_ms = ms_since(req.queued);
+        sgl::detail::submit_job(
+            [cb = std::move(req.on_done), f = std::move(file)]() mutable { cb(std::move(f)); }
+        );
+    }
+
+    sgl::file_read failed_read(int error) noexcept {
+        sgl::file_read file;
+        file.error = error;
+        return file;
+    }
+
+    // open + size. false with errno set
+    bool open_sized(const char *path, int &fd, std::size_t &size) noexcept {
+        fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            const int e = errno;
+            ::close(fd);
+            errno = e;
+            return false;
+        }
+        size = static_cast<std::size_t>(st.st_size);
+        return true;
+    }
+
+    sgl::file_read pread_file(const char *path) noexcept {
+        sgl::file_read file;
+
+        int fd = -1;
+        std::size_t size = 0;
+        if (!open_sized(path, fd, size)) {
+            file.error = errno;
+            return file;
+        }
+
+        file.bytes.resize(size);
+        std::size_t done = 0;
+        while (done < size) {
+            const ssize_t n = ::pread(fd, file.bytes.data() + done, size - done, static_cast<off_t>(done));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                file.error = errno;
+                break;
+            }
+            if (n == 0) {
+                break; // shrank under us
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        file.bytes.resize(done);
+
+        ::close(fd);
+        return file;
+    }
+
+    // fallback backend: the worker that reads also runs the callback
+    void submit_pread_job(request &&req) noexcept {
+        sgl::detail::submit_job([req = std::move(req)]() mutable {
+            sgl::file_read file = pread_file(req.path.c_str());
+            file.path = std::move(req.path);
+            file.io_ms = ms_since(req.queued);
+            req.on_done(std::move(file));
+        });
+    }
+}
+
+namespace sgl {
+#if SGL_HAS_IO_URING
+    namespace {
+        // the three shared mappings of an io_uring instance, driven with raw syscalls (no liburing)
+        class uring {
+        public:
+            uring() = default;
+
+            uring(const uring &) = delete;
+
+            uring &operator=(const uring &) = delete;
+
+            ~uring() {
+                destroy();
+            }
+
+            bool init(unsigned entries) noexcept {
+                io_uring_params p{};
+                m_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+                if (m_fd < 0) {
+                    return false;
+                }
+
+                m_sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+                m_cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+                const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single) {
+                    m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+                }
+
+                m_sq = ::mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                              IORING_OFF_SQ_RING);
+                if (m_sq == MAP_FAILED) {
+                    m_sq = nullptr;
+                    destroy();
+                    return false;
+                }
+
+                if (single) {
+                    m_cq = m_sq;
+                } else {
+                    m_cq = ::mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                                  IORING_OFF_CQ_RING);
+                    if (m_cq == MAP_FAILED) {
+                        m_cq = nullptr;
+                        destroy();
+                        return false;
+                    }
+                }
+
+                m_sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+                void *sqes = ::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                                    IORING_OFF_SQES);
+                if (sqes == MAP_FAILED) {
+                    destroy();
+                    return false;
+                }
+                m_sqes = static_cast<io_uring_sqe *>(sqes);
+
+                auto *sq = static_cast<std::uint8_t *>(m_sq);
+                m_sq_head = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+                m_sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+                m_sq_mask = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+                m_sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+                m_sq_entries = p.sq_entries;
+
+                auto *cq = static_cast<std::uint8_t *>(m_cq);
+                m_cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+                m_cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+                m_cq_mask = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+                m_cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+
+                return true;
+            }
+
+            [[nodiscard]] unsigned entries() const noexcept { return m_sq_entries; }
+
+            // caller keeps in-flight <= entries(), so the sq never fills and the cq (2x) never overflows
+            void push_readv(int fd, const iovec *iov, std::uint64_t offset, std::uint64_t user_data) noexcept {
+                const unsigned tail = *m_sq_tail;
+                const unsigned idx = tail & m_sq_mask;
+
+                io_uring_sqe &sqe = m_sqes[idx];
+                sqe = {};
+                sqe.opcode = IORING_OP_READV;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(iov);
+                sqe.len = 1;
+                sqe.off = offset;
+                sqe.user_data = user_data;
+
+                m_sq_array[idx] = idx;
+                __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+                ++m_to_submit;
+            }
+
+            // submits everything pushed, optionally blocks for one completion
+            bool enter(bool wait) noexcept {
+                while (true) {
+                    const long r = ::syscall(
+                        __NR_io_uring_enter, m_fd, m_to_submit, wait ? 1u : 0u,
+                        wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0
+                    );
+                    if (r >= 0) {
+                        m_to_submit -= static_cast<unsigned>(r);
+                        return true;
+                    }
+                    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                        return false;
+                    }
+                    if (errno != EINTR) {
+                        return true; // completions pending, reap and retry
+                    }
+                }
+            }
+
+            template<typename F>
+            void reap(F &&on_cqe) noexcept {
+                unsigned head = *m_cq_head;
+                const unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+                while (head != tail) {
+                    const io_uring_cqe &cqe = m_cqes[head & m_cq_mask];
+                    on_cqe(cqe.user_data, cqe.res);
+                    ++head;
+                }
+                __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+            }
+
+            // unmaps and closes the ring, the kernel cancels what it still has
+            void shutdown() noexcept {
+                destroy();
+            }
+
+        private:
+            void destroy() noexcept {
+                if (m_sqes) {
+                    ::munmap(m_sqes, m_sqes_size);
+                }
+                if (m_cq && m_cq != m_sq) {
+                    ::munmap(m_cq, m_cq_size);
+                }
+                if (m_sq) {
+                    ::munmap(m_sq, m_sq_size);
+                }
+                if (m_fd >= 0) {
+                    ::close(m_fd);
+                }
+                m_sqes = nullptr;
+                m_sq = m_cq = nullptr;
+                m_fd = -1;
+            }
+
+            int m_fd = -1;
+
+            void *m_sq = nullptr;
+            void *m_cq = nullptr;
+            std::size_t m_sq_size = 0;
+            std::size_t m_cq_size = 0;
+            std::size_t m_sqes_size = 0;
+
+            unsigned *m_sq_head = nullptr;
+            unsigned *m_sq_tail = nullptr;
+            unsigned *m_sq_array = nullptr;
+            unsigned m_sq_mask = 0;
+            unsigned m_sq_entries = 0;
+            io_uring_sqe *m_sqes = nullptr;
+            unsigned m_to_submit = 0;
+
+            unsigned *m_cq_head = nullptr;
+            unsigned *m_cq_tail = nullptr;
+            unsigned m_cq_mask = 0;
+            io_uring_cqe *m_cqes = nullptr;
+        };
+    }
+
+    struct async_reader::ring_state {
+        struct slot {
+            request req;
+            file_read file;
+            int fd = -1;
+            std::size_t offset = 0;
+            iovec iov{};
+        };
+
+        uring ring;
+        std::vector<slot> slots;
+        std::vector<std::size_t> free_slots;
+
+        std::mutex mutex;
+        std::condition_variable_any cv;
+        std::deque<request> queue;
+        std::atomic<bool> failed{false}; // set under mutex: the ring is gone, reads take the thread pool
+
+        std::jthread thread; // last: joined before the rest is torn down
+
+        void start() noexcept {
+            slots.resize(ring.entries());
+            for (std::size_t i = slots.size(); i-- > 0;) {
+                free_slots.push_back(i);
+            }
+            thread = std::jthread{[this](std::stop_token st) { run(st); }};
+        }
+
+        void run(const std::stop_token &st) noexcept {
+            std::vector<request> incoming;
+
+            while (true) {
+                const bool busy = free_slots.size() != slots.size();
+                {
+                    std::unique_lock lock{mutex};
+                    if (!busy) {
+                        cv.wait(lock, st, [this] { return !queue.empty(); });
+                    }
+                    if (st.stop_requested()) {
+                        for (auto &req: queue) {
+                            deliver(req, failed_read(ECANCELED));
+                        }
+                        queue.clear();
+                        if (!busy) {
+                            return;
+                        }
+                    }
+                    while (!queue.empty() && incoming.size() < free_slots.size()) {
+                        incoming.push_back(std::move(queue.front()));
+                        queue.pop_front();
+                    }
+                }
+
+                for (auto &req: incoming) {
+                    start_read(std::move(req));
+                }
+                incoming.clear();
+
+                const bool waiting = free_slots.size() != slots.size();
+                if (!ring.enter(waiting)) {
+                    fail(errno);
+                    return;
+                }
+                ring.reap([this](std::uint64_t user_data, std::int32_t res) { complete(user_data, res); });
+            }
+        }
+
+        // a hard io_uring_enter() error won't go away by retrying: what is in flight fails with it, queued and
+        // later requests go to the thread pool
+        void fail(int err) noexcept {
+            log_error(log_subsystem::assets, "async_reader: io_uring_enter() failed, errno {}, using the thread pool",
+                      err);
+            ring.shutdown();
+
+            for (auto &s: slots) {
+                if (s.fd < 0) {
+                    continue;
+                }
+                ::close(s.fd);
+                s.fd = -1;
+                deliver(s.req, failed_read(err));
+            }
+
+            std::deque<request> rest;
+            {
+                std::lock_guard lock{mutex};
+                failed.store(true, std::memory_order_relaxed);
+                rest.swap(queue);
+            }
+            for (auto &req: rest) {
+                submit_pread_job(std::move(req));
+            }
+        }
+
+        void start_read(request &&req) noexcept {
+            int fd = -1;
+            std::size_t size = 0;
+            if (!open_sized(req.path.c_str(), fd, size)) {
+                deliver(req, failed_read(errno));
+                return;
+            }
+            if (size == 0) {
+                ::close(fd);
+                deliver(req, file_read{});
+                return;
+            }
+
+            const std::size_t index = free_slots.back();
+            free_slots.pop_back();
+
+            slot &s = slots[index];
+            s.req = std::move(req);
+            s.file = {};
+            s.file.bytes.resize(size);
+            s.fd = fd;
+            s.offset = 0;
+            submit(index);
+        }
+
+        void submit(std::size_t index) noexcept {
+            slot &s = slots[index];
+            s.iov.iov_base = s.file.bytes.data() + s.offset;
+            s.iov.iov_len = s.file.bytes.size() - s.offset;
+            ring.push_readv(s.fd, &s.iov, s.offset, index);
+        }
+
+        void complete(std::uint64_t index, std::int32_t res) noexcept {
+            slot &s = slots[index];
+
+            if (res == -EINTR || res == -EAGAIN) {
+                submit(index);
+                return;
+            }
+
+            if (res < 0) {
+                s.file.error = -res;
+            } else {
+                s.offset += static_cast<std::size_t>(res);
+                // short read: queue the rest, picked up by the next enter()
+                if (res > 0 && s.offset < s.file.bytes.size()) {
+                    submit(index);
+                    return;
+                }
+                s.file.bytes.resize(s.offset);
+            }
+
+            ::close(s.fd);
+            s.fd = -1;
+            deliver(s.req, std::move(s.file));
+            free_slots.push_back(index);
+        }
+    };
+#else
+    struct async_reader::ring_state {
+    };
+#endif
+
+    // ctors and assignments
+
+    async_reader::async_reader(std::unique_ptr<ring_state> ring) noexcept : m_ring{std::move(ring)} {
+    }
+
+    async_reader::async_reader(async_reader &&other) noexcept : m_ring{std::move(other.m_ring)} {
+    }
+
+    async_reader &async_reader::operator=(async_reader &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        destroy();
+
+        m_ring = std::move(other.m_ring);
+
+        return *this;
+    }
+
+    async_reader::~async_reader() {
+        destroy();
+    }
+
+    // fabrics
+
+    async_reader async_reader::create(const async_reader_params &params) noexcept {
+#if SGL_HAS_IO_URING
+        if (!params.force_thread_pool && params.queue_depth > 0) {
+            auto ring = std::make_unique<ring_state>();
+            if (ring->ring.init(params.queue_depth)) {
+                ring->start();
+                log_info(log_subsystem::assets, "async_reader: io_uring, {} reads in flight", ring->ring.entries());
+                return async_reader{std::move(ring)};
+            }
+            log_warn(log_subsystem::assets, "async_reader: io_uring_setup() failed (errno {}), using the thread pool",
+                     errno);
+        }
+#else
+        (void) params;
+#endif
+        return async_reader{nullptr};
+    }
+
+    // api
+
+    void async_reader::read(std::string path, read_callback on_done) noexcept {
+        if (!on_done) {
+            return;
+        }
+
+        request req{.path = std::move(path), .on_done = std::move(on_done), .queued = clock::now()};
+
+        if (m_ring) {
+            std::lock_guard lock{m_ring->mutex};
+            if (!m_ring->failed.load(std::memory_order_relaxed)) {
+                m_ring->queue.push_back(std::move(req));
+                m_ring->cv.notify_one();
+                return;
+            }
+        }
+
+        submit_pread_job(std::move(req));
+    }
+
+    void async_reader::read_batch(std::span<const std::string> paths, const read_callback &on_done) noexcept {
+        if (!on_done || paths.empty()) {
+            return;
+        }
+
+        const auto now = clock::now();
+
+        if (m_ring) {
+            std::lock_guard lock{m_ring->mutex};
+            if (!m_ring->failed.load(std::memory_order_relaxed)) {
+                for (const auto &path: paths) {
+                    m_ring->queue.push_back(request{.path = path, .on_done = on_done, .queued = now});
+                }
+                m_ring->cv.notify_one();
+                return;
+            }
+        }
+
+        for (const auto &path: paths) {
+            submit_pread_job(request{.path = path, .on_done = on_done, .queued = now});
+        }
+    }
+
+    async_reader_backend async_reader::backend() const noexcept {
+        return m_ring && !m_ring->failed.load(std::memory_order_relaxed) ? async_reader_backend::io_uring
+                                                                          : async_reader_backend::thread_pool;
+    }
+
+    // internal
+
+    void async_reader::destroy() noexcept {
+        // jthread stop + join, the loop drains what the kernel still owns
+        m_ring.reset();
+    }
+}
+
+namespace sgl {
+    struct asset_pipeline::shared_state {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<upload_fn> ready;
+
+        std::size_t added = 0;
+        std::size_t done = 0; // uploaded, or decode returned no GL step
+        asset_pipeline_stats stats;
+        clock::time_point first_submit;
+    };
+
+    asset_pipeline::asset_pipeline(async_reader reader, std::shared_ptr<shared_state> state) noexcept
+        : m_state{std::move(state)}, m_reader{std::move(reader)} {
+    }
+
+    // fabrics
+
+    asset_pipeline asset_pipeline::create(const async_reader_params &params) noexcept {
+        return asset_pipeline{async_reader::create(params), std::make_shared<shared_state>()};
+    }
+
+    // api
+
+    void asset_pipeline::add(std::string path, decode_fn decode) noexcept {
+        if (!decode) {
+            return;
+        }
+
+        {
+            std::lock_guard lock{m_state->mutex};
+            // an idle pipeline starts a new round of stats
+            if (m_state->added == m_state->done) {
+                m_state->stats = {};
+                m_state->first_submit = clock::now();
+            }
+            ++m_state->added;
+        }
+
+        m_reader.read(std::move(path), make_callback(std::move(decode)));
+    }
+
+    void asset_pipeline::add(std::span<const std::string> paths, const decode_fn &decode) noexcept {
+        if (!decode || paths.empty()) {
+            return;
+        }
+
+        {
+            std::lock_guard lock{m_state->mutex};
+            if (m_state->added == m_state->done) {
+                m_state->stats = {};
+                m_state->first_submit = clock::now();
+            }
+            m_state->added += paths.size();
+        }
+
+        m_reader.read_batch(paths, make_callback(decode));
+    }
+
+    std::size_t asset_pipeline::pump(double budget_ms) noexcept {
+        const auto start = clock::now();
+        std::size_t count = 0;
+
+        while (true) {
+            upload_fn upload;
+            {
+                std::lock_guard lock{m_state->mutex};
+                if (m_state->ready.empty()) {
+                    break;
+                }
+                upload = std::move(m_state->ready.front());
+                m_state->ready.pop_front();
+            }
+
+            const auto t0 = clock::now();
+            upload();
+            const double ms = ms_since(t0);
+
+            {
+                std::lock_guard lock{m_state->mutex};
+                m_state->stats.upload_ms += ms;
+                m_state->stats.wall_ms = ms_since(m_state->first_submit);
+                ++m_state->done;
+            }
+            ++count;
+
+            if (budget_ms > 0.0 && ms_since(start) >= budget_ms) {
+                break;
+            }
+        }
+
+        return count;
+    }
+
+    void asset_pipeline::finish() noexcept {
+        while (true) {
+            pump();
+
+            std::unique_lock lock{m_state->mutex};
+            if (m_state->done == m_state->added) {
+                break;
+            }
+            m_state->cv.wait(lock, [this] {
+                return !m_state->ready.empty() || m_state->done == m_state->added;
+            });
+        }
+
+        const auto s = stats();
+        log_info(
+            log_subsystem::assets,
+            "asset_pipeline: {} files ({} failed, {:.1f} MiB) via {}: io {:.1f} ms, decode {:.1f} ms (workers), "
+            "upload {:.1f} ms, wall {:.1f} ms",
+            s.files, s.failed, static_cast<double>(s.bytes) / (1024.0 * 1024.0),
+            async_reader::backend_name(backend()), s.io_ms, s.decode_ms, s.upload_ms, s.wall_ms
+        );
+    }
+
+    std::size_t asset_pipeline::pending() const noexcept {
+        std::lock_guard lock{m_state->mutex};
+        return m_state->added - m_state->done;
+    }
+
+    asset_pipeline_stats asset_pipeline::stats() const noexcept {
+        std::lock_guard lock{m_state->mutex};
+        return m_state->stats;
+    }
+
+    // internal
+
+    async_reader::read_callback asset_pipeline::make_callback(decode_fn decode) const noexcept {
+        return [state = m_state, decode = std::move(decode)](file_read &&file) {
+            {
+                std::lock_guard lock{state->mutex};
+                auto &s = state->stats;
+                ++s.files;
+                s.failed += file.ok() ? 0 : 1;
+                s.bytes += file.bytes.size();
+                s.io_ms = std::max(s.io_ms, ms_since(state->first_submit));
+            }
+
+            const auto t0 = clock::now();
+            upload_fn upload = decode(file);
+            const double ms = ms_since(t0);
+
+            {
+                std::lock_guard lock{state->mutex};
+                state->stats.decode_ms += ms;
+                if (upload) {
+                    state->ready.push_back(std::move(upload));
+                } else {
+                    ++state->done;
+                    state->stats.wall_ms = ms_since(state->first_submit);
+                }
+            }
+            state->cv.notify_all();
+        };
+    }
+}
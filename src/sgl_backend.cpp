@@ -4,6 +4,7 @@
 #include "GLFW/glfw3.h"
 
 #include "internal/sgl_log.h"
+#include "internal/sgl_gl_trace.h"
 
 namespace sgl::detail {
     static bool s_glfw_initialized = false;
@@ -36,6 +37,7 @@ namespace sgl::detail {
             log_error("ensure_glad(): gladLoadGLLoader failed.");
             return false;
         }
+        gl_trace::detail::install();
         s_glad_initialized = true;
         return true;
     }
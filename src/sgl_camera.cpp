@@ -63,6 +63,16 @@ namespace sgl {
         return glm::perspective(glm::radians(m_fov), m_aspect, m_z_near, m_z_far);
     }
 
+    float camera::projected_size(const glm::vec3 &center, float radius, int viewport_height) const noexcept {
+        const float dist = glm::length(center - m_pos);
+        if (dist <= radius) {
+            return static_cast<float>(viewport_height); // inside the sphere: fills the view
+        }
+
+        const float half_fov = glm::radians(m_fov) * 0.5f;
+        return static_cast<float>(viewport_height) * radius / (dist * std::tan(half_fov));
+    }
+
     // internals
 
     void camera::update_vecs() noexcept {
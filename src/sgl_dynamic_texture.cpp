@@ -0,0 +1,308 @@
+#include "internal/sgl_dynamic_texture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <cassert>
+
+#include "glad/glad.h"
+
+#include "internal/sgl_log.h"
+#include "internal/sgl_log_deferred.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_pixel_convert.h"
+
+namespace sgl {
+    // ctors and assignments
+
+    dynamic_texture::dynamic_texture(texture_2d texture, const dynamic_texture_params &params) noexcept
+        : m_texture{std::move(texture)},
+          m_channels{params.channels},
+          m_tile_size{params.tile_size},
+          m_tiles_x{(params.width + params.tile_size - 1) / params.tile_size},
+          m_tiles_y{(params.height + params.tile_size - 1) / params.tile_size} {
+        m_dirty.assign(static_cast<std::size_t>(m_tiles_x) * m_tiles_y, 0);
+    }
+
+    dynamic_texture::dynamic_texture(dynamic_texture &&other) noexcept
+        : m_texture{std::move(other.m_texture)},
+          m_channels{other.m_channels},
+          m_tile_size{other.m_tile_size},
+          m_tiles_x{other.m_tiles_x},
+          m_tiles_y{other.m_tiles_y},
+          m_dirty{std::move(other.m_dirty)},
+          m_dirty_count{std::exchange(other.m_dirty_count, 0)},
+          m_rects{std::move(other.m_rects)},
+          m_pbos{std::exchange(other.m_pbos, {})},
+          m_pbo_sizes{std::exchange(other.m_pbo_sizes, {})},
+          m_next_pbo{other.m_next_pbo} {
+    }
+
+    dynamic_texture &dynamic_texture::operator=(dynamic_texture &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        destroy();
+
+        m_texture = std::move(other.m_texture);
+        m_channels = other.m_channels;
+        m_tile_size = other.m_tile_size;
+        m_tiles_x = other.m_tiles_x;
+        m_tiles_y = other.m_tiles_y;
+        m_dirty = std::move(other.m_dirty);
+        m_dirty_count = std::exchange(other.m_dirty_count, 0);
+        m_rects = std::move(other.m_rects);
+        m_pbos = std::exchange(other.m_pbos, {});
+        m_pbo_sizes = std::exchange(other.m_pbo_sizes, {});
+        m_next_pbo = other.m_next_pbo;
+
+        return *this;
+    }
+
+    dynamic_texture::~dynamic_texture() {
+        destroy();
+    }
+
+    // fabrics
+
+    dynamic_texture::result dynamic_texture::create(const dynamic_texture_params &params) noexcept {
+        if (params.width <= 0 || params.height <= 0 || params.tile_size <= 0 ||
+            params.channels < 1 || params.channels > 4) {
+            return unexpected{error::invalid_params};
+        }
+
+        auto tex = texture_2d::create_from_pixels(nullptr, params.width, params.height, params.channels, params.texture);
+        if (!tex) {
+            return unexpected{error::texture_failed};
+        }
+
+        dynamic_texture dt{std::move(*tex), params};
+
+        glGenBuffers(static_cast<GLsizei>(dt.m_pbos.size()), dt.m_pbos.data());
+        if (dt.m_pbos[0] == 0 || dt.m_pbos[1] == 0) {
+            log_error(log_subsystem::texture, "dynamic_texture::create: glGenBuffers() returned 0");
+            return unexpected{error::gl_gen_failed};
+        }
+
+        // the first upload has to fill the whole texture
+        dt.mark_all_dirty();
+
+        return dt;
+    }
+
+    // try wrappers
+
+    dynamic_texture dynamic_texture::create_try(const dynamic_texture_params &params) noexcept {
+        auto res = create(params);
+        if (!res) {
+            log_fatal("failed to create dynamic_texture: {}", err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
+    // api
+
+    void dynamic_texture::mark_dirty(const texture_rect &rect) noexcept {
+        const gl_int x0 = std::max(rect.x, 0);
+        const gl_int y0 = std::max(rect.y, 0);
+        const gl_int x1 = std::min(rect.x + rect.width, m_texture.width());
+        const gl_int y1 = std::min(rect.y + rect.height, m_texture.height());
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+
+        const gl_int tx1 = (x1 - 1) / m_tile_size;
+        const gl_int ty1 = (y1 - 1) / m_tile_size;
+        for (gl_int ty = y0 / m_tile_size; ty <= ty1; ++ty) {
+            for (gl_int tx = x0 / m_tile_size; tx <= tx1; ++tx) {
+                auto &flag = m_dirty[static_cast<std::size_t>(ty) * m_tiles_x + tx];
+                m_dirty_count += flag == 0;
+                flag = 1;
+            }
+        }
+    }
+
+    void dynamic_texture::mark_all_dirty() noexcept {
+        std::fill(m_dirty.begin(), m_dirty.end(), std::uint8_t{1});
+        m_dirty_count = m_dirty.size();
+    }
+
+    gl_sizeiptr dynamic_texture::upload(const void *frame) noexcept {
+        assert(frame);
+
+        coalesce();
+        if (m_rects.empty()) {
+            return 0;
+        }
+
+        // GL_RGB rows get repacked by most drivers on the CPU: 3-channel tiles are staged as 4-byte pixels
+        const gl_int staged = m_channels == 3 ? 4 : m_channels;
+
+        gl_sizeiptr total = 0;
+        for (const auto &r: m_rects) {
+            total += static_cast<gl_sizeiptr>(r.width) * r.height * staged;
+        }
+
+        const std::size_t i = m_next_pbo;
+        m_next_pbo ^= 1;
+
+        GLint prev_pbo = 0;
+        glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &prev_pbo);
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbos[i]);
+
+        // orphan: the driver hands out fresh storage if the GPU still reads the previous contents
+        m_pbo_sizes[i] = std::max(m_pbo_sizes[i], total);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, m_pbo_sizes[i], nullptr, GL_STREAM_DRAW);
+
+        auto *dst = static_cast<std::uint8_t *>(
+            glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)
+        );
+        if (!dst) {
+            log_error(log_subsystem::texture, "dynamic_texture::upload: glMapBufferRange() failed");
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, static_cast<GLuint>(prev_pbo));
+            // retry the same region next time
+            for (const auto &r: m_rects) {
+                mark_dirty(r);
+            }
+            return 0;
+        }
+
+        const auto *src = static_cast<const std::uint8_t *>(frame);
+        const std::size_t src_stride = static_cast<std::size_t>(m_texture.width()) * m_channels;
+
+        std::vector<gl_sizeiptr> offsets(m_rects.size());
+        gl_sizeiptr offset = 0;
+        for (std::size_t k = 0; k < m_rects.size(); ++k) {
+            const auto &r = m_rects[k];
+            const std::size_t row = static_cast<std::size_t>(r.width) * staged;
+
+            offsets[k] = offset;
+            for (gl_int y = 0; y < r.height; ++y) {
+                const std::uint8_t *in =
+                    src + static_cast<std::size_t>(r.y + y) * src_stride + static_cast<std::size_t>(r.x) * m_channels;
+                if (staged != m_channels) {
+                    rgb_to_rgba(in, dst + offset + y * row, static_cast<std::size_t>(r.width));
+                } else {
+                    std::memcpy(dst + offset + y * row, in, row);
+                }
+            }
+            offset += static_cast<gl_sizeiptr>(row) * r.height;
+        }
+
+        if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+            // storage was lost (e.g. mode switch), contents are undefined
+            SGL_DLOG_WARN(log_subsystem::texture,
+                          "dynamic_texture::upload: buffer corrupted during upload, retrying next frame");
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, static_cast<GLuint>(prev_pbo));
+            for (const auto &r: m_rects) {
+                mark_dirty(r);
+            }
+            return 0;
+        }
+
+        // unpack state once for every rect
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        GLint prev_alignment = 0;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_alignment);
+
+        GLint prev_row_length = 0;
+        glGetIntegerv(GL_UNPACK_ROW_LENGTH, &prev_row_length);
+
+        glBindTexture(GL_TEXTURE_2D, m_texture.id());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+        const GLenum format = staged != m_channels ? GL_RGBA : m_texture.format();
+        for (std::size_t k = 0; k < m_rects.size(); ++k) {
+            const auto &r = m_rects[k];
+            glTexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.width, r.height, format, GL_UNSIGNED_BYTE,
+                            reinterpret_cast<const void *>(offsets[k]));
+        }
+        metrics::add(metrics::counter::texture_bytes, static_cast<std::uint64_t>(total));
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, prev_row_length);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, prev_alignment);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(prev_tex));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, static_cast<GLuint>(prev_pbo));
+
+        m_texture.generate_mipmaps();
+
+        return total;
+    }
+
+    // internal
+
+    void dynamic_texture::coalesce() noexcept {
+        m_rects.clear();
+        if (m_dirty_count == 0) {
+            return;
+        }
+
+        const gl_int w = m_texture.width();
+        const gl_int h = m_texture.height();
+
+        // most of the image changed: one big upload beats many small ones
+        if (m_dirty_count * 4 >= m_dirty.size() * 3) {
+            m_rects.push_back({0, 0, w, h});
+            std::fill(m_dirty.begin(), m_dirty.end(), std::uint8_t{0});
+            m_dirty_count = 0;
+            return;
+        }
+
+        // horizontal runs per tile row; a run with the same columns as one in the row above extends it
+        struct run {
+            gl_int tx0, tx1; // [tx0, tx1)
+            std::size_t rect;
+        };
+        std::vector<run> prev, cur;
+
+        for (gl_int ty = 0; ty < m_tiles_y; ++ty) {
+            cur.clear();
+            const std::uint8_t *row = m_dirty.data() + static_cast<std::size_t>(ty) * m_tiles_x;
+
+            for (gl_int tx = 0; tx < m_tiles_x;) {
+                if (!row[tx]) {
+                    ++tx;
+                    continue;
+                }
+                const gl_int tx0 = tx;
+                while (tx < m_tiles_x && row[tx]) {
+                    ++tx;
+                }
+
+                const auto above = std::find_if(prev.begin(), prev.end(), [&](const run &r) {
+                    return r.tx0 == tx0 && r.tx1 == tx;
+                });
+
+                const gl_int y1 = std::min((ty + 1) * m_tile_size, h);
+                if (above != prev.end()) {
+                    auto &rect = m_rects[above->rect];
+                    rect.height = y1 - rect.y;
+                    cur.push_back({tx0, tx, above->rect});
+                } else {
+                    const gl_int x0 = tx0 * m_tile_size;
+                    const gl_int y0 = ty * m_tile_size;
+                    m_rects.push_back({x0, y0, std::min(tx * m_tile_size, w) - x0, y1 - y0});
+                    cur.push_back({tx0, tx, m_rects.size() - 1});
+                }
+            }
+
+            std::swap(prev, cur);
+        }
+
+        std::fill(m_dirty.begin(), m_dirty.end(), std::uint8_t{0});
+        m_dirty_count = 0;
+    }
+
+    void dynamic_texture::destroy() noexcept {
+        if (m_pbos[0] != 0 || m_pbos[1] != 0) {
+            glDeleteBuffers(static_cast<GLsizei>(m_pbos.size()), m_pbos.data());
+            m_pbos = {};
+            m_pbo_sizes = {};
+        }
+    }
+}
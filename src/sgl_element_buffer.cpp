@@ -6,6 +6,9 @@
 #include "glad/glad.h"
 
 #include "internal/sgl_log.h"
+#include "internal/sgl_flight_recorder.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_profiler.h"
 #include "internal/sgl_util.h"
 #include "internal/sgl_type.h"
 
@@ -48,9 +51,12 @@ namespace sgl {
         gl_enum index_type,
         gl_enum usage
     ) noexcept {
+        SGL_ZONE("element_buffer::create");
+
         const gl_sizeiptr idx_size = index_type_size(index_type);
         if (size <= 0 || idx_size == 0 || (size % idx_size) != 0) {
             log_error(
+                log_subsystem::buffer,
                 "element_buffer::create(): invalid params (size={}, type=0x{})",
                 size, static_cast<unsigned int>(index_type)
             );
@@ -60,7 +66,7 @@ namespace sgl {
         gl_uint id = 0;
         glGenBuffers(1, &id);
         if (id == 0) {
-            log_error("glGenBuffers() returned 0");
+            log_error(log_subsystem::buffer, "glGenBuffers() returned 0");
             return unexpected{error::gl_gen_buffers_failed};
         }
 
@@ -69,6 +75,9 @@ namespace sgl {
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage);
+        if (data) {
+            metrics::add(metrics::counter::buffer_bytes, static_cast<std::uint64_t>(size));
+        }
 
 #ifndef NDEBUG
         const bool ok = check_created_size_bound(GL_ELEMENT_ARRAY_BUFFER, size);
@@ -79,13 +88,15 @@ namespace sgl {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, prev_ebo);
 
         if (!ok) {
-            log_error("glBufferData() failed to allocate {} bytes", size);
+            log_error(log_subsystem::buffer, "glBufferData() failed to allocate {} bytes", size);
             glDeleteBuffers(1, &id);
             return unexpected{error::gl_alloc_failed};
         }
 
         const auto count = static_cast<gl_sizei>(size / idx_size);
 
+        flight_recorder::resource_created(flight_recorder::resource_kind::element_buffer, id,
+                                          static_cast<std::uint64_t>(size));
         return element_buffer{id, size, count, index_type, usage};
     }
 
@@ -114,10 +125,12 @@ namespace sgl {
     }
 
     void element_buffer::set_data(const void *data, gl_sizeiptr size) noexcept {
+        SGL_ZONE("element_buffer::set_data");
+
         assert(m_id);
 
         if (size <= 0) {
-            log_error("element_buffer::set_data(): invalid size={}", size);
+            log_error(log_subsystem::buffer, "element_buffer::set_data(): invalid size={}", size);
             return;
         }
 
@@ -130,6 +143,7 @@ namespace sgl {
         const gl_sizeiptr idx_size = index_type_size(m_type);
         if (size <= 0 || idx_size == 0 || (size % idx_size) != 0) {
             log_error(
+                log_subsystem::buffer,
                 "element_buffer::set_data(): invalid size={} for current type=0x{}",
                 size, static_cast<unsigned int>(m_type)
             );
@@ -137,6 +151,9 @@ namespace sgl {
         }
 
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, m_usage);
+        if (data) {
+            metrics::add(metrics::counter::buffer_bytes, static_cast<std::uint64_t>(size));
+        }
 
         m_size = size;
         m_count = static_cast<gl_sizei>(size / idx_size);
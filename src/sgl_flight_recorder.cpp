@@ -0,0 +1,357 @@
+#include "internal/sgl_flight_recorder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "internal/sgl_gpu_profiler.h"
+#include "internal/sgl_job.h"
+#include "internal/sgl_log.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_profiler.h"
+
+namespace sgl::flight_recorder {
+    namespace {
+        constexpr std::size_t max_gpu_events = 32; // per frame, the rest is cut
+        constexpr std::size_t resource_ring_size = 256;
+
+        // chrome trace pids next to the profiler's cpu (1) and gpu (2)
+        constexpr int frames_pid = 3;
+        constexpr int frames_tid = 1;
+        constexpr int resources_tid = 2;
+
+        struct frame_record {
+            std::uint64_t index = 0;
+            std::uint64_t begin_ns = 0;
+            std::uint64_t swap_begin_ns = 0;
+            std::uint64_t end_ns = 0;
+            std::array<std::uint64_t, metrics::counter_count> counters{};
+            std::size_t gpu_count = 0;
+            std::array<gpu_timing_event, max_gpu_events> gpu{}; // already in profiler_now_ns() time
+        };
+
+        struct resource_event {
+            std::uint64_t ns = 0;
+            resource_kind kind = resource_kind::shader;
+            gl_uint id = 0;
+            std::uint64_t bytes = 0;
+        };
+
+        struct recorder {
+            params p;
+            std::vector<frame_record> frames; // ring, sized by enable()
+            std::uint64_t head = 0;
+            std::array<resource_event, resource_ring_size> resources{};
+            std::uint64_t resource_head = 0;
+
+            const gpu_profiler *gpu = nullptr;
+            std::uint64_t gpu_resolved = 0; // gpu->frame().samples at the last copy
+
+            std::uint64_t last_end_ns = 0;
+            int pending = -1; // frames until the queued dump
+            std::uint64_t hitch_index = 0;
+            double hitch_ms = 0.0;
+            bool has_dumped = false;
+            std::uint64_t last_dump_ns = 0;
+
+            std::uint64_t dumps = 0;
+            std::uint64_t suppressed = 0;
+        };
+
+        recorder &rec() noexcept {
+            static recorder r;
+            return r;
+        }
+
+        // what a dump writes, copied out of the rings so the worker owns it
+        struct capture {
+            std::vector<frame_record> frames; // oldest first
+            std::vector<resource_event> resources;
+            double budget_ms = 0.0;
+            bool has_hitch = false;
+            std::uint64_t hitch_index = 0;
+        };
+
+        capture take(const recorder &r) {
+            capture c;
+            c.budget_ms = r.p.budget_ms;
+
+            const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(r.head, r.frames.size()));
+            c.frames.reserve(n);
+            for (std::uint64_t i = r.head - n; i < r.head; ++i) {
+                c.frames.push_back(r.frames[static_cast<std::size_t>(i % r.frames.size())]);
+            }
+            if (c.frames.empty()) {
+                return c;
+            }
+
+            const std::uint64_t origin = c.frames.front().begin_ns;
+            const std::uint64_t first = r.resource_head > resource_ring_size ? r.resource_head - resource_ring_size : 0;
+            for (std::uint64_t i = first; i < r.resource_head; ++i) {
+                const resource_event &e = r.resources[i % resource_ring_size];
+                if (e.ns >= origin) {
+                    c.resources.push_back(e);
+                }
+            }
+            return c;
+        }
+
+        double to_us(std::uint64_t ns, std::uint64_t origin) noexcept {
+            return static_cast<double>(ns - origin) * 1e-3;
+        }
+
+        std::string to_trace(const capture &c) {
+            const std::uint64_t origin = c.frames.front().begin_ns;
+            const std::uint64_t last_end = c.frames.back().end_ns;
+
+            std::string out;
+            out.reserve(1024 + c.frames.size() * 512);
+            out += R"({"displayTimeUnit":"ms","traceEvents":[)";
+            out += R"({"ph":"M","name":"process_name","pid":1,"tid":0,"args":{"name":"sgl cpu"}},)";
+            out += R"({"ph":"M","name":"process_name","pid":2,"tid":0,"args":{"name":"sgl gpu"}},)";
+            out += R"({"ph":"M","name":"thread_name","pid":2,"tid":1,"args":{"name":"gpu"}})";
+            fmt::format_to(std::back_inserter(out),
+                           R"(,{{"ph":"M","name":"process_name","pid":{0},"tid":0,"args":{{"name":"sgl frames"}}}})"
+                           R"(,{{"ph":"M","name":"thread_name","pid":{0},"tid":{1},"args":{{"name":"frames"}}}})"
+                           R"(,{{"ph":"M","name":"thread_name","pid":{0},"tid":{2},"args":{{"name":"resources"}}}})",
+                           frames_pid, frames_tid, resources_tid);
+
+            for (const frame_record &f: c.frames) {
+                const double frame_ms = static_cast<double>(f.end_ns - f.begin_ns) * 1e-6;
+                fmt::format_to(std::back_inserter(out),
+                               R"(,{{"ph":"X","name":"frame {}","pid":{},"tid":{},"ts":{:.3f},"dur":{:.3f},)"
+                               R"("args":{{"frame_ms":{:.3f},"over_budget":{})",
+                               f.index, frames_pid, frames_tid, to_us(f.begin_ns, origin),
+                               to_us(f.end_ns, f.begin_ns), frame_ms, frame_ms > c.budget_ms);
+                for (std::size_t i = 0; i < metrics::counter_count; ++i) {
+                    fmt::format_to(std::back_inserter(out), R"(,"{}":{})",
+                                   metrics::counter_name(static_cast<metrics::counter>(i)), f.counters[i]);
+                }
+                out += "}}";
+
+                fmt::format_to(std::back_inserter(out),
+                               R"(,{{"ph":"X","name":"swap_buffers","pid":{},"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                               frames_pid, frames_tid, to_us(f.swap_begin_ns, origin),
+                               to_us(f.end_ns, f.swap_begin_ns));
+
+                // counter tracks, one value per frame
+                const auto counter_at = [&f](metrics::counter cnt) {
+                    return f.counters[static_cast<std::size_t>(cnt)];
+                };
+                fmt::format_to(std::back_inserter(out),
+                               R"(,{{"ph":"C","name":"gl work","pid":{},"ts":{:.3f},"args":)"
+                               R"({{"draw_calls":{},"state_changes":{},"uniform_uploads":{},"gl_calls":{}}}}})",
+                               frames_pid, to_us(f.begin_ns, origin), counter_at(metrics::counter::draw_calls),
+                               counter_at(metrics::counter::state_changes),
+                               counter_at(metrics::counter::uniform_uploads), counter_at(metrics::counter::gl_calls));
+
+                for (std::size_t i = 0; i < f.gpu_count; ++i) {
+                    const gpu_timing_event &e = f.gpu[i];
+                    if (e.begin_ns < origin || e.end_ns < e.begin_ns) {
+                        continue;
+                    }
+                    out += R"(,{"ph":"X","name":)";
+                    sgl::detail::append_json_string(out, e.name ? e.name : "?");
+                    fmt::format_to(std::back_inserter(out), R"(,"pid":2,"tid":1,"ts":{:.3f},"dur":{:.3f}}})",
+                                   to_us(e.begin_ns, origin), to_us(e.end_ns, e.begin_ns));
+                }
+            }
+
+            for (const resource_event &e: c.resources) {
+                fmt::format_to(std::back_inserter(out),
+                               R"(,{{"ph":"i","s":"t","name":"{} created","pid":{},"tid":{},"ts":{:.3f},)"
+                               R"("args":{{"id":{},"bytes":{}}}}})",
+                               resource_kind_name(e.kind), frames_pid, resources_tid, to_us(e.ns, origin), e.id,
+                               e.bytes);
+            }
+
+            if (c.has_hitch) {
+                for (const frame_record &f: c.frames) {
+                    if (f.index == c.hitch_index) {
+                        fmt::format_to(std::back_inserter(out),
+                                       R"(,{{"ph":"i","s":"g","name":"hitch","pid":{},"tid":{},"ts":{:.3f}}})",
+                                       frames_pid, frames_tid, to_us(f.end_ns, origin));
+                    }
+                }
+            }
+
+            sgl::detail::profiler_append_cpu_events(out, origin, last_end, origin);
+
+            out += "]}\n";
+            return out;
+        }
+
+        void write_trace(const std::string &path, const capture &c) {
+            const std::string trace = to_trace(c);
+
+            FILE *f = std::fopen(path.c_str(), "wb");
+            if (!f) {
+                log_error(log_subsystem::profiling, "flight recorder: failed to open '{}'", path);
+                return;
+            }
+            const bool ok = std::fwrite(trace.data(), 1, trace.size(), f) == trace.size();
+            if (std::fclose(f) != 0 || !ok) {
+                log_error(log_subsystem::profiling, "flight recorder: failed to write '{}'", path);
+                return;
+            }
+            log_info(log_subsystem::profiling, "flight recorder: wrote {} frames to '{}'", c.frames.size(), path);
+        }
+
+        bool queue_dump(recorder &r, std::string path, bool hitch) noexcept {
+            capture c = take(r);
+            if (c.frames.empty()) {
+                return false;
+            }
+            c.has_hitch = hitch;
+            c.hitch_index = r.hitch_index;
+            ++r.dumps;
+
+            sgl::detail::submit_job([path = std::move(path), c = std::move(c)] { write_trace(path, c); });
+            return true;
+        }
+    }
+
+    const char *resource_kind_name(resource_kind kind) noexcept {
+        switch (kind) {
+            case resource_kind::shader: return "shader";
+            case resource_kind::texture: return "texture";
+            case resource_kind::vertex_buffer: return "vertex_buffer";
+            case resource_kind::element_buffer: return "element_buffer";
+            case resource_kind::framebuffer: return "framebuffer";
+            default: return "unknown";
+        }
+    }
+
+    void enable(const params &p) noexcept {
+        recorder &r = rec();
+
+        r.p = p;
+        r.p.frames = std::max<std::size_t>(p.frames, 2);
+        r.p.post_frames = std::clamp(p.post_frames, 0, static_cast<int>(r.p.frames) - 1);
+        if (!r.p.path_prefix) {
+            r.p.path_prefix = "sgl_hitch";
+        }
+
+        r.frames.assign(r.p.frames, frame_record{});
+        r.head = 0;
+        r.resource_head = 0;
+        r.last_end_ns = 0;
+        r.pending = -1;
+        r.has_dumped = false;
+        detail::g_enabled = true;
+    }
+
+    void disable() noexcept {
+        recorder &r = rec();
+
+        detail::g_enabled = false;
+        r.frames.clear();
+        r.frames.shrink_to_fit();
+        r.pending = -1;
+    }
+
+    bool enabled() noexcept {
+        return detail::g_enabled;
+    }
+
+    void attach(const gpu_profiler *profiler) noexcept {
+        recorder &r = rec();
+
+        r.gpu = profiler;
+        r.gpu_resolved = profiler ? profiler->frame().samples : 0;
+    }
+
+    namespace detail {
+        void record_resource(resource_kind kind, gl_uint id, std::uint64_t bytes) noexcept {
+            recorder &r = rec();
+
+            r.resources[r.resource_head++ % resource_ring_size] = resource_event{
+                .ns = profiler_now_ns(), .kind = kind, .id = id, .bytes = bytes
+            };
+        }
+    }
+
+    void end_frame(std::uint64_t swap_begin_ns, std::uint64_t end_ns) noexcept {
+        if (!detail::g_enabled) {
+            return;
+        }
+
+        recorder &r = rec();
+
+        // the first frame after enable() has no start
+        if (r.last_end_ns == 0) {
+            r.last_end_ns = end_ns;
+            return;
+        }
+
+        frame_record &f = r.frames[static_cast<std::size_t>(r.head % r.frames.size())];
+        f.index = metrics::last_frame().index;
+        f.begin_ns = r.last_end_ns;
+        f.swap_begin_ns = swap_begin_ns;
+        f.end_ns = end_ns;
+        f.counters = metrics::last_frame().counters;
+
+        // gpu results arrive frames late and stay the same until the next frame resolves
+        f.gpu_count = 0;
+        if (r.gpu && r.gpu->frame().samples != r.gpu_resolved) {
+            r.gpu_resolved = r.gpu->frame().samples;
+            for (const gpu_timing_event &e: r.gpu->last_frame_events()) {
+                if (f.gpu_count == max_gpu_events) {
+                    break;
+                }
+                f.gpu[f.gpu_count++] = gpu_timing_event{
+                    .name = e.name, .begin_ns = r.gpu->to_cpu_ns(e.begin_ns), .end_ns = r.gpu->to_cpu_ns(e.end_ns),
+                    .depth = e.depth
+                };
+            }
+        }
+
+        ++r.head;
+        r.last_end_ns = end_ns;
+
+        const double frame_ms = static_cast<double>(end_ns - f.begin_ns) * 1e-6;
+        if (frame_ms > r.p.budget_ms) {
+            const auto cooldown_ns = static_cast<std::uint64_t>(std::max(r.p.cooldown_sec, 0.0) * 1e9);
+            if (r.pending >= 0) {
+                // the queued dump covers it
+            } else if (r.has_dumped && end_ns - r.last_dump_ns < cooldown_ns) {
+                ++r.suppressed;
+            } else {
+                r.pending = r.p.post_frames;
+                r.hitch_index = f.index;
+                r.hitch_ms = frame_ms;
+                r.has_dumped = true;
+                r.last_dump_ns = end_ns;
+            }
+        }
+
+        if (r.pending >= 0 && r.pending-- == 0) {
+            std::string path = fmt::format("{}_{}.json", r.p.path_prefix, r.hitch_index);
+            log_warn(log_subsystem::profiling,
+                     "flight recorder: frame {} took {:.1f} ms (budget {:.1f} ms), dumping to '{}'",
+                     r.hitch_index, r.hitch_ms, r.p.budget_ms, path);
+            queue_dump(r, std::move(path), true);
+        }
+    }
+
+    bool dump(const char *path) noexcept {
+        if (!path || !detail::g_enabled) {
+            return false;
+        }
+        return queue_dump(rec(), path, false);
+    }
+
+    std::uint64_t dumps() noexcept {
+        return rec().dumps;
+    }
+
+    std::uint64_t suppressed() noexcept {
+        return rec().suppressed;
+    }
+}
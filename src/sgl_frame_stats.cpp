@@ -0,0 +1,83 @@
+#include "internal/sgl_frame_stats.h"
+
+#include <algorithm>
+
+namespace sgl {
+    void frame_time_tracker::record(double ms) noexcept {
+        // what the ring keeps, so remove() later hits the same bucket
+        const float stored = static_cast<float>(std::max(ms, 0.0));
+        ms = static_cast<double>(stored);
+
+        const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t slot = head & (frame_window - 1);
+
+        if (head >= frame_window) {
+            m_histogram.remove(static_cast<double>(m_ring[slot].load(std::memory_order_relaxed)));
+            if (m_stutter[slot]) {
+                --m_window_stutters;
+            }
+        }
+
+        m_histogram.record(ms);
+
+        // a percentile walks the buckets: not every frame once the median has settled
+        if (head < 16 || (head & 7) == 0) {
+            m_median_ms = m_histogram.percentile(50.0);
+        }
+
+        const bool stutter = head >= 8 && ms > m_stutter_factor * m_median_ms;
+        m_stutter[slot] = stutter;
+        if (stutter) {
+            ++m_window_stutters;
+            ++m_total_stutters;
+        }
+
+        m_ring[slot].store(stored, std::memory_order_relaxed);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    frame_time_stats frame_time_tracker::stats() const noexcept {
+        const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(head, frame_window));
+
+        // the histogram's max is all-time, the window's comes from the ring
+        float max_ms = 0.0f;
+        for (std::size_t i = 0; i < n; ++i) {
+            max_ms = std::max(max_ms, m_ring[i].load(std::memory_order_relaxed));
+        }
+
+        frame_time_stats s;
+        s.frames = m_histogram.count();
+        s.avg_ms = m_histogram.avg_ms();
+        s.fps = s.avg_ms > 0.0 ? 1000.0 / s.avg_ms : 0.0;
+        s.p50_ms = m_histogram.percentile(50.0);
+        s.p95_ms = m_histogram.percentile(95.0);
+        s.p99_ms = m_histogram.percentile(99.0);
+        s.max_ms = static_cast<double>(max_ms);
+        s.stutters = m_window_stutters;
+        s.total_stutters = m_total_stutters;
+        return s;
+    }
+
+    std::size_t frame_time_tracker::copy_recent(std::span<float> out) const noexcept {
+        const std::uint64_t head = m_head.load(std::memory_order_acquire);
+        const auto n = static_cast<std::size_t>(std::min<std::uint64_t>({head, frame_window, out.size()}));
+        const std::uint64_t first = head - n;
+
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = m_ring[(first + i) & (frame_window - 1)].load(std::memory_order_relaxed);
+        }
+
+        // the writer may have lapped the oldest entries while we copied
+        const std::uint64_t after = m_head.load(std::memory_order_acquire);
+        const std::uint64_t valid_from = after > frame_window ? after - frame_window : 0;
+        if (valid_from <= first) {
+            return n;
+        }
+
+        const auto lost = static_cast<std::size_t>(std::min<std::uint64_t>(valid_from - first, n));
+        std::copy(out.begin() + static_cast<std::ptrdiff_t>(lost), out.begin() + static_cast<std::ptrdiff_t>(n),
+                  out.begin());
+        return n - lost;
+    }
+}
@@ -0,0 +1,379 @@
+#include "internal/sgl_framebuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <cassert>
+
+#include "glad/glad.h"
+
+#include "internal/sgl_log.h"
+#include "internal/sgl_flight_recorder.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_texture_bind.h"
+
+namespace {
+    bool has_stencil(GLenum internal_format) noexcept {
+        return internal_format == GL_DEPTH24_STENCIL8 || internal_format == GL_DEPTH32F_STENCIL8;
+    }
+
+    GLenum depth_attachment(GLenum internal_format) noexcept {
+        return has_stencil(internal_format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+    }
+
+    // client format/type accepted by glTexImage2D(nullptr) for the internal format
+    std::pair<GLenum, GLenum> transfer_of(GLenum internal_format) noexcept {
+        switch (internal_format) {
+            case GL_DEPTH24_STENCIL8: return {GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8};
+            case GL_DEPTH32F_STENCIL8: return {GL_DEPTH_STENCIL, GL_FLOAT_32_UNSIGNED_INT_24_8_REV};
+            case GL_DEPTH_COMPONENT16:
+            case GL_DEPTH_COMPONENT24:
+            case GL_DEPTH_COMPONENT32:
+            case GL_DEPTH_COMPONENT32F: return {GL_DEPTH_COMPONENT, GL_FLOAT};
+            case GL_R16F:
+            case GL_RG16F:
+            case GL_RGB16F:
+            case GL_RGBA16F:
+            case GL_R32F:
+            case GL_RG32F:
+            case GL_RGB32F:
+            case GL_RGBA32F:
+            case GL_R11F_G11F_B10F: return {GL_RGBA, GL_FLOAT};
+            default: return {GL_RGBA, GL_UNSIGNED_BYTE};
+        }
+    }
+
+    GLuint make_texture(GLenum internal_format, GLsizei w, GLsizei h) noexcept {
+        GLuint id = 0;
+        glGenTextures(1, &id);
+        if (id == 0) {
+            return 0;
+        }
+
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        const auto [format, type] = transfer_of(internal_format);
+
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internal_format), w, h, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(prev_tex));
+        return id;
+    }
+
+    GLuint make_renderbuffer(GLenum internal_format, GLsizei w, GLsizei h, GLsizei samples) noexcept {
+        GLuint id = 0;
+        glGenRenderbuffers(1, &id);
+        if (id == 0) {
+            return 0;
+        }
+
+        GLint prev_rbo = 0;
+        glGetIntegerv(GL_RENDERBUFFER_BINDING, &prev_rbo);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, id);
+        if (samples > 0) {
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, internal_format, w, h);
+        } else {
+            glRenderbufferStorage(GL_RENDERBUFFER, internal_format, w, h);
+        }
+
+        glBindRenderbuffer(GL_RENDERBUFFER, static_cast<GLuint>(prev_rbo));
+        return id;
+    }
+
+    bool has_invalidate() noexcept {
+        return GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_invalidate_subdata;
+    }
+}
+
+namespace sgl {
+    // ctors and assignments
+
+    framebuffer::framebuffer(framebuffer &&other) noexcept : m_params{other.m_params},
+                                                             m_id{std::exchange(other.m_id, 0)},
+                                                             m_color_tex{std::exchange(other.m_color_tex, 0)},
+                                                             m_color_rbo{std::exchange(other.m_color_rbo, 0)},
+                                                             m_depth_tex{std::exchange(other.m_depth_tex, 0)},
+                                                             m_depth_rbo{std::exchange(other.m_depth_rbo, 0)} {
+    }
+
+    framebuffer &framebuffer::operator=(framebuffer &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        destroy();
+
+        m_params = other.m_params;
+        m_id = std::exchange(other.m_id, 0);
+        m_color_tex = std::exchange(other.m_color_tex, 0);
+        m_color_rbo = std::exchange(other.m_color_rbo, 0);
+        m_depth_tex = std::exchange(other.m_depth_tex, 0);
+        m_depth_rbo = std::exchange(other.m_depth_rbo, 0);
+
+        return *this;
+    }
+
+    framebuffer::~framebuffer() {
+        destroy();
+    }
+
+    // fabrics
+
+    framebuffer::result framebuffer::create(const framebuffer_params &params) noexcept {
+        if (params.width <= 0 || params.height <= 0 || params.samples < 0) {
+            return unexpected{error::invalid_params};
+        }
+        if (params.color_format == 0 && params.depth_format == 0) {
+            log_error(log_subsystem::framebuffer, "framebuffer::create: no attachments requested");
+            return unexpected{error::invalid_params};
+        }
+
+        // partially built objects are released by fb's destructor on the error paths
+        framebuffer fb{params};
+
+        glGenFramebuffers(1, &fb.m_id);
+        if (fb.m_id == 0) {
+            log_error(log_subsystem::framebuffer, "glGenFramebuffers() returned 0");
+            return unexpected{error::gl_gen_failed};
+        }
+
+        const bool msaa = params.samples > 0;
+        const GLsizei w = params.width;
+        const GLsizei h = params.height;
+
+        GLint prev_fbo = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fb.m_id);
+
+        if (params.color_format != 0) {
+            if (params.color_texture && !msaa) {
+                fb.m_color_tex = make_texture(params.color_format, w, h);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fb.m_color_tex, 0);
+            } else {
+                fb.m_color_rbo = make_renderbuffer(params.color_format, w, h, params.samples);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, fb.m_color_rbo);
+            }
+        } else {
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+
+        if (params.depth_format != 0) {
+            const GLenum point = depth_attachment(params.depth_format);
+            if (params.depth_texture && !msaa) {
+                fb.m_depth_tex = make_texture(params.depth_format, w, h);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, point, GL_TEXTURE_2D, fb.m_depth_tex, 0);
+            } else {
+                fb.m_depth_rbo = make_renderbuffer(params.depth_format, w, h, params.samples);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, point, GL_RENDERBUFFER, fb.m_depth_rbo);
+            }
+        }
+
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prev_fbo));
+
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            log_error(log_subsystem::framebuffer, "framebuffer::create: incomplete (status 0x{:X})", status);
+            return unexpected{error::incomplete};
+        }
+
+        flight_recorder::resource_created(flight_recorder::resource_kind::framebuffer, fb.m_id);
+        return fb;
+    }
+
+    // try wrappers
+
+    framebuffer framebuffer::create_try(const framebuffer_params &params) noexcept {
+        auto res = create(params);
+        if (!res) {
+            log_fatal("failed to create framebuffer: {}", err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
+    // api
+
+    void framebuffer::bind() const noexcept {
+        assert(m_id);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+        glViewport(0, 0, m_params.width, m_params.height);
+        metrics::add(metrics::counter::state_changes);
+    }
+
+    void framebuffer::bind_default(gl_sizei width, gl_sizei height) noexcept {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, width, height);
+        metrics::add(metrics::counter::state_changes);
+    }
+
+    bool framebuffer::blit_to(const framebuffer &dst, bool color, bool depth, gl_enum filter) const noexcept {
+        assert(m_id && dst.id());
+
+        GLbitfield mask = 0;
+        if (color) { mask |= GL_COLOR_BUFFER_BIT; }
+        if (depth) { mask |= GL_DEPTH_BUFFER_BIT | (has_stencil(m_params.depth_format) ? GL_STENCIL_BUFFER_BIT : 0); }
+
+        return blit(dst.id(), dst.width(), dst.height(), mask, filter);
+    }
+
+    bool framebuffer::blit_to_default(gl_sizei width, gl_sizei height, gl_enum filter) const noexcept {
+        assert(m_id);
+
+        return blit(0, width, height, GL_COLOR_BUFFER_BIT, filter);
+    }
+
+    void framebuffer::invalidate(bool color, bool depth) const noexcept {
+        assert(m_id);
+
+        if (!has_invalidate()) {
+            return;
+        }
+
+        std::array<GLenum, 2> attachments{};
+        GLsizei count = 0;
+        if (color && m_params.color_format != 0) {
+            attachments[count++] = GL_COLOR_ATTACHMENT0;
+        }
+        if (depth && m_params.depth_format != 0) {
+            attachments[count++] = depth_attachment(m_params.depth_format);
+        }
+        if (count == 0) {
+            return;
+        }
+
+        GLint prev_draw = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw);
+
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_id);
+        glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, count, attachments.data());
+
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prev_draw));
+    }
+
+    void framebuffer::bind_color_texture(gl_uint unit) const noexcept {
+        assert(m_color_tex && "framebuffer: color attachment is not a texture");
+
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, m_color_tex);
+        detail::on_texture_bound(unit, m_color_tex);
+    }
+
+    void framebuffer::bind_depth_texture(gl_uint unit) const noexcept {
+        assert(m_depth_tex && "framebuffer: depth attachment is not a texture");
+
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, m_depth_tex);
+        detail::on_texture_bound(unit, m_depth_tex);
+    }
+
+    // internal
+
+    bool framebuffer::blit(gl_uint dst_id, gl_sizei dw, gl_sizei dh, gl_bitfield mask, gl_enum filter) const noexcept {
+        if (mask == 0) {
+            return true;
+        }
+
+        const bool same_size = dw == m_params.width && dh == m_params.height;
+        const bool depth_stencil = (mask & (GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT)) != 0;
+
+        // GL_INVALID_OPERATION otherwise, which would copy nothing without a word
+        if (m_params.samples > 0 && !same_size) {
+            log_error(log_subsystem::framebuffer,
+                      "framebuffer::blit: a multisampled resolve can't scale ({}x{} -> {}x{})", m_params.width,
+                      m_params.height, dw, dh);
+            return false;
+        }
+        if (filter == GL_LINEAR && depth_stencil) {
+            log_error(log_subsystem::framebuffer,
+                      "framebuffer::blit: depth / stencil can only be blitted with GL_NEAREST");
+            return false;
+        }
+
+        if (filter == 0) {
+            filter = depth_stencil || same_size ? GL_NEAREST : GL_LINEAR;
+        }
+
+        GLint prev_read = 0, prev_draw = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_read);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_id);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst_id);
+        glBlitFramebuffer(0, 0, m_params.width, m_params.height, 0, 0, dw, dh, mask, filter);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(prev_read));
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prev_draw));
+        return true;
+    }
+
+    void framebuffer::destroy() noexcept {
+        if (m_id != 0) {
+            glDeleteFramebuffers(1, &m_id);
+            m_id = 0;
+        }
+        for (auto *tex: {&m_color_tex, &m_depth_tex}) {
+            if (*tex != 0) {
+                glDeleteTextures(1, tex);
+                detail::on_texture_deleted(*tex);
+                *tex = 0;
+            }
+        }
+        for (auto *rbo: {&m_color_rbo, &m_depth_rbo}) {
+            if (*rbo != 0) {
+                glDeleteRenderbuffers(1, rbo);
+                *rbo = 0;
+            }
+        }
+    }
+
+    // framebuffer_pool
+
+    framebuffer *framebuffer_pool::acquire(const framebuffer_params &params) noexcept {
+        for (auto &e: m_entries) {
+            if (!e->in_use && e->fb.params() == params) {
+                e->in_use = true;
+                e->used = true;
+                return &e->fb;
+            }
+        }
+
+        auto res = framebuffer::create(params);
+        if (!res) {
+            return nullptr;
+        }
+
+        m_entries.push_back(std::make_unique<entry>(entry{.fb = std::move(*res), .in_use = true, .used = true}));
+        return &m_entries.back()->fb;
+    }
+
+    void framebuffer_pool::release(const framebuffer *fb) noexcept {
+        for (auto &e: m_entries) {
+            if (&e->fb == fb) {
+                e->in_use = false;
+                return;
+            }
+        }
+    }
+
+    void framebuffer_pool::end_frame() noexcept {
+        for (auto &e: m_entries) {
+            e->idle_frames = e->used ? 0 : e->idle_frames + 1;
+            e->in_use = false;
+            e->used = false;
+        }
+
+        std::erase_if(m_entries, [this](const std::unique_ptr<entry> &e) {
+            return e->idle_frames > m_max_idle_frames;
+        });
+    }
+}
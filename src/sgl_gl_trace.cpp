@@ -0,0 +1,447 @@
+#include "internal/sgl_gl_trace.h"
+
+#if SGL_GL_TRACE
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "glad/glad.h"
+
+#include "internal/sgl_backend.h"
+#include "internal/sgl_log.h"
+#include "internal/sgl_metrics.h"
+
+// every GL function sgl calls. without the gl prefix: glad #defines the full names to its pointers
+#define SGL_GL_ENTRY_POINTS(X) \
+    X(ActiveTexture) X(AttachShader) X(BeginQuery) X(BindBuffer) X(BindFramebuffer) X(BindRenderbuffer) \
+    X(BindSampler) X(BindSamplers) X(BindTexture) X(BindTextures) X(BindVertexArray) X(BlitFramebuffer) \
+    X(BufferData) X(CheckFramebufferStatus) X(Clear) X(ClearColor) X(ClientWaitSync) X(CompileShader) \
+    X(CreateProgram) X(CreateShader) X(DeleteBuffers) X(DeleteFramebuffers) X(DeleteProgram) X(DeleteQueries) \
+    X(DeleteRenderbuffers) X(DeleteSamplers) X(DeleteShader) X(DeleteSync) X(DeleteTextures) \
+    X(DeleteVertexArrays) X(DetachShader) X(Disable) X(DisableVertexAttribArray) X(DrawArrays) \
+    X(DrawArraysInstanced) X(DrawBuffer) X(DrawElements) X(DrawElementsInstanced) X(Enable) \
+    X(EnableVertexAttribArray) X(EndQuery) X(FenceSync) X(FramebufferRenderbuffer) X(FramebufferTexture2D) \
+    X(GenBuffers) X(GenFramebuffers) X(GenQueries) X(GenRenderbuffers) X(GenSamplers) X(GenTextures) \
+    X(GenVertexArrays) X(GenerateMipmap) X(GetBufferParameteri64v) X(GetInteger64v) X(GetIntegerv) \
+    X(GetProgramInfoLog) X(GetProgramiv) X(GetQueryObjectiv) X(GetQueryObjectui64v) X(GetShaderInfoLog) \
+    X(GetShaderiv) X(GetString) X(GetStringi) X(GetUniformLocation) X(InvalidateFramebuffer) X(LineWidth) \
+    X(LinkProgram) X(MapBufferRange) X(PixelStorei) X(PolygonMode) X(QueryCounter) X(ReadBuffer) X(ReadPixels) \
+    X(RenderbufferStorage) X(RenderbufferStorageMultisample) X(SamplerParameteri) X(ShaderSource) \
+    X(TexImage2D) X(TexParameteri) X(TexParameteriv) X(TexSubImage2D) X(Uniform1f) X(Uniform1i) X(Uniform1ui) \
+    X(Uniform2fv) X(Uniform3fv) X(Uniform4fv) X(UniformMatrix3fv) X(UniformMatrix4fv) X(UnmapBuffer) \
+    X(UseProgram) X(VertexAttribIPointer) X(VertexAttribLPointer) X(VertexAttribPointer) X(Viewport)
+
+namespace {
+    enum entry_point : std::size_t {
+#define SGL_GL_ENUM(name) ep_##name,
+        SGL_GL_ENTRY_POINTS(SGL_GL_ENUM)
+#undef SGL_GL_ENUM
+        entry_point_count
+    };
+
+    constexpr std::size_t max_trace_args = 10; // glBlitFramebuffer
+
+    struct trace_call {
+        std::size_t entry = 0;
+        std::array<std::uint64_t, max_trace_args> args{};
+    };
+
+    // GL thread only, like the calls themselves
+    std::array<std::uint64_t, entry_point_count> g_counts{};
+    std::vector<trace_call> g_trace; // ring
+    std::uint64_t g_trace_head = 0;
+    bool g_null_backend = false;
+
+    template<typename T>
+    std::uint64_t pack_arg(T v) noexcept {
+        if constexpr (std::is_pointer_v<T>) {
+            return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(v));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return std::bit_cast<std::uint64_t>(static_cast<double>(v));
+        } else if constexpr (std::is_signed_v<T>) {
+            return static_cast<std::uint64_t>(static_cast<std::int64_t>(v));
+        } else {
+            return static_cast<std::uint64_t>(v);
+        }
+    }
+
+    template<typename T>
+    void format_arg(std::string &out, std::uint64_t bits) {
+        if constexpr (std::is_pointer_v<T>) {
+            if (bits == 0) {
+                out += "nullptr";
+            } else {
+                fmt::format_to(std::back_inserter(out), "0x{:x}", bits);
+            }
+        } else if constexpr (std::is_floating_point_v<T>) {
+            fmt::format_to(std::back_inserter(out), "{}", std::bit_cast<double>(bits));
+        } else if constexpr (std::is_signed_v<T>) {
+            fmt::format_to(std::back_inserter(out), "{}", static_cast<std::int64_t>(bits));
+        } else {
+            fmt::format_to(std::back_inserter(out), "{}", bits);
+        }
+    }
+
+    // one per entry point: call() is what glad's pointer holds once installed, next the driver (or the
+    // null backend's stub)
+    template<std::size_t I, typename F>
+    struct hook;
+
+    template<std::size_t I, typename R, typename... A>
+    struct hook<I, R (APIENTRYP)(A...)> {
+        static_assert(sizeof...(A) <= max_trace_args);
+
+        using fn = R (APIENTRYP)(A...);
+
+        static inline fn next = nullptr;
+
+        static R APIENTRY call(A... args) {
+            ++g_counts[I];
+            sgl::metrics::add(sgl::metrics::counter::gl_calls);
+            if (!g_trace.empty()) {
+                trace_call &c = g_trace[g_trace_head++ % g_trace.size()];
+                c.entry = I;
+                c.args = {pack_arg(args)...};
+            }
+            return next(args...);
+        }
+
+        static R APIENTRY null_call(A...) {
+            if constexpr (!std::is_void_v<R>) {
+                return R{};
+            }
+        }
+
+        static void format(std::string &out, const trace_call &c) {
+            [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                ((out += Is ? ", " : "", format_arg<A>(out, c.args[Is])), ...);
+            }(std::index_sequence_for<A...>{});
+        }
+
+        static void wrap(fn &slot, fn driver) noexcept {
+            if (!driver || driver == &call) {
+                return;
+            }
+            next = driver;
+            slot = &call;
+        }
+
+        static void stub(fn &slot) noexcept {
+            next = &null_call;
+            slot = &call;
+        }
+    };
+
+    template<std::size_t I, typename F>
+    using hook_of = hook<I, std::remove_cvref_t<F> >;
+
+    struct entry_info {
+        const char *name;
+        void (*format)(std::string &, const trace_call &);
+    };
+
+    constexpr std::array<entry_info, entry_point_count> g_entries{{
+#define SGL_GL_INFO(name) {"gl" #name, &hook_of<ep_##name, decltype(glad_gl##name)>::format},
+        SGL_GL_ENTRY_POINTS(SGL_GL_INFO)
+#undef SGL_GL_INFO
+    }};
+
+    // null backend
+
+    GLuint g_next_id = 1;
+    GLint64 g_last_buffer_size = 0; // for the debug size check after glBufferData
+    std::vector<unsigned char> g_mapped;
+
+    void APIENTRY null_gen(GLsizei n, GLuint *ids) {
+        for (GLsizei i = 0; i < n; ++i) {
+            ids[i] = g_next_id++;
+        }
+    }
+
+    GLuint APIENTRY null_create_program() {
+        return g_next_id++;
+    }
+
+    GLuint APIENTRY null_create_shader(GLenum) {
+        return g_next_id++;
+    }
+
+    void APIENTRY null_get_object_iv(GLuint, GLenum pname, GLint *params) {
+        *params = pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS ? GL_TRUE : 0;
+    }
+
+    void APIENTRY null_get_integerv(GLenum pname, GLint *data) {
+        switch (pname) {
+            case GL_MAJOR_VERSION: *data = 4; break;
+            case GL_MINOR_VERSION: *data = 6; break;
+            case GL_CONTEXT_PROFILE_MASK: *data = GL_CONTEXT_CORE_PROFILE_BIT; break;
+            case GL_UNPACK_ALIGNMENT: *data = 4; break;
+            default: *data = 0; break;
+        }
+    }
+
+    void APIENTRY null_get_integer64v(GLenum, GLint64 *data) {
+        *data = 0;
+    }
+
+    void APIENTRY null_buffer_data(GLenum, GLsizeiptr size, const void *, GLenum) {
+        g_last_buffer_size = size;
+    }
+
+    void APIENTRY null_get_buffer_parameteri64v(GLenum, GLenum pname, GLint64 *params) {
+        *params = pname == GL_BUFFER_SIZE ? g_last_buffer_size : 0;
+    }
+
+    GLenum APIENTRY null_check_framebuffer_status(GLenum) {
+        return GL_FRAMEBUFFER_COMPLETE;
+    }
+
+    GLsync APIENTRY null_fence_sync(GLenum, GLbitfield) {
+        // never dereferenced, only compared and handed back
+        return reinterpret_cast<GLsync>(static_cast<std::uintptr_t>(g_next_id++));
+    }
+
+    GLenum APIENTRY null_client_wait_sync(GLsync, GLbitfield, GLuint64) {
+        return GL_ALREADY_SIGNALED;
+    }
+
+    void *APIENTRY null_map_buffer_range(GLenum, GLintptr, GLsizeiptr length, GLbitfield) {
+        g_mapped.resize(static_cast<std::size_t>(std::max<GLsizeiptr>(length, 1)));
+        return g_mapped.data();
+    }
+
+    GLboolean APIENTRY null_unmap_buffer(GLenum) {
+        return GL_TRUE;
+    }
+
+    void APIENTRY null_get_query_objectiv(GLuint, GLenum pname, GLint *params) {
+        *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    }
+
+    void APIENTRY null_get_query_objectui64v(GLuint, GLenum, GLuint64 *params) {
+        *params = 0;
+    }
+
+    const GLubyte *APIENTRY null_get_string(GLenum name) {
+        const char *s = "";
+        switch (name) {
+            case GL_VENDOR: s = "sgl"; break;
+            case GL_RENDERER: s = "sgl null backend"; break;
+            case GL_VERSION: s = "4.6 (sgl null backend)"; break;
+            case GL_SHADING_LANGUAGE_VERSION: s = "4.60"; break;
+            default: break;
+        }
+        return reinterpret_cast<const GLubyte *>(s);
+    }
+
+    const GLubyte *APIENTRY null_get_stringi(GLenum, GLuint) {
+        return reinterpret_cast<const GLubyte *>("");
+    }
+
+    GLint APIENTRY null_get_uniform_location(GLuint, const GLchar *) {
+        return 0;
+    }
+}
+
+namespace sgl::gl_trace {
+    bool use_null_backend() noexcept {
+        if (g_null_backend) {
+            return true;
+        }
+        if (sgl::detail::is_glad_initialized()) {
+            log_error(log_subsystem::profiling,
+                      "gl_trace: a GL context is already loaded, not switching to the null backend");
+            return false;
+        }
+
+#define SGL_GL_STUB(name) hook_of<ep_##name, decltype(glad_gl##name)>::stub(glad_gl##name);
+        SGL_GL_ENTRY_POINTS(SGL_GL_STUB)
+#undef SGL_GL_STUB
+
+#define SGL_GL_NULL(name, fn) hook_of<ep_##name, decltype(glad_gl##name)>::next = fn
+        SGL_GL_NULL(GenBuffers, null_gen);
+        SGL_GL_NULL(GenFramebuffers, null_gen);
+        SGL_GL_NULL(GenQueries, null_gen);
+        SGL_GL_NULL(GenRenderbuffers, null_gen);
+        SGL_GL_NULL(GenSamplers, null_gen);
+        SGL_GL_NULL(GenTextures, null_gen);
+        SGL_GL_NULL(GenVertexArrays, null_gen);
+        SGL_GL_NULL(CreateProgram, null_create_program);
+        SGL_GL_NULL(CreateShader, null_create_shader);
+        SGL_GL_NULL(GetShaderiv, null_get_object_iv);
+        SGL_GL_NULL(GetProgramiv, null_get_object_iv);
+        SGL_GL_NULL(GetIntegerv, null_get_integerv);
+        SGL_GL_NULL(GetInteger64v, null_get_integer64v);
+        SGL_GL_NULL(BufferData, null_buffer_data);
+        SGL_GL_NULL(GetBufferParameteri64v, null_get_buffer_parameteri64v);
+        SGL_GL_NULL(CheckFramebufferStatus, null_check_framebuffer_status);
+        SGL_GL_NULL(FenceSync, null_fence_sync);
+        SGL_GL_NULL(ClientWaitSync, null_client_wait_sync);
+        SGL_GL_NULL(MapBufferRange, null_map_buffer_range);
+        SGL_GL_NULL(UnmapBuffer, null_unmap_buffer);
+        SGL_GL_NULL(GetQueryObjectiv, null_get_query_objectiv);
+        SGL_GL_NULL(GetQueryObjectui64v, null_get_query_objectui64v);
+        SGL_GL_NULL(GetString, null_get_string);
+        SGL_GL_NULL(GetStringi, null_get_stringi);
+        SGL_GL_NULL(GetUniformLocation, null_get_uniform_location);
+#undef SGL_GL_NULL
+
+        // what sgl checks before taking a code path
+        for (int *version: {
+                 &GLAD_GL_VERSION_1_0, &GLAD_GL_VERSION_1_1, &GLAD_GL_VERSION_1_2, &GLAD_GL_VERSION_1_3,
+                 &GLAD_GL_VERSION_1_4, &GLAD_GL_VERSION_1_5, &GLAD_GL_VERSION_2_0, &GLAD_GL_VERSION_2_1,
+                 &GLAD_GL_VERSION_3_0, &GLAD_GL_VERSION_3_1, &GLAD_GL_VERSION_3_2, &GLAD_GL_VERSION_3_3,
+                 &GLAD_GL_VERSION_4_0, &GLAD_GL_VERSION_4_1, &GLAD_GL_VERSION_4_2, &GLAD_GL_VERSION_4_3,
+                 &GLAD_GL_VERSION_4_4, &GLAD_GL_VERSION_4_5, &GLAD_GL_VERSION_4_6
+             }) {
+            *version = 1;
+        }
+
+        g_null_backend = true;
+        log_info(log_subsystem::profiling, "gl_trace: using the null backend");
+        return true;
+    }
+
+    bool null_backend() noexcept {
+        return g_null_backend;
+    }
+
+    std::uint64_t calls() noexcept {
+        std::uint64_t total = 0;
+        for (const auto n: g_counts) {
+            total += n;
+        }
+        return total;
+    }
+
+    std::uint64_t calls(std::string_view name) noexcept {
+        for (std::size_t i = 0; i < entry_point_count; ++i) {
+            if (name == g_entries[i].name) {
+                return g_counts[i];
+            }
+        }
+        return 0;
+    }
+
+    std::vector<call_count> counts() noexcept {
+        std::vector<call_count> out;
+        for (std::size_t i = 0; i < entry_point_count; ++i) {
+            if (g_counts[i] != 0) {
+                out.push_back(call_count{.name = g_entries[i].name, .count = g_counts[i]});
+            }
+        }
+        std::sort(out.begin(), out.end(), [](const auto &a, const auto &b) { return a.count > b.count; });
+        return out;
+    }
+
+    void reset() noexcept {
+        g_counts.fill(0);
+        g_trace_head = 0;
+    }
+
+    void set_trace(std::size_t capacity) noexcept {
+        g_trace.assign(capacity, trace_call{});
+        g_trace.shrink_to_fit();
+        g_trace_head = 0;
+    }
+
+    std::string trace_text() noexcept {
+        std::string out;
+        if (g_trace.empty()) {
+            return out;
+        }
+
+        const std::uint64_t n = std::min<std::uint64_t>(g_trace_head, g_trace.size());
+        for (std::uint64_t i = g_trace_head - n; i < g_trace_head; ++i) {
+            const trace_call &c = g_trace[static_cast<std::size_t>(i % g_trace.size())];
+            out += g_entries[c.entry].name;
+            out += '(';
+            g_entries[c.entry].format(out, c);
+            out += ")\n";
+        }
+        return out;
+    }
+
+    bool write_trace(const char *path) noexcept {
+        if (!path) {
+            return false;
+        }
+
+        const std::string text = trace_text();
+        FILE *f = std::fopen(path, "wb");
+        if (!f) {
+            log_error(log_subsystem::profiling, "gl_trace: failed to open '{}'", path);
+            return false;
+        }
+        const bool ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+        if (std::fclose(f) != 0 || !ok) {
+            log_error(log_subsystem::profiling, "gl_trace: failed to write '{}'", path);
+            return false;
+        }
+        return true;
+    }
+
+    namespace detail {
+        void install() noexcept {
+#define SGL_GL_WRAP(name) hook_of<ep_##name, decltype(glad_gl##name)>::wrap(glad_gl##name, glad_gl##name);
+            SGL_GL_ENTRY_POINTS(SGL_GL_WRAP)
+#undef SGL_GL_WRAP
+        }
+    }
+}
+
+#else
+
+#include "internal/sgl_log.h"
+
+namespace sgl::gl_trace {
+    bool use_null_backend() noexcept {
+        log_warn(log_subsystem::profiling, "gl_trace: built without SGL_GL_TRACE, no null backend");
+        return false;
+    }
+
+    bool null_backend() noexcept {
+        return false;
+    }
+
+    std::uint64_t calls() noexcept {
+        return 0;
+    }
+
+    std::uint64_t calls(std::string_view) noexcept {
+        return 0;
+    }
+
+    std::vector<call_count> counts() noexcept {
+        return {};
+    }
+
+    void reset() noexcept {
+    }
+
+    void set_trace(std::size_t) noexcept {
+    }
+
+    std::string trace_text() noexcept {
+        return {};
+    }
+
+    bool write_trace(const char *path) noexcept {
+        log_warn(log_subsystem::profiling, "gl_trace: built without SGL_GL_TRACE, '{}' not written", path ? path : "");
+        return false;
+    }
+
+    namespace detail {
+        void install() noexcept {
+        }
+    }
+}
+
+#endif
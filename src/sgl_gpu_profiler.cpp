@@ -0,0 +1,411 @@
+#include "internal/sgl_gpu_profiler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "glad/glad.h"
+
+#include "internal/sgl_log.h"
+#include "internal/sgl_log_deferred.h"
+#include "internal/sgl_profiler.h"
+
+namespace {
+    constexpr std::size_t query_chunk = 32;
+
+    constexpr std::array<GLenum, 3> stat_targets{
+        GL_VERTICES_SUBMITTED, GL_PRIMITIVES_SUBMITTED, GL_FRAGMENT_SHADER_INVOCATIONS
+    };
+
+    bool has_timer_query() noexcept {
+        return GLAD_GL_VERSION_3_3 || GLAD_GL_ARB_timer_query;
+    }
+
+    bool pipeline_statistics_supported() noexcept {
+        return GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_pipeline_statistics_query;
+    }
+
+    std::uint64_t query_result(GLuint query) noexcept {
+        GLuint64 value = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &value);
+        return value;
+    }
+
+    void add_sample(sgl::gpu_scope_stats &st, double ms) noexcept {
+        ++st.samples;
+        st.last_ms = ms;
+        if (st.samples == 1) {
+            st.min_ms = st.max_ms = st.avg_ms = ms;
+            return;
+        }
+        st.min_ms = std::min(st.min_ms, ms);
+        st.max_ms = std::max(st.max_ms, ms);
+        st.avg_ms += (ms - st.avg_ms) / static_cast<double>(st.samples);
+    }
+
+    void clear_samples(sgl::gpu_scope_stats &st) noexcept {
+        st.samples = 0;
+        st.last_ms = st.min_ms = st.avg_ms = st.max_ms = 0.0;
+        st.vertices = st.primitives = st.fragments = 0;
+    }
+}
+
+namespace sgl {
+    // ctors and assignments
+
+    gpu_profiler::gpu_profiler(gpu_profiler &&other) noexcept : m_params{other.m_params},
+                                                                m_slots{std::move(other.m_slots)},
+                                                                m_current{other.m_current},
+                                                                m_recording{std::exchange(other.m_recording, false)},
+                                                                m_stack{std::move(other.m_stack)},
+                                                                m_keys{std::move(other.m_keys)},
+                                                                m_scopes{std::move(other.m_scopes)},
+                                                                m_frame_sums{std::move(other.m_frame_sums)},
+                                                                m_frame_stats{std::move(other.m_frame_stats)},
+                                                                m_last_events{std::move(other.m_last_events)},
+                                                                m_dropped{other.m_dropped},
+                                                                m_clock_offset_ns{other.m_clock_offset_ns} {
+        other.m_slots.clear();
+    }
+
+    gpu_profiler &gpu_profiler::operator=(gpu_profiler &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        destroy();
+
+        m_params = other.m_params;
+        m_slots = std::move(other.m_slots);
+        m_current = other.m_current;
+        m_recording = std::exchange(other.m_recording, false);
+        m_stack = std::move(other.m_stack);
+        m_keys = std::move(other.m_keys);
+        m_scopes = std::move(other.m_scopes);
+        m_frame_sums = std::move(other.m_frame_sums);
+        m_frame_stats = std::move(other.m_frame_stats);
+        m_last_events = std::move(other.m_last_events);
+        m_dropped = other.m_dropped;
+        m_clock_offset_ns = other.m_clock_offset_ns;
+        other.m_slots.clear();
+
+        return *this;
+    }
+
+    gpu_profiler::~gpu_profiler() {
+        destroy();
+    }
+
+    // fabrics
+
+    gpu_profiler::result gpu_profiler::create(const gpu_profiler_params &params) noexcept {
+        if (params.frame_latency < 2) {
+            return unexpected{error::invalid_params};
+        }
+        if (!has_timer_query()) {
+            return unexpected{error::unsupported};
+        }
+
+        gpu_profiler p{params};
+        if (p.m_params.pipeline_statistics && !pipeline_statistics_supported()) {
+            log_info(log_subsystem::profiling, "gpu_profiler: pipeline statistics queries not supported, timings only");
+            p.m_params.pipeline_statistics = false;
+        }
+
+        p.m_slots.resize(static_cast<std::size_t>(params.frame_latency));
+        p.m_frame_stats.name = "frame";
+        p.sync_clocks();
+
+        for (auto &s: p.m_slots) {
+            s.timestamps.resize(query_chunk);
+            glGenQueries(static_cast<GLsizei>(query_chunk), s.timestamps.data());
+            if (s.timestamps.front() == 0) {
+                log_error(log_subsystem::profiling, "glGenQueries() returned 0");
+                s.timestamps.clear();
+                return unexpected{error::gl_gen_failed};
+            }
+        }
+
+        return p;
+    }
+
+    // try wrappers
+
+    gpu_profiler gpu_profiler::create_try(const gpu_profiler_params &params) noexcept {
+        auto res = create(params);
+        if (!res) {
+            log_fatal("failed to create gpu_profiler: {}", err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
+    // api
+
+    void gpu_profiler::new_frame() noexcept {
+        if (m_slots.empty()) {
+            return;
+        }
+
+        if (!m_stack.empty()) {
+            SGL_DLOG_WARN(log_subsystem::profiling,
+                          "gpu_profiler::new_frame: {} scope(s) still open, closing them", m_stack.size());
+            while (!m_stack.empty()) {
+                pop();
+            }
+        }
+
+        if (m_recording) {
+            frame_slot &s = m_slots[m_current];
+            timestamp(s, s.frame_end);
+            s.pending = true;
+        }
+
+        m_current = (m_current + 1) % m_slots.size();
+
+        // oldest first (the slot about to be reused), queries finish in submission order
+        for (std::size_t i = 0; i < m_slots.size(); ++i) {
+            frame_slot &s = m_slots[(m_current + i) % m_slots.size()];
+            if (s.pending && !resolve(s)) {
+                break;
+            }
+        }
+
+        frame_slot &s = m_slots[m_current];
+        if (s.pending) {
+            // the GPU is more than frame_latency frames behind: skip rather than wait
+            m_recording = false;
+            ++m_dropped;
+            return;
+        }
+
+        s.used_timestamps = 0;
+        s.used_stats = 0;
+        s.records.clear();
+        s.frame_end = npos;
+        m_recording = timestamp(s, s.frame_begin);
+    }
+
+    void gpu_profiler::push(const char *name) noexcept {
+        if (!m_recording || !name) {
+            m_stack.push_back(npos);
+            return;
+        }
+
+        frame_slot &s = m_slots[m_current];
+        record r{.scope = scope_index(name), .begin = 0, .end = npos, .stats = npos,
+                 .depth = static_cast<int>(m_stack.size())};
+
+        if (!timestamp(s, r.begin)) {
+            m_stack.push_back(npos);
+            return;
+        }
+
+        // one query per target may be active: outermost scopes only
+        if (m_params.pipeline_statistics && m_stack.empty()) {
+            if (s.used_stats == s.stats.size()) {
+                auto &ids = s.stats.emplace_back();
+                glGenQueries(static_cast<GLsizei>(stat_count), ids.data());
+            }
+            r.stats = s.used_stats++;
+            for (std::size_t i = 0; i < stat_count; ++i) {
+                glBeginQuery(stat_targets[i], s.stats[r.stats][i]);
+            }
+        }
+
+        s.records.push_back(r);
+        m_stack.push_back(s.records.size() - 1);
+    }
+
+    void gpu_profiler::pop() noexcept {
+        if (m_stack.empty()) {
+            log_error(log_subsystem::profiling, "gpu_profiler::pop: no open scope");
+            return;
+        }
+
+        const std::size_t index = m_stack.back();
+        m_stack.pop_back();
+        if (index == npos) {
+            return;
+        }
+
+        frame_slot &s = m_slots[m_current];
+        record &r = s.records[index];
+        if (r.stats != npos) {
+            for (const GLenum target: stat_targets) {
+                glEndQuery(target);
+            }
+        }
+        timestamp(s, r.end);
+    }
+
+    const gpu_scope_stats *gpu_profiler::find(std::string_view name) const noexcept {
+        const auto it = std::find_if(m_scopes.begin(), m_scopes.end(), [name](const gpu_scope_stats &st) {
+            return st.name == name;
+        });
+        return it == m_scopes.end() || it->samples == 0 ? nullptr : &*it;
+    }
+
+    void gpu_profiler::reset() noexcept {
+        for (auto &st: m_scopes) {
+            clear_samples(st);
+        }
+        clear_samples(m_frame_stats);
+        m_dropped = 0;
+        sync_clocks();
+    }
+
+    void gpu_profiler::log_report() const noexcept {
+        std::vector<const gpu_scope_stats *> sorted;
+        sorted.reserve(m_scopes.size());
+        for (const auto &st: m_scopes) {
+            if (st.samples > 0) {
+                sorted.push_back(&st);
+            }
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const auto *a, const auto *b) { return a->avg_ms > b->avg_ms; });
+
+        log_info(log_subsystem::profiling,
+                 "gpu_profiler: frame avg {:.3f} ms, min {:.3f}, max {:.3f} ({} frames, {} dropped)",
+                 m_frame_stats.avg_ms, m_frame_stats.min_ms, m_frame_stats.max_ms, m_frame_stats.samples, m_dropped);
+        for (const auto *st: sorted) {
+            if (m_params.pipeline_statistics) {
+                log_info(log_subsystem::profiling,
+                         "  {:<24} avg {:.3f} ms, min {:.3f}, max {:.3f} | {} verts, {} prims, {} frags",
+                         st->name, st->avg_ms, st->min_ms, st->max_ms, st->vertices, st->primitives, st->fragments);
+            } else {
+                log_info(log_subsystem::profiling, "  {:<24} avg {:.3f} ms, min {:.3f}, max {:.3f}",
+                         st->name, st->avg_ms, st->min_ms, st->max_ms);
+            }
+        }
+    }
+
+    // internal
+
+    std::size_t gpu_profiler::scope_index(const char *name) noexcept {
+        for (std::size_t i = 0; i < m_keys.size(); ++i) {
+            if (m_keys[i] == name || m_scopes[i].name == name) {
+                return i;
+            }
+        }
+
+        m_keys.push_back(name);
+        gpu_scope_stats st;
+        st.name = name;
+        m_scopes.push_back(std::move(st));
+        return m_keys.size() - 1;
+    }
+
+    bool gpu_profiler::timestamp(frame_slot &s, std::size_t &index) noexcept {
+        if (s.used_timestamps == s.timestamps.size()) {
+            const std::size_t old_size = s.timestamps.size();
+            s.timestamps.resize(old_size + query_chunk);
+            glGenQueries(static_cast<GLsizei>(query_chunk), s.timestamps.data() + old_size);
+            if (s.timestamps[old_size] == 0) {
+                log_error(log_subsystem::profiling, "glGenQueries() returned 0");
+                s.timestamps.resize(old_size);
+                return false;
+            }
+        }
+
+        index = s.used_timestamps++;
+        glQueryCounter(s.timestamps[index], GL_TIMESTAMP);
+        return true;
+    }
+
+    bool gpu_profiler::resolve(frame_slot &s) noexcept {
+        if (s.frame_end == npos) {
+            s.pending = false;
+            return true;
+        }
+
+        // the frame's last timestamp: once it is there every earlier one is too
+        GLint available = 0;
+        glGetQueryObjectiv(s.timestamps[s.frame_end], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return false;
+        }
+
+        // statistics queries aren't ordered with the timestamps: reading one early would block
+        for (std::size_t i = 0; i < s.used_stats; ++i) {
+            for (const auto id: s.stats[i]) {
+                glGetQueryObjectiv(id, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available) {
+                    return false;
+                }
+            }
+        }
+
+        constexpr double ns_to_ms = 1e-6;
+
+        m_frame_sums.assign(m_scopes.size(), -1.0);
+        m_last_events.clear();
+
+        for (const auto &r: s.records) {
+            if (r.end == npos) {
+                continue;
+            }
+
+            const std::uint64_t begin = query_result(s.timestamps[r.begin]);
+            const std::uint64_t end = std::max(begin, query_result(s.timestamps[r.end]));
+
+            gpu_scope_stats &st = m_scopes[r.scope];
+            double &sum = m_frame_sums[r.scope];
+            if (sum < 0.0) {
+                sum = 0.0;
+                st.vertices = st.primitives = st.fragments = 0;
+            }
+            sum += static_cast<double>(end - begin) * ns_to_ms;
+
+            if (r.stats != npos) {
+                const auto &ids = s.stats[r.stats];
+                st.vertices += query_result(ids[0]);
+                st.primitives += query_result(ids[1]);
+                st.fragments += query_result(ids[2]);
+            }
+
+            m_last_events.push_back(gpu_timing_event{
+                .name = m_keys[r.scope], .begin_ns = begin, .end_ns = end, .depth = r.depth
+            });
+            if constexpr (SGL_PROFILER) {
+                detail::profiler_record(m_keys[r.scope], to_cpu_ns(begin), to_cpu_ns(end),
+                                        static_cast<std::uint32_t>(r.depth + 1), true);
+            }
+        }
+
+        for (std::size_t i = 0; i < m_frame_sums.size(); ++i) {
+            if (m_frame_sums[i] >= 0.0) {
+                add_sample(m_scopes[i], m_frame_sums[i]);
+            }
+        }
+
+        const std::uint64_t frame_begin = query_result(s.timestamps[s.frame_begin]);
+        const std::uint64_t frame_end = std::max(frame_begin, query_result(s.timestamps[s.frame_end]));
+        add_sample(m_frame_stats, static_cast<double>(frame_end - frame_begin) * ns_to_ms);
+        if constexpr (SGL_PROFILER) {
+            detail::profiler_record("gpu frame", to_cpu_ns(frame_begin), to_cpu_ns(frame_end), 0, true);
+        }
+
+        s.pending = false;
+        return true;
+    }
+
+    void gpu_profiler::sync_clocks() noexcept {
+        // glGet waits for the GL server, not for the GPU to drain
+        GLint64 gpu_ns = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpu_ns);
+        m_clock_offset_ns = static_cast<std::int64_t>(profiler_now_ns()) - gpu_ns;
+    }
+
+    void gpu_profiler::destroy() noexcept {
+        for (auto &s: m_slots) {
+            if (!s.timestamps.empty()) {
+                glDeleteQueries(static_cast<GLsizei>(s.timestamps.size()), s.timestamps.data());
+            }
+            for (auto &ids: s.stats) {
+                glDeleteQueries(static_cast<GLsizei>(stat_count), ids.data());
+            }
+        }
+        m_slots.clear();
+        m_stack.clear();
+        m_recording = false;
+    }
+}
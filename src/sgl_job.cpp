@@ -0,0 +1,88 @@
+#include "internal/sgl_job.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "internal/sgl_profiler.h"
+
+namespace sgl::detail {
+    namespace {
+        class job_pool {
+        public:
+            explicit job_pool(std::size_t count) {
+                m_workers.reserve(count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    m_workers.emplace_back([this](std::stop_token st) { run(st); });
+                }
+            }
+
+            job_pool(const job_pool &) = delete;
+
+            job_pool &operator=(const job_pool &) = delete;
+
+            ~job_pool() {
+                for (auto &w: m_workers) {
+                    w.request_stop();
+                }
+                m_cv.notify_all();
+                // jthread joins on destruction
+            }
+
+            void push(std::function<void()> job) {
+                {
+                    std::lock_guard lock{m_mutex};
+                    m_jobs.push_back(std::move(job));
+                }
+                m_cv.notify_one();
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept { return m_workers.size(); }
+
+        private:
+            void run(const std::stop_token &st) {
+                profiler_set_thread_name("sgl worker");
+
+                while (true) {
+                    std::function<void()> job;
+                    {
+                        std::unique_lock lock{m_mutex};
+                        m_cv.wait(lock, st, [this] { return !m_jobs.empty(); });
+                        if (m_jobs.empty()) {
+                            return; // stop requested
+                        }
+                        job = std::move(m_jobs.front());
+                        m_jobs.pop_front();
+                    }
+                    SGL_ZONE("job");
+                    job();
+                }
+            }
+
+            std::mutex m_mutex;
+            std::condition_variable_any m_cv;
+            std::deque<std::function<void()> > m_jobs;
+            std::vector<std::jthread> m_workers;
+        };
+
+        job_pool &pool() {
+            // leave one core for the GL thread
+            const unsigned hw = std::thread::hardware_concurrency();
+            static job_pool p{hw > 1 ? hw - 1 : 1};
+            return p;
+        }
+    }
+
+    void submit_job(std::function<void()> job) noexcept {
+        if (!job) {
+            return;
+        }
+        pool().push(std::move(job));
+    }
+
+    std::size_t worker_count() noexcept {
+        return pool().size();
+    }
+}
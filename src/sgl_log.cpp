@@ -1,11 +1,317 @@
 #include "internal/sgl_log.h"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "internal/sgl_log_deferred.h"
+
+namespace {
+    using sgl::log_level;
+    using sgl::log_subsystem;
+    using sgl::detail::log_site;
+
+    enum class record_kind : std::uint8_t {
+        text = 0,
+        deferred, // text holds the site's arguments, unformatted
+        summary // suppressed records of a site, no text
+    };
+
+    struct record_head {
+        record_kind kind = record_kind::text;
+        log_level level = log_level::info;
+        log_subsystem subsystem = log_subsystem::general;
+        const log_site *site = nullptr;
+        std::uint64_t suppressed = 0;
+    };
+
+    struct log_record {
+        std::atomic<std::uint64_t> sequence{0};
+        record_head head;
+        bool truncated = false;
+        std::uint32_t size = 0;
+        char text[sgl::log_max_message];
+    };
+
+    sgl::detail::log_site_view view_of(const log_site &site) noexcept {
+        return {site.level, site.subsystem, site.format, site.file, site.line, site.types, site.arg_count};
+    }
+
+    template<typename T>
+    void put(FILE *f, const T &v) noexcept {
+        std::fwrite(&v, sizeof(T), 1, f);
+    }
+
+    void put_string(FILE *f, std::string_view s) noexcept {
+        const auto n = static_cast<std::uint16_t>(std::min<std::size_t>(s.size(), UINT16_MAX));
+        put(f, n);
+        std::fwrite(s.data(), 1, n, f);
+    }
+
+    // bounded MPSC queue (Vyukov): a producer claims a position with a CAS and publishes the slot through its
+    // sequence, the writer thread consumes in order. never blocks a producer
+    class async_logger {
+    public:
+        async_logger() {
+            for (std::size_t i = 0; i < sgl::log_ring_size; ++i) {
+                m_ring[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            std::thread{[this] { run(); }}.detach();
+        }
+
+        bool push(const record_head &head, const char *text, std::size_t size) noexcept {
+            std::uint64_t pos = m_enqueue.load(std::memory_order_relaxed);
+            log_record *r = nullptr;
+            for (;;) {
+                r = &m_ring[pos & (sgl::log_ring_size - 1)];
+                const std::uint64_t seq = r->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::int64_t>(seq - pos);
+                if (diff == 0) {
+                    if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                } else {
+                    pos = m_enqueue.load(std::memory_order_relaxed);
+                }
+            }
+
+            r->head = head;
+            r->truncated = size > sgl::log_max_message;
+            r->size = static_cast<std::uint32_t>(std::min(size, sgl::log_max_message));
+            if (r->size) {
+                std::memcpy(r->text, text, r->size);
+            }
+            r->sequence.store(pos + 1, std::memory_order_release);
+
+            m_signal.fetch_add(1, std::memory_order_release);
+            m_signal.notify_one();
+            return true;
+        }
+
+        void flush() noexcept {
+            const std::uint64_t target = m_enqueue.load(std::memory_order_acquire);
+            std::uint64_t written = m_written.load(std::memory_order_acquire);
+            while (written < target) {
+                m_written.wait(written, std::memory_order_acquire);
+                written = m_written.load(std::memory_order_acquire);
+            }
+        }
+
+        [[nodiscard]] std::uint64_t dropped() const noexcept {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+        bool set_binary(const char *path) noexcept {
+            // what was logged before goes where it was meant to
+            flush();
+
+            FILE *f = nullptr;
+            if (path) {
+                f = std::fopen(path, "wb");
+                if (!f) {
+                    return false;
+                }
+                std::fwrite(sgl::detail::log_binary_magic, 1, sizeof(sgl::detail::log_binary_magic), f);
+            }
+
+            std::lock_guard lock{m_out_mutex};
+            if (m_binary) {
+                std::fclose(m_binary);
+            }
+            m_binary = f;
+            m_site_ids.clear();
+            return true;
+        }
+
+    private:
+        void run() noexcept {
+            std::uint64_t reported_dropped = 0;
+            for (;;) {
+                const std::uint32_t signal = m_signal.load(std::memory_order_acquire);
+
+                bool wrote = false;
+                {
+                    std::lock_guard lock{m_out_mutex};
+
+                    // at most a ring per batch so flush() waiters get through under constant logging
+                    for (std::size_t n = 0; n < sgl::log_ring_size && pop(); ++n) {
+                        wrote = true;
+                    }
+
+                    if (const std::uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+                        dropped != reported_dropped) {
+                        char buf[64];
+                        const auto res = fmt::format_to_n(buf, sizeof(buf), "log: {} records dropped (ring full)",
+                                                          dropped - reported_dropped);
+                        write_text(log_level::warn, log_subsystem::general, buf, res.out - buf, false);
+                        reported_dropped = dropped;
+                        wrote = true;
+                    }
+
+                    if (wrote && m_binary) {
+                        std::fflush(m_binary);
+                    }
+                }
+
+                if (wrote) {
+                    std::fflush(stdout);
+                    std::fflush(stderr);
+                    m_written.store(m_dequeue, std::memory_order_release);
+                    m_written.notify_all();
+                }
+
+                m_signal.wait(signal, std::memory_order_acquire);
+            }
+        }
+
+        bool pop() noexcept {
+            log_record &r = m_ring[m_dequeue & (sgl::log_ring_size - 1)];
+            if (r.sequence.load(std::memory_order_acquire) != m_dequeue + 1) {
+                return false;
+            }
+
+            write(r);
+            r.sequence.store(m_dequeue + sgl::log_ring_size, std::memory_order_release);
+            ++m_dequeue;
+            return true;
+        }
+
+        void write(const log_record &r) noexcept {
+            const record_head &h = r.head;
+            switch (h.kind) {
+                case record_kind::text:
+                    write_text(h.level, h.subsystem, r.text, r.size, r.truncated);
+                    break;
+                case record_kind::deferred:
+                    if (m_binary) {
+                        const std::uint32_t id = site_id(*h.site);
+                        put(m_binary, sgl::detail::log_chunk::record);
+                        put(m_binary, id);
+                        put(m_binary, h.suppressed);
+                        put_string(m_binary, {r.text, r.size});
+                    } else {
+                        sgl::detail::log_write_record(sgl::detail::stream_for(h.level), view_of(*h.site),
+                                                      h.suppressed, r.text, r.size, m_scratch);
+                    }
+                    break;
+                case record_kind::summary:
+                    if (m_binary) {
+                        const std::uint32_t id = site_id(*h.site);
+                        put(m_binary, sgl::detail::log_chunk::summary);
+                        put(m_binary, id);
+                        put(m_binary, h.suppressed);
+                    } else {
+                        sgl::detail::log_write_summary(sgl::detail::stream_for(h.level), view_of(*h.site),
+                                                       h.suppressed);
+                    }
+                    break;
+            }
+        }
+
+        void write_text(log_level level, log_subsystem subsystem, const char *text, std::size_t size,
+                        bool truncated) noexcept {
+            if (m_binary) {
+                put(m_binary, sgl::detail::log_chunk::text);
+                put(m_binary, static_cast<std::uint8_t>(level));
+                put(m_binary, static_cast<std::uint8_t>(subsystem));
+                put(m_binary, static_cast<std::uint8_t>(truncated));
+                put_string(m_binary, {text, size});
+                return;
+            }
+
+            FILE *out = sgl::detail::stream_for(level);
+            sgl::detail::log_write_prefix(out, level, subsystem);
+            std::fwrite(text, 1, size, out);
+            std::fputs(truncated ? "...\n" : "\n", out);
+        }
+
+        // the site's chunk goes out the first time a file sees it
+        std::uint32_t site_id(const log_site &site) noexcept {
+            const auto [it, inserted] = m_site_ids.try_emplace(&site, static_cast<std::uint32_t>(m_site_ids.size()));
+            if (inserted) {
+                put(m_binary, sgl::detail::log_chunk::site);
+                put(m_binary, it->second);
+                put(m_binary, static_cast<std::uint8_t>(site.level));
+                put(m_binary, static_cast<std::uint8_t>(site.subsystem));
+                put(m_binary, static_cast<std::uint32_t>(site.line));
+                put_string(m_binary, site.file);
+                put_string(m_binary, site.format);
+                put(m_binary, static_cast<std::uint8_t>(site.arg_count));
+                std::fwrite(site.types, sizeof(sgl::log_arg_type), site.arg_count, m_binary);
+            }
+            return it->second;
+        }
+
+        std::array<log_record, sgl::log_ring_size> m_ring;
+        alignas(64) std::atomic<std::uint64_t> m_enqueue{0};
+        alignas(64) std::atomic<std::uint32_t> m_signal{0};
+        alignas(64) std::atomic<std::uint64_t> m_written{0}; // records written, for flush()
+        std::atomic<std::uint64_t> m_dropped{0};
+        std::uint64_t m_dequeue = 0; // writer thread only
+        std::string m_scratch; // writer thread only
+
+        std::mutex m_out_mutex; // output below, swapped by set_binary()
+        FILE *m_binary = nullptr;
+        std::unordered_map<const log_site *, std::uint32_t> m_site_ids; // sites written to m_binary
+    };
+
+    // never destroyed: logging from static destructors and other threads at exit keeps working
+    async_logger &logger() noexcept {
+        static async_logger *l = [] {
+            auto *created = new async_logger;
+            std::atexit([] { sgl::log_flush(); });
+            return created;
+        }();
+        return *l;
+    }
+}
+
+namespace sgl {
+    void set_log_level(log_level min_level) noexcept {
+        detail::g_log_min_level.store(static_cast<int>(min_level), std::memory_order_relaxed);
+    }
+
+    void set_log_enabled(log_subsystem subsystem, bool enabled) noexcept {
+        const std::uint32_t bit = 1u << static_cast<unsigned>(subsystem);
+        if (enabled) {
+            detail::g_log_subsystems.fetch_or(bit, std::memory_order_relaxed);
+        } else {
+            detail::g_log_subsystems.fetch_and(~bit, std::memory_order_relaxed);
+        }
+    }
+
+    bool log_enabled(log_subsystem subsystem) noexcept {
+        return (detail::g_log_subsystems.load(std::memory_order_relaxed) >> static_cast<unsigned>(subsystem)) & 1u;
+    }
+
+    void log_flush() noexcept {
+        detail::log_submit_summaries();
+        logger().flush();
+    }
+
+    std::uint64_t log_dropped() noexcept {
+        return logger().dropped();
+    }
+
+    bool set_log_binary(const char *path) noexcept {
+        if (!logger().set_binary(path)) {
+            log_error("set_log_binary: could not open {}", path);
+            return false;
+        }
+        return true;
+    }
+}
 
 namespace sgl::detail {
     const char *level_name(log_level level) noexcept {
         static constexpr std::array<const char *, static_cast<std::size_t>(log_level::count)> names{
+            "DEBUG",
             "INFO",
             "WARNING",
             "ERROR",
@@ -15,8 +321,24 @@ namespace sgl::detail {
         return names[static_cast<std::size_t>(level)];
     }
 
+    const char *subsystem_name(log_subsystem subsystem) noexcept {
+        static constexpr std::array<const char *, static_cast<std::size_t>(log_subsystem::count)> names{
+            "general",
+            "window",
+            "shader",
+            "texture",
+            "buffer",
+            "framebuffer",
+            "assets",
+            "profiling"
+        };
+        static_assert(names.size() == static_cast<std::size_t>(log_subsystem::count));
+        return names[static_cast<std::size_t>(subsystem)];
+    }
+
     FILE *stream_for(log_level level) noexcept {
         switch (level) {
+            case log_level::debug:
             case log_level::info:
             case log_level::warn:
                 return stdout;
@@ -26,4 +348,35 @@ namespace sgl::detail {
                 return stderr;
         }
     }
+
+    void log_write_prefix(FILE *out, log_level level, log_subsystem subsystem) noexcept {
+        if (subsystem == log_subsystem::general) {
+            fmt::print(out, "[{}]: ", level_name(level));
+        } else {
+            fmt::print(out, "[{}][{}]: ", level_name(level), subsystem_name(subsystem));
+        }
+    }
+
+    void log_submit(log_level level, log_subsystem subsystem, const char *text, std::size_t size) noexcept {
+        logger().push({record_kind::text, level, subsystem}, text, size);
+    }
+
+    void log_submit_deferred(const log_site &site, std::uint64_t suppressed, const char *payload,
+                             std::size_t size) noexcept {
+        logger().push({record_kind::deferred, site.level, site.subsystem, &site, suppressed}, payload, size);
+    }
+
+    void log_submit_summary(const log_site &site, std::uint64_t suppressed) noexcept {
+        logger().push({record_kind::summary, site.level, site.subsystem, &site, suppressed}, "", 0);
+    }
+
+    void log_fatal_submit(const char *text, std::size_t size) noexcept {
+        // everything logged before goes out first
+        logger().flush();
+
+        std::fprintf(stderr, "[%s]: %.*s%s\n", level_name(log_level::fatal),
+                     static_cast<int>(std::min(size, log_max_message)), text, size > log_max_message ? "..." : "");
+        std::fflush(stderr);
+        std::abort();
+    }
 }
@@ -0,0 +1,318 @@
+#include "internal/sgl_log_deferred.h"
+
+#include <chrono>
+#include <iterator>
+#include <vector>
+
+#include "fmt/args.h"
+#include "fmt/format.h"
+
+namespace {
+    using sgl::log_arg_type;
+    using sgl::detail::log_site;
+    using sgl::detail::log_site_view;
+
+    std::atomic<std::uint64_t> g_rate_interval_ns{1'000'000'000};
+
+    // sites that suppressed something, pushed once and never removed (they are statics)
+    std::atomic<log_site *> g_listed_sites{nullptr};
+
+    template<typename T>
+    T read_raw(const char *p) noexcept {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        return v;
+    }
+
+    // false when the payload doesn't match the types
+    bool push_args(fmt::dynamic_format_arg_store<fmt::format_context> &store, const log_arg_type *types,
+                   std::size_t count, const char *payload, std::size_t size) {
+        std::size_t pos = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (pos + sgl::detail::log_arg_size(types[i]) > size) {
+                return false;
+            }
+
+            const char *p = payload + pos;
+            pos += sgl::detail::log_arg_size(types[i]);
+            switch (types[i]) {
+                case log_arg_type::i64:
+                    store.push_back(read_raw<std::int64_t>(p));
+                    break;
+                case log_arg_type::u64:
+                    store.push_back(read_raw<std::uint64_t>(p));
+                    break;
+                case log_arg_type::f32:
+                    store.push_back(read_raw<float>(p));
+                    break;
+                case log_arg_type::f64:
+                    store.push_back(read_raw<double>(p));
+                    break;
+                case log_arg_type::boolean:
+                    store.push_back(read_raw<std::uint8_t>(p) != 0);
+                    break;
+                case log_arg_type::character:
+                    store.push_back(read_raw<char>(p));
+                    break;
+                case log_arg_type::pointer:
+                    store.push_back(reinterpret_cast<const void *>(
+                        static_cast<std::uintptr_t>(read_raw<std::uint64_t>(p))));
+                    break;
+                case log_arg_type::string: {
+                    const std::size_t n = read_raw<std::uint16_t>(p);
+                    if (pos + n > size) {
+                        return false;
+                    }
+                    store.push_back(fmt::string_view{payload + pos, n});
+                    pos += n;
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return pos == size;
+    }
+
+    std::string_view base_name(std::string_view path) noexcept {
+        const std::size_t slash = path.find_last_of("/\\");
+        return slash == std::string_view::npos ? path : path.substr(slash + 1);
+    }
+
+    // bounds checked reads over a binary log
+    class chunk_reader {
+    public:
+        chunk_reader(const char *data, std::size_t size) noexcept : m_data(data), m_size(size) {}
+
+        template<typename T>
+        bool get(T &v) noexcept {
+            if (m_size - m_pos < sizeof(T)) {
+                return false;
+            }
+            v = read_raw<T>(m_data + m_pos);
+            m_pos += sizeof(T);
+            return true;
+        }
+
+        bool get(std::string_view &s) noexcept {
+            std::uint16_t n = 0;
+            if (!get(n) || m_size - m_pos < n) {
+                return false;
+            }
+            s = {m_data + m_pos, n};
+            m_pos += n;
+            return true;
+        }
+
+        [[nodiscard]] bool done() const noexcept { return m_pos == m_size; }
+
+        [[nodiscard]] std::size_t pos() const noexcept { return m_pos; }
+
+    private:
+        const char *m_data;
+        std::size_t m_size;
+        std::size_t m_pos = 0;
+    };
+
+    // a site read back from a file, the views point into the file's bytes
+    struct decoded_site {
+        log_site_view view;
+        std::vector<log_arg_type> types;
+    };
+
+    bool decode_chunks(chunk_reader &in, std::FILE *out) noexcept {
+        std::vector<decoded_site> sites;
+        std::string scratch;
+
+        const auto site_at = [&sites](std::uint32_t id) -> const decoded_site * {
+            return id < sites.size() ? &sites[id] : nullptr;
+        };
+
+        while (!in.done()) {
+            sgl::detail::log_chunk tag{};
+            if (!in.get(tag)) {
+                return false;
+            }
+
+            switch (tag) {
+                case sgl::detail::log_chunk::site: {
+                    std::uint32_t id = 0, line = 0;
+                    std::uint8_t level = 0, subsystem = 0, count = 0;
+                    std::string_view file, format;
+                    if (!in.get(id) || !in.get(level) || !in.get(subsystem) || !in.get(line) || !in.get(file) ||
+                        !in.get(format) || !in.get(count) || id != sites.size() ||
+                        level >= static_cast<std::uint8_t>(sgl::log_level::count) ||
+                        subsystem >= static_cast<std::uint8_t>(sgl::log_subsystem::count)) {
+                        return false;
+                    }
+
+                    decoded_site &site = sites.emplace_back();
+                    site.types.resize(count);
+                    for (log_arg_type &t: site.types) {
+                        if (!in.get(t) || t >= log_arg_type::count) {
+                            return false;
+                        }
+                    }
+                    site.view = {static_cast<sgl::log_level>(level), static_cast<sgl::log_subsystem>(subsystem),
+                                 format, file, static_cast<int>(line), site.types.data(), count};
+                    break;
+                }
+                case sgl::detail::log_chunk::record: {
+                    std::uint32_t id = 0;
+                    std::uint64_t suppressed = 0;
+                    std::string_view payload;
+                    if (!in.get(id) || !in.get(suppressed) || !in.get(payload)) {
+                        return false;
+                    }
+                    const decoded_site *site = site_at(id);
+                    if (!site) {
+                        return false;
+                    }
+                    sgl::detail::log_write_record(out, site->view, suppressed, payload.data(), payload.size(),
+                                                  scratch);
+                    break;
+                }
+                case sgl::detail::log_chunk::summary: {
+                    std::uint32_t id = 0;
+                    std::uint64_t suppressed = 0;
+                    if (!in.get(id) || !in.get(suppressed)) {
+                        return false;
+                    }
+                    const decoded_site *site = site_at(id);
+                    if (!site) {
+                        return false;
+                    }
+                    sgl::detail::log_write_summary(out, site->view, suppressed);
+                    break;
+                }
+                case sgl::detail::log_chunk::text: {
+                    std::uint8_t level = 0, subsystem = 0, truncated = 0;
+                    std::string_view text;
+                    if (!in.get(level) || !in.get(subsystem) || !in.get(truncated) || !in.get(text) ||
+                        level >= static_cast<std::uint8_t>(sgl::log_level::count) ||
+                        subsystem >= static_cast<std::uint8_t>(sgl::log_subsystem::count)) {
+                        return false;
+                    }
+                    sgl::detail::log_write_prefix(out, static_cast<sgl::log_level>(level),
+                                                  static_cast<sgl::log_subsystem>(subsystem));
+                    std::fwrite(text.data(), 1, text.size(), out);
+                    std::fputs(truncated ? "...\n" : "\n", out);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace sgl {
+    void set_log_rate_limit(std::uint32_t per_interval, double interval_sec) noexcept {
+        const double ns = std::max(interval_sec, 0.001) * 1e9;
+        g_rate_interval_ns.store(static_cast<std::uint64_t>(ns), std::memory_order_relaxed);
+        detail::g_log_rate_limit.store(per_interval, std::memory_order_relaxed);
+    }
+
+    bool decode_log(const char *path, std::FILE *out) noexcept {
+        assert(path && out);
+
+        FILE *f = std::fopen(path, "rb");
+        if (!f) {
+            log_error("decode_log: could not open {}", path);
+            return false;
+        }
+
+        std::vector<char> data;
+        char buf[64 * 1024];
+        for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), f)) > 0;) {
+            data.insert(data.end(), buf, buf + n);
+        }
+        std::fclose(f);
+
+        constexpr std::size_t magic_size = sizeof(detail::log_binary_magic);
+        if (data.size() < magic_size || std::memcmp(data.data(), detail::log_binary_magic, magic_size) != 0) {
+            log_error("decode_log: {} is not a binary log", path);
+            return false;
+        }
+
+        chunk_reader in{data.data() + magic_size, data.size() - magic_size};
+        if (!decode_chunks(in, out)) {
+            log_error("decode_log: {} is corrupt at byte {}", path, magic_size + in.pos());
+            return false;
+        }
+        return true;
+    }
+}
+
+namespace sgl::detail {
+    bool log_rate_check(log_site &site) noexcept {
+        const std::uint32_t limit = g_log_rate_limit.load(std::memory_order_relaxed);
+        if (limit == 0) {
+            return true;
+        }
+
+        const auto now = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+
+        // racing threads may both see a window end, one of them restarts it
+        std::uint64_t start = site.window_start_ns.load(std::memory_order_relaxed);
+        if (now - start >= g_rate_interval_ns.load(std::memory_order_relaxed) &&
+            site.window_start_ns.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            site.window_count.store(0, std::memory_order_relaxed);
+        }
+
+        if (site.window_count.fetch_add(1, std::memory_order_relaxed) < limit) {
+            return true;
+        }
+
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        if (!site.listed.load(std::memory_order_relaxed) && !site.listed.exchange(true, std::memory_order_relaxed)) {
+            site.next = g_listed_sites.load(std::memory_order_relaxed);
+            while (!g_listed_sites.compare_exchange_weak(site.next, &site, std::memory_order_release,
+                                                         std::memory_order_relaxed)) {
+            }
+        }
+        return false;
+    }
+
+    void log_submit_summaries() noexcept {
+        for (log_site *site = g_listed_sites.load(std::memory_order_acquire); site; site = site->next) {
+            if (site->suppressed.load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            if (const std::uint64_t n = site->suppressed.exchange(0, std::memory_order_relaxed)) {
+                log_submit_summary(*site, n);
+            }
+        }
+    }
+
+    void log_write_record(std::FILE *out, const log_site_view &site, std::uint64_t suppressed,
+                          const char *payload, std::size_t size, std::string &scratch) noexcept {
+        scratch.clear();
+        try {
+            fmt::dynamic_format_arg_store<fmt::format_context> store;
+            if (push_args(store, site.types, site.arg_count, payload, size)) {
+                fmt::vformat_to(std::back_inserter(scratch), fmt::string_view{site.format.data(), site.format.size()},
+                                store);
+            } else {
+                scratch = "[LOG]: record doesn't match its call site";
+            }
+        } catch (...) {
+            scratch = "[LOG]: formatting failed";
+        }
+
+        log_write_prefix(out, site.level, site.subsystem);
+        std::fwrite(scratch.data(), 1, scratch.size(), out);
+        if (suppressed) {
+            fmt::print(out, " (suppressed {} before)", suppressed);
+        }
+        std::fputc('\n', out);
+    }
+
+    void log_write_summary(std::FILE *out, const log_site_view &site, std::uint64_t suppressed) noexcept {
+        log_write_prefix(out, site.level, site.subsystem);
+        fmt::println(out, "suppressed {} more of \"{}\" ({}:{})", suppressed, site.format, base_name(site.file),
+                     site.line);
+    }
+}
@@ -0,0 +1,195 @@
+#include "internal/sgl_lz4.h"
+
+#include <cstring>
+#include <memory>
+
+namespace {
+    constexpr std::size_t min_match = 4;
+    constexpr std::size_t last_literals = 5; // the block always ends with at least 5 literals
+    constexpr std::size_t mf_limit = 12; // and no match starts in its last 12 bytes
+    constexpr std::size_t max_offset = 65535;
+    constexpr int hash_log = 16;
+
+    std::uint32_t read_u32(const std::uint8_t *p) noexcept {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    std::uint32_t hash4(std::uint32_t v) noexcept {
+        return (v * 2654435761u) >> (32 - hash_log);
+    }
+
+    void put_length(std::vector<std::uint8_t> &out, std::size_t len) {
+        while (len >= 255) {
+            out.push_back(255);
+            len -= 255;
+        }
+        out.push_back(static_cast<std::uint8_t>(len));
+    }
+
+    void put_sequence(
+        std::vector<std::uint8_t> &out, const std::uint8_t *literals, std::size_t lit_len, std::size_t offset,
+        std::size_t match_len
+    ) {
+        const std::size_t ml = match_len - min_match;
+        const auto lit_nibble = static_cast<std::uint8_t>(lit_len < 15 ? lit_len : 15);
+        const auto ml_nibble = static_cast<std::uint8_t>(ml < 15 ? ml : 15);
+        out.push_back(static_cast<std::uint8_t>(lit_nibble << 4 | ml_nibble));
+
+        if (lit_len >= 15) {
+            put_length(out, lit_len - 15);
+        }
+        out.insert(out.end(), literals, literals + lit_len);
+
+        out.push_back(static_cast<std::uint8_t>(offset));
+        out.push_back(static_cast<std::uint8_t>(offset >> 8));
+
+        if (ml >= 15) {
+            put_length(out, ml - 15);
+        }
+    }
+
+    void put_last_literals(std::vector<std::uint8_t> &out, const std::uint8_t *literals, std::size_t lit_len) {
+        out.push_back(static_cast<std::uint8_t>((lit_len < 15 ? lit_len : 15) << 4));
+        if (lit_len >= 15) {
+            put_length(out, lit_len - 15);
+        }
+        out.insert(out.end(), literals, literals + lit_len);
+    }
+
+    // false if the length runs off the input
+    bool get_length(const std::uint8_t *&ip, const std::uint8_t *end, std::size_t &len) noexcept {
+        std::uint8_t b;
+        do {
+            if (ip >= end) {
+                return false;
+            }
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return true;
+    }
+}
+
+namespace sgl {
+    void lz4_compress(const std::uint8_t *src, std::size_t size, std::vector<std::uint8_t> &out) noexcept {
+        out.clear();
+        out.reserve(lz4_compress_bound(size));
+
+        if (size < mf_limit + 1) {
+            put_last_literals(out, src, size);
+            return;
+        }
+
+        // positions of the last 4-byte sequence seen per hash, 256 KiB: heap, not stack
+        const auto table = std::make_unique<std::uint32_t[]>(std::size_t{1} << hash_log);
+
+        const std::size_t match_start_limit = size - mf_limit;
+        const std::size_t match_end_limit = size - last_literals;
+
+        std::size_t anchor = 0;
+        std::size_t ip = 1; // position 0 doubles as "empty slot" in the table
+
+        while (ip <= match_start_limit) {
+            const std::uint32_t seq = read_u32(src + ip);
+            const std::uint32_t h = hash4(seq);
+            std::size_t cand = table[h];
+            table[h] = static_cast<std::uint32_t>(ip);
+
+            if (cand == 0 || ip - cand > max_offset || read_u32(src + cand) != seq) {
+                // skip faster through data that does not compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // extend backwards into the pending literals, then forwards
+            while (ip > anchor && cand > 0 && src[ip - 1] == src[cand - 1]) {
+                --ip;
+                --cand;
+            }
+
+            std::size_t len = min_match;
+            while (ip + len < match_end_limit && src[cand + len] == src[ip + len]) {
+                ++len;
+            }
+
+            put_sequence(out, src + anchor, ip - anchor, ip - cand, len);
+
+            ip += len;
+            anchor = ip;
+
+            // seed the table inside the match so the next one is found sooner
+            if (ip - 2 <= match_start_limit) {
+                table[hash4(read_u32(src + ip - 2))] = static_cast<std::uint32_t>(ip - 2);
+            }
+        }
+
+        put_last_literals(out, src + anchor, size - anchor);
+    }
+
+    bool lz4_decompress(const std::uint8_t *src, std::size_t size, std::uint8_t *dst, std::size_t dst_size) noexcept {
+        if (!src || size == 0 || (!dst && dst_size > 0)) {
+            return false;
+        }
+
+        const std::uint8_t *ip = src;
+        const std::uint8_t *const end = src + size;
+        std::uint8_t *op = dst;
+        std::uint8_t *const op_end = dst + dst_size;
+
+        while (true) {
+            if (ip >= end) {
+                return false;
+            }
+            const std::uint8_t token = *ip++;
+
+            std::size_t lit_len = token >> 4;
+            if (lit_len == 15 && !get_length(ip, end, lit_len)) {
+                return false;
+            }
+            if (lit_len > static_cast<std::size_t>(end - ip) || lit_len > static_cast<std::size_t>(op_end - op)) {
+                return false;
+            }
+            std::memcpy(op, ip, lit_len);
+            ip += lit_len;
+            op += lit_len;
+
+            // the last sequence has literals only
+            if (ip == end) {
+                break;
+            }
+
+            if (end - ip < 2) {
+                return false;
+            }
+            const std::size_t offset = static_cast<std::size_t>(ip[0]) | static_cast<std::size_t>(ip[1]) << 8;
+            ip += 2;
+            if (offset == 0 || offset > static_cast<std::size_t>(op - dst)) {
+                return false;
+            }
+
+            std::size_t match_len = token & 0x0F;
+            if (match_len == 15 && !get_length(ip, end, match_len)) {
+                return false;
+            }
+            match_len += min_match;
+            if (match_len > static_cast<std::size_t>(op_end - op)) {
+                return false;
+            }
+
+            const std::uint8_t *match = op - offset;
+            if (offset >= match_len) {
+                std::memcpy(op, match, match_len);
+                op += match_len;
+            } else {
+                // overlapping copy repeats the last offset bytes
+                for (std::size_t i = 0; i < match_len; ++i) {
+                    *op++ = match[i];
+                }
+            }
+        }
+
+        return op == op_end;
+    }
+}
@@ -0,0 +1,124 @@
+#include "internal/sgl_mapped_file.h"
+
+#include <cerrno>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "internal/sgl_log.h"
+
+namespace {
+    bool pread_all(int fd, std::uint8_t *dst, std::size_t size) noexcept {
+        std::size_t done = 0;
+        while (done < size) {
+            const ssize_t n = ::pread(fd, dst + done, size - done, static_cast<off_t>(done));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+}
+
+namespace sgl {
+    // ctors and assignments
+
+    mapped_file::mapped_file(mapped_file &&other) noexcept : m_data{std::exchange(other.m_data, nullptr)},
+                                                             m_size{std::exchange(other.m_size, 0)},
+                                                             m_owned{std::move(other.m_owned)} {
+    }
+
+    mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        destroy();
+
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_owned = std::move(other.m_owned);
+
+        return *this;
+    }
+
+    mapped_file::~mapped_file() {
+        destroy();
+    }
+
+    // fabrics
+
+    mapped_file::result mapped_file::create(const char *path, file_access access) noexcept {
+        if (!path) {
+            return unexpected{error::invalid_params};
+        }
+
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return unexpected{error::open_failed};
+        }
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return unexpected{error::stat_failed};
+        }
+
+        const auto size = static_cast<std::size_t>(st.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return mapped_file{nullptr, 0, nullptr};
+        }
+
+        if (size <= small_file_size) {
+            auto buf = std::unique_ptr<std::uint8_t[]>(new(std::nothrow) std::uint8_t[size]);
+            const bool ok = buf && pread_all(fd, buf.get(), size);
+            ::close(fd);
+
+            if (!ok) {
+                log_error(log_subsystem::assets, "mapped_file: failed to read '{}' ({} bytes)", path, size);
+                return unexpected{error::read_failed};
+            }
+
+            const std::uint8_t *data = buf.get();
+            return mapped_file{data, size, std::move(buf)};
+        }
+
+        void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+
+        if (p == MAP_FAILED) {
+            log_error(log_subsystem::assets, "mapped_file: mmap() of '{}' ({} bytes) failed", path, size);
+            return unexpected{error::mmap_failed};
+        }
+
+        // hints only, failures are harmless
+        if (access == file_access::sequential) {
+            ::madvise(p, size, MADV_SEQUENTIAL);
+            ::madvise(p, size, MADV_WILLNEED);
+        } else {
+            ::madvise(p, size, MADV_RANDOM);
+        }
+
+        return mapped_file{static_cast<const std::uint8_t *>(p), size, nullptr};
+    }
+
+    // internal
+
+    void mapped_file::destroy() noexcept {
+        if (m_data && !m_owned) {
+            ::munmap(const_cast<std::uint8_t *>(m_data), m_size);
+        }
+        m_owned.reset();
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
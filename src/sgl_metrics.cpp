@@ -0,0 +1,294 @@
+#include "internal/sgl_metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "internal/sgl_job.h"
+#include "internal/sgl_log.h"
+
+namespace {
+    std::uint64_t to_us(double ms) noexcept {
+        return static_cast<std::uint64_t>(std::llround(std::clamp(ms, 0.0, 1e12) * 1000.0));
+    }
+}
+
+namespace sgl {
+    // time_histogram
+
+    void time_histogram::record(double ms) noexcept {
+        ms = std::max(ms, 0.0);
+
+        ++m_counts[bucket_of(to_us(ms))];
+        ++m_count;
+        m_sum_ms += ms;
+        m_max_ms = std::max(m_max_ms, ms);
+    }
+
+    void time_histogram::remove(double ms) noexcept {
+        ms = std::max(ms, 0.0);
+
+        auto &bucket = m_counts[bucket_of(to_us(ms))];
+        if (bucket == 0 || m_count == 0) {
+            return;
+        }
+        --bucket;
+        --m_count;
+        m_sum_ms = m_count ? std::max(m_sum_ms - ms, 0.0) : 0.0;
+    }
+
+    double time_histogram::percentile(double p) const noexcept {
+        if (m_count == 0) {
+            return 0.0;
+        }
+
+        const auto rank = std::max<std::uint64_t>(
+            1, static_cast<std::uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) * 0.01 * static_cast<double>(m_count)))
+        );
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucket_count; ++i) {
+            seen += m_counts[i];
+            if (seen >= rank) {
+                return std::min(bucket_value_ms(i), m_max_ms);
+            }
+        }
+        return m_max_ms;
+    }
+
+    std::uint64_t time_histogram::count_above(double ms) const noexcept {
+        std::uint64_t n = 0;
+        for (std::size_t i = bucket_of(to_us(ms)) + 1; i < bucket_count; ++i) {
+            n += m_counts[i];
+        }
+        return n;
+    }
+
+    void time_histogram::reset() noexcept {
+        m_counts.fill(0);
+        m_count = 0;
+        m_sum_ms = 0.0;
+        m_max_ms = 0.0;
+    }
+
+    std::size_t time_histogram::bucket_of(std::uint64_t us) noexcept {
+        if (us < sub_count) {
+            return static_cast<std::size_t>(us);
+        }
+
+        const int exponent = std::min(static_cast<int>(std::bit_width(us)) - 1, max_exponent);
+        if (exponent == max_exponent && (us >> max_exponent) > 1) {
+            return bucket_count - 1;
+        }
+
+        const auto sub = static_cast<std::size_t>(us >> (exponent - sub_bits)) - sub_count;
+        return static_cast<std::size_t>(exponent - sub_bits + 1) * sub_count + sub;
+    }
+
+    double time_histogram::bucket_value_ms(std::size_t index) noexcept {
+        if (index < sub_count) {
+            return static_cast<double>(index) * 1e-3;
+        }
+
+        // middle of the bucket
+        const int exponent = static_cast<int>(index / sub_count) + sub_bits - 1;
+        const std::uint64_t lower = (sub_count + index % sub_count) << (exponent - sub_bits);
+        const std::uint64_t width = std::uint64_t{1} << (exponent - sub_bits);
+        return (static_cast<double>(lower) + static_cast<double>(width - 1) * 0.5) * 1e-3;
+    }
+}
+
+namespace sgl::metrics {
+    namespace {
+        using clock = std::chrono::steady_clock;
+
+        struct registry {
+            frame last;
+            std::uint64_t frames = 0;
+
+            bool has_frame_start = false;
+            clock::time_point frame_start;
+
+            // summary window
+            clock::time_point window_start = clock::now();
+            std::array<std::uint64_t, counter_count> totals{};
+            time_histogram frame_times;
+
+            std::string dump_path;
+            dump_format dump_fmt = dump_format::json;
+            double dump_interval_sec = 0.0;
+        };
+
+        registry &reg() noexcept {
+            static registry r;
+            return r;
+        }
+
+        bool append_to_file(const std::string &path, dump_format format, const std::string &record) noexcept {
+            FILE *f = std::fopen(path.c_str(), "ab");
+            if (!f) {
+                log_error(log_subsystem::profiling, "metrics: failed to open '{}'", path);
+                return false;
+            }
+
+            bool ok = true;
+            if (format == dump_format::csv && std::fseek(f, 0, SEEK_END) == 0 && std::ftell(f) == 0) {
+                const std::string header = csv_header();
+                ok = std::fwrite(header.data(), 1, header.size(), f) == header.size();
+            }
+            ok = ok && std::fwrite(record.data(), 1, record.size(), f) == record.size();
+
+            if (std::fclose(f) != 0 || !ok) {
+                log_error(log_subsystem::profiling, "metrics: failed to write '{}'", path);
+                return false;
+            }
+            return true;
+        }
+
+        std::string format_record(dump_format format, const summary &s) noexcept {
+            return format == dump_format::csv ? to_csv(s) : to_json(s);
+        }
+    }
+
+    const char *counter_name(counter c) noexcept {
+        switch (c) {
+            case counter::draw_calls: return "draw_calls";
+            case counter::triangles: return "triangles";
+            case counter::state_changes: return "state_changes";
+            case counter::uniform_uploads: return "uniform_uploads";
+            case counter::buffer_bytes: return "buffer_bytes";
+            case counter::texture_bytes: return "texture_bytes";
+            case counter::shaders_created: return "shaders_created";
+            case counter::textures_created: return "textures_created";
+            case counter::gl_calls: return "gl_calls";
+            default: return "unknown";
+        }
+    }
+
+    void end_frame() noexcept {
+        registry &r = reg();
+        const clock::time_point now = clock::now();
+
+        r.last.index = r.frames++;
+        r.last.frame_ms = r.has_frame_start
+                              ? std::chrono::duration<double, std::milli>(now - r.frame_start).count()
+                              : 0.0;
+        for (std::size_t i = 0; i < counter_count; ++i) {
+            r.last.counters[i] = detail::g_counters[i].exchange(0, std::memory_order_relaxed);
+            r.totals[i] += r.last.counters[i];
+        }
+
+        // the first frame has no start
+        if (r.has_frame_start) {
+            r.frame_times.record(r.last.frame_ms);
+        }
+        r.has_frame_start = true;
+        r.frame_start = now;
+
+        if (r.dump_interval_sec > 0.0 &&
+            std::chrono::duration<double>(now - r.window_start).count() >= r.dump_interval_sec) {
+            std::string record = format_record(r.dump_fmt, summarize());
+            sgl::detail::submit_job([path = r.dump_path, format = r.dump_fmt, record = std::move(record)] {
+                append_to_file(path, format, record);
+            });
+            reset();
+        }
+    }
+
+    const frame &last_frame() noexcept {
+        return reg().last;
+    }
+
+    summary summarize() noexcept {
+        const registry &r = reg();
+
+        summary s;
+        s.unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+        s.frames = r.frame_times.count();
+        s.seconds = std::chrono::duration<double>(clock::now() - r.window_start).count();
+        s.totals = r.totals;
+        s.frame_avg_ms = r.frame_times.avg_ms();
+        s.frame_p50_ms = r.frame_times.percentile(50.0);
+        s.frame_p95_ms = r.frame_times.percentile(95.0);
+        s.frame_p99_ms = r.frame_times.percentile(99.0);
+        s.frame_max_ms = r.frame_times.max_ms();
+        return s;
+    }
+
+    const time_histogram &frame_times() noexcept {
+        return reg().frame_times;
+    }
+
+    void reset() noexcept {
+        registry &r = reg();
+        r.window_start = clock::now();
+        r.totals.fill(0);
+        r.frame_times.reset();
+    }
+
+    void set_periodic_dump(const char *path, dump_format format, double interval_sec) noexcept {
+        registry &r = reg();
+        if (!path || interval_sec <= 0.0) {
+            r.dump_path.clear();
+            r.dump_interval_sec = 0.0;
+            return;
+        }
+
+        r.dump_path = path;
+        r.dump_fmt = format;
+        r.dump_interval_sec = interval_sec;
+        reset();
+    }
+
+    std::string to_json(const summary &s) noexcept {
+        std::string out = fmt::format(
+            R"({{"unix_ms":{},"frames":{},"seconds":{:.3f},"frame_ms":{{"avg":{:.3f},"p50":{:.3f},"p95":{:.3f},)"
+            R"("p99":{:.3f},"max":{:.3f}}})",
+            s.unix_ms, s.frames, s.seconds, s.frame_avg_ms, s.frame_p50_ms, s.frame_p95_ms, s.frame_p99_ms,
+            s.frame_max_ms
+        );
+        for (std::size_t i = 0; i < counter_count; ++i) {
+            const auto c = static_cast<counter>(i);
+            fmt::format_to(std::back_inserter(out), R"(,"{}":{{"total":{},"per_frame":{:.2f}}})", counter_name(c),
+                           s.totals[i], s.per_frame(c));
+        }
+        out += "}\n";
+        return out;
+    }
+
+    std::string csv_header() noexcept {
+        std::string out = "unix_ms,frames,seconds,frame_avg_ms,frame_p50_ms,frame_p95_ms,frame_p99_ms,frame_max_ms";
+        for (std::size_t i = 0; i < counter_count; ++i) {
+            fmt::format_to(std::back_inserter(out), ",{}", counter_name(static_cast<counter>(i)));
+        }
+        out += '\n';
+        return out;
+    }
+
+    std::string to_csv(const summary &s) noexcept {
+        std::string out = fmt::format(
+            "{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f}", s.unix_ms, s.frames, s.seconds, s.frame_avg_ms,
+            s.frame_p50_ms, s.frame_p95_ms, s.frame_p99_ms, s.frame_max_ms
+        );
+        for (const auto total: s.totals) {
+            fmt::format_to(std::back_inserter(out), ",{}", total);
+        }
+        out += '\n';
+        return out;
+    }
+
+    bool write(const char *path, dump_format format, const summary &s) noexcept {
+        if (!path) {
+            return false;
+        }
+        return append_to_file(path, format, format_record(format, s));
+    }
+}
@@ -0,0 +1,255 @@
+#include "internal/sgl_mipmap.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SGL_MIP_X86 1
+    #include <immintrin.h>
+#endif
+
+namespace {
+    // float4 per pixel in linear space regardless of the source channel count
+
+    constexpr std::size_t lanes = 4;
+    constexpr int srgb_encode_lut_size = 4096;
+
+    struct srgb_luts {
+        std::array<float, 256> decode{};
+        std::array<std::uint8_t, srgb_encode_lut_size> encode{};
+    };
+
+    const srgb_luts &luts() noexcept {
+        static const srgb_luts l = [] {
+            srgb_luts t;
+            for (int i = 0; i < 256; ++i) {
+                const float c = static_cast<float>(i) / 255.f;
+                t.decode[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            for (int i = 0; i < srgb_encode_lut_size; ++i) {
+                const float l = static_cast<float>(i) / static_cast<float>(srgb_encode_lut_size - 1);
+                const float s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.f / 2.4f) - 0.055f;
+                t.encode[i] = static_cast<std::uint8_t>(std::clamp(s * 255.f + 0.5f, 0.f, 255.f));
+            }
+            return t;
+        }();
+        return l;
+    }
+
+    struct layout {
+        int color; // leading color channels (sRGB-affected)
+        int alpha; // alpha channel index or -1
+    };
+
+    constexpr layout layout_for(int channels) noexcept {
+        switch (channels) {
+            case 1: return {1, -1};
+            case 2: return {1, 1};
+            case 3: return {3, -1};
+            default: return {3, 3};
+        }
+    }
+
+    void decode_row(
+        const std::uint8_t *src, int width, int channels, bool srgb, bool premultiply, float *out
+    ) noexcept {
+        const auto &lut = luts();
+        const auto [color, alpha] = layout_for(channels);
+
+        for (int x = 0; x < width; ++x) {
+            const std::uint8_t *p = src + static_cast<std::size_t>(x) * channels;
+            float *o = out + static_cast<std::size_t>(x) * lanes;
+
+            o[0] = o[1] = o[2] = o[3] = 0.f;
+            for (int c = 0; c < color; ++c) {
+                o[c] = srgb ? lut.decode[p[c]] : static_cast<float>(p[c]) * (1.f / 255.f);
+            }
+            if (alpha >= 0) {
+                o[alpha] = static_cast<float>(p[alpha]) * (1.f / 255.f);
+                if (premultiply) {
+                    for (int c = 0; c < color; ++c) {
+                        o[c] *= o[alpha];
+                    }
+                }
+            }
+        }
+    }
+
+    void encode_row(const float *in, int width, int channels, bool srgb, std::uint8_t *dst) noexcept {
+        const auto &lut = luts();
+        const auto [color, alpha] = layout_for(channels);
+
+        for (int x = 0; x < width; ++x) {
+            const float *i = in + static_cast<std::size_t>(x) * lanes;
+            std::uint8_t *d = dst + static_cast<std::size_t>(x) * channels;
+
+            for (int c = 0; c < color; ++c) {
+                const float v = std::clamp(i[c], 0.f, 1.f);
+                if (srgb) {
+                    d[c] = lut.encode[static_cast<int>(v * (srgb_encode_lut_size - 1) + 0.5f)];
+                } else {
+                    d[c] = static_cast<std::uint8_t>(v * 255.f + 0.5f);
+                }
+            }
+            if (alpha >= 0) {
+                d[alpha] = static_cast<std::uint8_t>(std::clamp(i[alpha], 0.f, 1.f) * 255.f + 0.5f);
+            }
+        }
+    }
+
+    // 2x2 box filter of horizontally paired float4 pixels: dst[x] = avg(r0[2x], r0[2x+1], r1[2x], r1[2x+1])
+
+    using downsample_fn = void (*)(const float *r0, const float *r1, float *dst, int count) noexcept;
+
+#ifndef SGL_MIP_X86
+    void downsample_row_scalar(const float *r0, const float *r1, float *dst, int count) noexcept {
+        for (int x = 0; x < count; ++x) {
+            const std::size_t s = static_cast<std::size_t>(x) * 2 * lanes;
+            for (std::size_t c = 0; c < lanes; ++c) {
+                dst[x * lanes + c] = 0.25f * (r0[s + c] + r0[s + lanes + c] + r1[s + c] + r1[s + lanes + c]);
+            }
+        }
+    }
+#else
+    void downsample_row_sse(const float *r0, const float *r1, float *dst, int count) noexcept {
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        for (int x = 0; x < count; ++x) {
+            const std::size_t s = static_cast<std::size_t>(x) * 2 * lanes;
+            const __m128 a = _mm_add_ps(_mm_loadu_ps(r0 + s), _mm_loadu_ps(r0 + s + lanes));
+            const __m128 b = _mm_add_ps(_mm_loadu_ps(r1 + s), _mm_loadu_ps(r1 + s + lanes));
+            _mm_storeu_ps(dst + x * lanes, _mm_mul_ps(_mm_add_ps(a, b), quarter));
+        }
+    }
+
+#if defined(__GNUC__)
+    __attribute__((target("avx2")))
+    void downsample_row_avx2(const float *r0, const float *r1, float *dst, int count) noexcept {
+        const __m256 quarter = _mm256_set1_ps(0.25f);
+        int x = 0;
+        // two output pixels per iteration: four source pixels from each row
+        for (; x + 2 <= count; x += 2) {
+            const std::size_t s = static_cast<std::size_t>(x) * 2 * lanes;
+            const __m256 s0 = _mm256_add_ps(_mm256_loadu_ps(r0 + s), _mm256_loadu_ps(r1 + s));
+            const __m256 s1 = _mm256_add_ps(_mm256_loadu_ps(r0 + s + 8), _mm256_loadu_ps(r1 + s + 8));
+            const __m256 lo = _mm256_permute2f128_ps(s0, s1, 0x20);
+            const __m256 hi = _mm256_permute2f128_ps(s0, s1, 0x31);
+            _mm256_storeu_ps(dst + x * lanes, _mm256_mul_ps(_mm256_add_ps(lo, hi), quarter));
+        }
+        if (x < count) {
+            const std::size_t off = static_cast<std::size_t>(x) * 2 * lanes;
+            downsample_row_sse(r0 + off, r1 + off, dst + x * lanes, count - x);
+        }
+    }
+#endif
+#endif
+
+    downsample_fn pick_downsample() noexcept {
+#ifdef SGL_MIP_X86
+#if defined(__GNUC__)
+        if (__builtin_cpu_supports("avx2")) {
+            return downsample_row_avx2;
+        }
+#endif
+        return downsample_row_sse;
+#else
+        return downsample_row_scalar;
+#endif
+    }
+
+    void downsample_level(
+        const sgl::mip_level &src, sgl::mip_level &dst, int channels, bool srgb, downsample_fn kernel,
+        std::vector<float> &scratch
+    ) noexcept {
+        const int sw = src.width;
+        const int sh = src.height;
+        const int dw = std::max(1, sw / 2);
+        const int dh = std::max(1, sh / 2);
+
+        dst.width = dw;
+        dst.height = dh;
+        dst.pixels.resize(static_cast<std::size_t>(dw) * dh * channels);
+
+        const std::size_t row_lanes = static_cast<std::size_t>(std::max(sw, 2)) * lanes;
+        scratch.resize(row_lanes * 3);
+        float *r0 = scratch.data();
+        float *r1 = r0 + row_lanes;
+        float *out = r1 + row_lanes;
+
+        const std::size_t src_stride = static_cast<std::size_t>(sw) * channels;
+        const std::size_t dst_stride = static_cast<std::size_t>(dw) * channels;
+
+        for (int y = 0; y < dh; ++y) {
+            const int y0 = std::min(2 * y, sh - 1);
+            const int y1 = std::min(2 * y + 1, sh - 1);
+
+            decode_row(src.pixels.data() + y0 * src_stride, sw, channels, srgb, false, r0);
+            decode_row(src.pixels.data() + y1 * src_stride, sw, channels, srgb, false, r1);
+
+            if (sw == 1) {
+                // a 1-wide column has no horizontal pair: duplicate the texel
+                std::memcpy(r0 + lanes, r0, lanes * sizeof(float));
+                std::memcpy(r1 + lanes, r1, lanes * sizeof(float));
+            }
+
+            kernel(r0, r1, out, dw);
+            encode_row(out, dw, channels, srgb, dst.pixels.data() + y * dst_stride);
+        }
+    }
+}
+
+namespace sgl {
+    mip_chain build_mip_chain(
+        const std::uint8_t *data, gl_int width, gl_int height, gl_int channels, const mip_chain_params &params
+    ) noexcept {
+        mip_chain chain;
+        if (!data || width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+            return chain;
+        }
+
+        chain.channels = channels;
+        gl_int count = mip_level_count(width, height);
+        if (params.max_levels > 0) {
+            count = std::min(count, params.max_levels);
+        }
+        chain.levels.resize(static_cast<std::size_t>(count));
+
+        auto &base = chain.levels.front();
+        base.width = width;
+        base.height = height;
+
+        const std::size_t stride = static_cast<std::size_t>(width) * channels;
+        const bool has_alpha = layout_for(channels).alpha >= 0;
+
+        if (params.premultiply_alpha && has_alpha) {
+            base.pixels.resize(stride * height);
+            std::vector<float> row(static_cast<std::size_t>(width) * lanes);
+            for (int y = 0; y < height; ++y) {
+                decode_row(data + y * stride, width, channels, params.srgb, true, row.data());
+                encode_row(row.data(), width, channels, params.srgb, base.pixels.data() + y * stride);
+            }
+        } else {
+            base.pixels.assign(data, data + stride * height);
+        }
+
+        const downsample_fn kernel = pick_downsample();
+        std::vector<float> scratch;
+
+        for (std::size_t i = 1; i < chain.levels.size(); ++i) {
+            downsample_level(chain.levels[i - 1], chain.levels[i], channels, params.srgb, kernel, scratch);
+        }
+
+        return chain;
+    }
+
+    gl_int mip_level_count(gl_int width, gl_int height) noexcept {
+        gl_int size = std::max(width, height);
+        gl_int count = 1;
+        while (size > 1) {
+            size >>= 1;
+            ++count;
+        }
+        return count;
+    }
+}
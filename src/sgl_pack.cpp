@@ -0,0 +1,418 @@
+#include "internal/sgl_pack.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+
+#include "internal/sgl_hash.h"
+#include "internal/sgl_log.h"
+#include "internal/sgl_lz4.h"
+
+namespace {
+    constexpr std::array<char, 4> pack_magic{'S', 'G', 'L', 'P'};
+    constexpr std::uint32_t pack_version = 1;
+    constexpr std::uint32_t entry_flag_lz4 = 1u << 0;
+    constexpr std::size_t pack_align = 16;
+
+    struct pack_header {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+        std::uint32_t count;
+        std::uint32_t reserved;
+        std::uint64_t toc_offset;
+        std::uint64_t names_offset;
+        std::uint64_t names_size;
+    };
+
+    static_assert(sizeof(pack_header) == 40);
+
+    struct toc_entry {
+        std::uint64_t hash;
+        std::uint64_t offset;
+        std::uint64_t stored_size;
+        std::uint64_t size;
+        std::uint32_t name_offset;
+        std::uint32_t name_size;
+        std::uint32_t flags;
+        std::uint32_t reserved;
+    };
+
+    static_assert(sizeof(toc_entry) == 48);
+
+    // lz4 can't expand a stored byte into more than 255, anything past that is a corrupt size
+    constexpr std::uint64_t lz4_max_ratio = 255;
+
+    toc_entry read_entry(const std::uint8_t *toc, std::size_t index) noexcept {
+        toc_entry e;
+        std::memcpy(&e, toc + index * sizeof(toc_entry), sizeof(e));
+        return e;
+    }
+
+    bool write_padding(FILE *f, std::uint64_t &pos) noexcept {
+        static constexpr std::array<std::uint8_t, pack_align> zeros{};
+        const std::size_t pad = (pack_align - pos % pack_align) % pack_align;
+        pos += pad;
+        return std::fwrite(zeros.data(), 1, pad, f) == pad;
+    }
+
+    // most lookups are already normal: no allocation for them
+    std::string_view normalized(std::string_view path, std::string &storage) noexcept {
+        if (path.find('\\') == std::string_view::npos && !path.starts_with("./")) {
+            return path;
+        }
+        storage = sgl::pack::normalize_path(path);
+        return storage;
+    }
+
+    // mounted packs, searched back to front
+    std::shared_mutex g_mount_mutex;
+    std::vector<std::shared_ptr<const sgl::pack> > g_mounted;
+    std::atomic<bool> g_any_mounted{false};
+}
+
+namespace sgl {
+    // ctors and assignments
+
+    pack::pack(pack &&other) noexcept : m_file{std::move(other.m_file)},
+                                        m_count{std::exchange(other.m_count, 0)},
+                                        m_toc_offset{std::exchange(other.m_toc_offset, 0)},
+                                        m_names_offset{std::exchange(other.m_names_offset, 0)} {
+    }
+
+    pack &pack::operator=(pack &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        m_file = std::move(other.m_file);
+        m_count = std::exchange(other.m_count, 0);
+        m_toc_offset = std::exchange(other.m_toc_offset, 0);
+        m_names_offset = std::exchange(other.m_names_offset, 0);
+
+        return *this;
+    }
+
+    // fabrics
+
+    pack::result pack::create(const char *path) noexcept {
+        if (!path) {
+            return unexpected{error::invalid_params};
+        }
+
+        // table lookups jump around, blobs are read once each
+        auto file = mapped_file::create(path, file_access::random);
+        if (!file) {
+            log_error(log_subsystem::assets, "pack: failed to open '{}': {}",
+                      path, mapped_file::err_to_str(file.error()));
+            return unexpected{error::open_failed};
+        }
+
+        const std::size_t file_size = file->size();
+        pack_header header{};
+        if (file_size < sizeof(header)) {
+            log_error(log_subsystem::assets, "pack: '{}' is too small", path);
+            return unexpected{error::file_invalid};
+        }
+        std::memcpy(&header, file->data(), sizeof(header));
+
+        if (header.magic != pack_magic || header.version != pack_version) {
+            log_error(log_subsystem::assets, "pack: '{}' is not an sgl pack (or version {} != {})",
+                      path, header.version, pack_version);
+            return unexpected{error::file_invalid};
+        }
+
+        const std::uint64_t toc_size = static_cast<std::uint64_t>(header.count) * sizeof(toc_entry);
+        if (header.toc_offset > file_size || toc_size > file_size - header.toc_offset ||
+            header.names_offset > file_size || header.names_size > file_size - header.names_offset) {
+            log_error(log_subsystem::assets, "pack: '{}' has a truncated table of contents", path);
+            return unexpected{error::file_invalid};
+        }
+
+        // validate once so lookups need no checks
+        const std::uint8_t *toc = file->data() + header.toc_offset;
+        std::uint64_t prev_hash = 0;
+        for (std::size_t i = 0; i < header.count; ++i) {
+            const toc_entry e = read_entry(toc, i);
+            if (e.hash < prev_hash || e.offset > file_size || e.stored_size > file_size - e.offset ||
+                e.name_offset > header.names_size || e.name_size > header.names_size - e.name_offset ||
+                (!(e.flags & entry_flag_lz4) && e.stored_size != e.size) ||
+                e.size > e.stored_size * lz4_max_ratio + 16) {
+                log_error(log_subsystem::assets, "pack: '{}' entry {} is corrupt", path, i);
+                return unexpected{error::file_invalid};
+            }
+            prev_hash = e.hash;
+        }
+
+        log_info(log_subsystem::assets, "pack: mapped '{}' ({} entries, {} bytes)", path, header.count, file_size);
+
+        return pack{
+            std::move(*file), header.count, static_cast<std::size_t>(header.toc_offset),
+            static_cast<std::size_t>(header.names_offset)
+        };
+    }
+
+    bool pack::write(const char *path, std::span<const pack_source> sources, bool compress) noexcept {
+        if (!path) {
+            return false;
+        }
+
+        std::vector<toc_entry> toc;
+        toc.reserve(sources.size());
+        std::string names;
+
+        FILE *f = std::fopen(path, "wb");
+        if (!f) {
+            log_error(log_subsystem::assets, "pack::write: failed to open '{}'", path);
+            return false;
+        }
+
+        // header is rewritten at the end, once the offsets are known
+        pack_header header{
+            .magic = pack_magic, .version = pack_version, .count = 0, .reserved = 0,
+            .toc_offset = 0, .names_offset = 0, .names_size = 0
+        };
+        bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+        std::uint64_t pos = sizeof(header);
+
+        std::vector<std::uint8_t> packed;
+        for (const auto &src: sources) {
+            if (!ok) {
+                break;
+            }
+
+            const auto file = mapped_file::create(src.path);
+            if (!file) {
+                log_error(log_subsystem::assets, "pack::write: failed to read '{}'", src.path);
+                ok = false;
+                break;
+            }
+
+            const std::string name = normalize_path(src.name);
+
+            toc_entry e{
+                .hash = fnv1a_64(name), .offset = 0, .stored_size = file->size(), .size = file->size(),
+                .name_offset = static_cast<std::uint32_t>(names.size()),
+                .name_size = static_cast<std::uint32_t>(name.size()), .flags = 0, .reserved = 0
+            };
+            names += name;
+
+            const std::uint8_t *blob = file->data();
+            if (compress && !file->empty()) {
+                lz4_compress(file->data(), file->size(), packed);
+                if (packed.size() < file->size() - file->size() / 16) {
+                    e.flags |= entry_flag_lz4;
+                    e.stored_size = packed.size();
+                    blob = packed.data();
+                }
+            }
+
+            ok = write_padding(f, pos);
+            e.offset = pos;
+            ok = ok && std::fwrite(blob, 1, e.stored_size, f) == e.stored_size;
+            pos += e.stored_size;
+
+            toc.push_back(e);
+        }
+
+        if (ok) {
+            std::sort(toc.begin(), toc.end(), [](const toc_entry &a, const toc_entry &b) { return a.hash < b.hash; });
+
+            // a repeated name would shadow the other entry for good
+            const auto name_of = [&names](const toc_entry &e) {
+                return std::string_view{names}.substr(e.name_offset, e.name_size);
+            };
+            for (std::size_t i = 1; ok && i < toc.size(); ++i) {
+                for (std::size_t j = i; ok && j-- > 0 && toc[j].hash == toc[i].hash;) {
+                    if (name_of(toc[j]) == name_of(toc[i])) {
+                        log_error(log_subsystem::assets, "pack::write: '{}' is in the pack twice", name_of(toc[i]));
+                        ok = false;
+                    }
+                }
+            }
+
+            ok = ok && write_padding(f, pos);
+            header.count = static_cast<std::uint32_t>(toc.size());
+            header.toc_offset = pos;
+            ok = ok && std::fwrite(toc.data(), sizeof(toc_entry), toc.size(), f) == toc.size();
+            pos += toc.size() * sizeof(toc_entry);
+
+            header.names_offset = pos;
+            header.names_size = names.size();
+            ok = ok && std::fwrite(names.data(), 1, names.size(), f) == names.size();
+
+            ok = ok && std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, f) == 1;
+        }
+
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok) {
+            log_error(log_subsystem::assets, "pack::write: failed to write '{}'", path);
+            std::remove(path);
+        }
+        return ok;
+    }
+
+    // api
+
+    pack_entry pack::entry(std::size_t index) const noexcept {
+        if (index >= m_count) {
+            return {};
+        }
+
+        const toc_entry e = read_entry(m_file.data() + m_toc_offset, index);
+        return pack_entry{
+            .name = {reinterpret_cast<const char *>(m_file.data() + m_names_offset + e.name_offset), e.name_size},
+            .size = static_cast<std::size_t>(e.size),
+            .stored_size = static_cast<std::size_t>(e.stored_size),
+            .compressed = (e.flags & entry_flag_lz4) != 0,
+        };
+    }
+
+    std::span<const std::uint8_t> pack::view_at(std::size_t index) const noexcept {
+        if (index >= m_count) {
+            return {};
+        }
+
+        const toc_entry e = read_entry(m_file.data() + m_toc_offset, index);
+        if (e.flags & entry_flag_lz4) {
+            return {};
+        }
+        return {m_file.data() + e.offset, static_cast<std::size_t>(e.size)};
+    }
+
+    bool pack::read_at(std::size_t index, std::vector<std::uint8_t> &out) const noexcept {
+        if (index >= m_count) {
+            return false;
+        }
+
+        const toc_entry e = read_entry(m_file.data() + m_toc_offset, index);
+        const std::uint8_t *blob = m_file.data() + e.offset;
+
+        out.resize(static_cast<std::size_t>(e.size));
+        if (!(e.flags & entry_flag_lz4)) {
+            std::copy_n(blob, out.size(), out.data());
+            return true;
+        }
+
+        if (!lz4_decompress(blob, static_cast<std::size_t>(e.stored_size), out.data(), out.size())) {
+            log_error(log_subsystem::assets, "pack: corrupt lz4 block for '{}'", entry(index).name);
+            out.clear();
+            return false;
+        }
+        return true;
+    }
+
+    std::string pack::normalize_path(std::string_view path) noexcept {
+        std::string s{path};
+        std::replace(s.begin(), s.end(), '\\', '/');
+
+        std::size_t start = 0;
+        while (s.compare(start, 2, "./") == 0) {
+            start += 2;
+        }
+        return s.substr(start);
+    }
+
+    // internal
+
+    std::size_t pack::find(std::string_view path) const noexcept {
+        std::string storage;
+        const std::string_view name = normalized(path, storage);
+        const std::uint64_t hash = fnv1a_64(name);
+        const std::uint8_t *toc = m_file.data() + m_toc_offset;
+
+        // lower bound on the sorted hashes, then settle collisions by name
+        std::size_t lo = 0, hi = m_count;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (read_entry(toc, mid).hash < hash) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        for (std::size_t i = lo; i < m_count; ++i) {
+            const toc_entry e = read_entry(toc, i);
+            if (e.hash != hash) {
+                break;
+            }
+            const std::string_view entry_name{
+                reinterpret_cast<const char *>(m_file.data() + m_names_offset + e.name_offset), e.name_size
+            };
+            if (entry_name == name) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    // mounting
+
+    bool mount_pack(const char *path) noexcept {
+        auto p = pack::create(path);
+        if (!p) {
+            return false;
+        }
+
+        std::unique_lock lock{g_mount_mutex};
+        g_mounted.push_back(std::make_shared<const pack>(std::move(*p)));
+        g_any_mounted.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void unmount_packs() noexcept {
+        std::unique_lock lock{g_mount_mutex};
+        g_mounted.clear();
+        g_any_mounted.store(false, std::memory_order_release);
+    }
+
+    asset_file::result asset_file::create(const char *path, file_access access) noexcept {
+        if (!path) {
+            return unexpected{error::invalid_params};
+        }
+
+        if (g_any_mounted.load(std::memory_order_acquire)) {
+            std::shared_ptr<const pack> owner;
+            std::size_t index = pack::npos;
+            {
+                std::shared_lock lock{g_mount_mutex};
+                for (auto it = g_mounted.rbegin(); it != g_mounted.rend(); ++it) {
+                    index = (*it)->find(path);
+                    if (index != pack::npos) {
+                        owner = *it;
+                        break;
+                    }
+                }
+            }
+
+            if (owner) {
+                asset_file f;
+                f.m_bytes = owner->view_at(index);
+                if (f.m_bytes.empty()) {
+                    if (!owner->read_at(index, f.m_unpacked)) {
+                        return unexpected{error::read_failed};
+                    }
+                    f.m_bytes = f.m_unpacked;
+                }
+                f.m_pack = std::move(owner);
+                return f;
+            }
+        }
+
+        auto file = mapped_file::create(path, access);
+        if (!file) {
+            return unexpected{file.error()};
+        }
+
+        asset_file f;
+        f.m_bytes = file->bytes();
+        f.m_file.emplace(std::move(*file));
+        return f;
+    }
+}
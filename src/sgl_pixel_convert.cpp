@@ -0,0 +1,346 @@
+#include "internal/sgl_pixel_convert.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SGL_PIXEL_X86 1
+    #include <immintrin.h>
+#endif
+
+namespace {
+    using expand_fn = void (*)(const std::uint8_t *src, std::uint8_t *dst, std::size_t count, std::uint8_t alpha) noexcept;
+    using premultiply_fn = void (*)(std::uint8_t *pixels, std::size_t count) noexcept;
+    using half_fn = void (*)(const float *src, std::uint16_t *dst, std::size_t count) noexcept;
+
+    // exact round(v / 255) for v <= 255 * 255
+    constexpr std::uint8_t div255(std::uint32_t v) noexcept {
+        v += 128;
+        return static_cast<std::uint8_t>((v + (v >> 8)) >> 8);
+    }
+
+    // scalar
+
+    template<int R, int B>
+    void expand_scalar(const std::uint8_t *src, std::uint8_t *dst, std::size_t count, std::uint8_t alpha) noexcept {
+        for (std::size_t i = 0; i < count; ++i) {
+            dst[i * 4 + R] = src[i * 3 + 0];
+            dst[i * 4 + 1] = src[i * 3 + 1];
+            dst[i * 4 + B] = src[i * 3 + 2];
+            dst[i * 4 + 3] = alpha;
+        }
+    }
+
+    void premultiply_scalar(std::uint8_t *pixels, std::size_t count) noexcept {
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint8_t *p = pixels + i * 4;
+            const std::uint32_t a = p[3];
+            p[0] = div255(p[0] * a);
+            p[1] = div255(p[1] * a);
+            p[2] = div255(p[2] * a);
+        }
+    }
+
+    std::uint32_t bits_of(float f) noexcept {
+        std::uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        return u;
+    }
+
+    float float_of(std::uint32_t u) noexcept {
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+
+    // positive float -> 5-bit exponent small float with mant_bits of mantissa (half: 10, r11g11b10: 6/5),
+    // round to nearest even. the bias trick handles normals, the magic add handles denormals
+    std::uint32_t to_small_float(std::uint32_t x, int mant_bits) noexcept {
+        const int shift = 23 - mant_bits;
+        const std::uint32_t denorm_magic = static_cast<std::uint32_t>((127 - 15) + shift + 1) << 23;
+
+        if (x < 113u << 23) {
+            return bits_of(float_of(x) + float_of(denorm_magic)) - denorm_magic;
+        }
+
+        const std::uint32_t mant_odd = x >> shift & 1;
+        x += 0xC8000000u + ((1u << (shift - 1)) - 1); // rebias the exponent from 127 to 15
+        x += mant_odd;
+        return x >> shift;
+    }
+
+    void half_scalar(const float *src, std::uint16_t *dst, std::size_t count) noexcept {
+        constexpr std::uint32_t f32_inf = 255u << 23;
+        constexpr std::uint32_t f16_max = (127u + 16) << 23; // 65536: rounds to inf
+
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint32_t x = bits_of(src[i]);
+            const std::uint32_t sign = x & 0x80000000u;
+            x ^= sign;
+
+            std::uint32_t h;
+            if (x >= f16_max) {
+                h = x > f32_inf ? 0x7E00u : 0x7C00u;
+            } else {
+                h = to_small_float(x, 10);
+            }
+            dst[i] = static_cast<std::uint16_t>(h | sign >> 16);
+        }
+    }
+
+    std::uint32_t unsigned_small_float(float f, int mant_bits) noexcept {
+        const std::uint32_t max = 30u << mant_bits | ((1u << mant_bits) - 1);
+        if (std::isnan(f)) {
+            return 31u << mant_bits | 1;
+        }
+        if (!(f > 0.f)) {
+            return 0;
+        }
+        const std::uint32_t x = bits_of(f);
+        if (x >= (127u + 16) << 23) {
+            return max;
+        }
+        return std::min(to_small_float(x, mant_bits), max);
+    }
+
+#ifdef SGL_PIXEL_X86
+#if defined(__GNUC__)
+    __attribute__((target("avx,f16c")))
+    void half_f16c(const float *src, std::uint16_t *dst, std::size_t count) noexcept {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), h);
+        }
+        half_scalar(src + i, dst + i, count - i);
+    }
+
+    // 4 rgb pixels (12 of the 16 loaded bytes) -> 4 rgba pixels, 0x80 zeroes the alpha slot
+    template<int R, int B>
+    __attribute__((target("ssse3")))
+    __m128i expand_mask() noexcept {
+        constexpr char r = R == 0 ? 0 : 2;
+        constexpr char b = B == 0 ? 0 : 2;
+        return _mm_setr_epi8(
+            r, 1, b, -128, r + 3, 4, b + 3, -128, r + 6, 7, b + 6, -128, r + 9, 10, b + 9, -128
+        );
+    }
+
+    template<int R, int B>
+    __attribute__((target("ssse3")))
+    void expand_ssse3(const std::uint8_t *src, std::uint8_t *dst, std::size_t count, std::uint8_t alpha) noexcept {
+        const __m128i mask = expand_mask<R, B>();
+        const __m128i a = _mm_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(alpha) << 24));
+
+        std::size_t i = 0;
+        // 16-byte loads read 4 bytes past the 4 pixels: stop while 6 pixels remain
+        for (; i + 6 <= count; i += 4) {
+            const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(px, mask), a));
+        }
+        expand_scalar<R, B>(src + i * 3, dst + i * 4, count - i, alpha);
+    }
+
+    template<int R, int B>
+    __attribute__((target("avx2")))
+    void expand_avx2(const std::uint8_t *src, std::uint8_t *dst, std::size_t count, std::uint8_t alpha) noexcept {
+        const __m128i m = expand_mask<R, B>();
+        const __m256i mask = _mm256_broadcastsi128_si256(m);
+        const __m256i a = _mm256_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(alpha) << 24));
+
+        std::size_t i = 0;
+        // 8 pixels: two 12-byte groups, one per 128-bit lane (pshufb does not cross lanes)
+        for (; i + 10 <= count; i += 8) {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3 + 12));
+            const __m256i px = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(px, mask), a)
+            );
+        }
+        expand_ssse3<R, B>(src + i * 3, dst + i * 4, count - i, alpha);
+    }
+
+    // 16-bit lanes: c * a, alpha multiplied by 255 so div255 keeps it
+    __attribute__((target("ssse3")))
+    __m128i premultiply_half(__m128i px16) noexcept {
+        const __m128i alpha_mask = _mm_setr_epi8(6, 7, 6, 7, 6, 7, -128, -128, 14, 15, 14, 15, 14, 15, -128, -128);
+        const __m128i alpha_one = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+
+        const __m128i a = _mm_or_si128(_mm_shuffle_epi8(px16, alpha_mask), alpha_one);
+        __m128i v = _mm_add_epi16(_mm_mullo_epi16(px16, a), _mm_set1_epi16(128));
+        v = _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+        return v;
+    }
+
+    __attribute__((target("ssse3")))
+    void premultiply_ssse3(std::uint8_t *pixels, std::size_t count) noexcept {
+        const __m128i zero = _mm_setzero_si128();
+
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            auto *p = reinterpret_cast<__m128i *>(pixels + i * 4);
+            const __m128i px = _mm_loadu_si128(p);
+            const __m128i lo = premultiply_half(_mm_unpacklo_epi8(px, zero));
+            const __m128i hi = premultiply_half(_mm_unpackhi_epi8(px, zero));
+            _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+        }
+        premultiply_scalar(pixels + i * 4, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    __m256i premultiply_half_avx2(__m256i px16) noexcept {
+        const __m256i alpha_mask = _mm256_setr_epi8(
+            6, 7, 6, 7, 6, 7, -128, -128, 14, 15, 14, 15, 14, 15, -128, -128,
+            6, 7, 6, 7, 6, 7, -128, -128, 14, 15, 14, 15, 14, 15, -128, -128
+        );
+        const __m256i alpha_one = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+
+        const __m256i a = _mm256_or_si256(_mm256_shuffle_epi8(px16, alpha_mask), alpha_one);
+        __m256i v = _mm256_add_epi16(_mm256_mullo_epi16(px16, a), _mm256_set1_epi16(128));
+        v = _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), 8);
+        return v;
+    }
+
+    __attribute__((target("avx2")))
+    void premultiply_avx2(std::uint8_t *pixels, std::size_t count) noexcept {
+        const __m256i zero = _mm256_setzero_si256();
+
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto *p = reinterpret_cast<__m256i *>(pixels + i * 4);
+            const __m256i px = _mm256_loadu_si256(p);
+            // unpack/pack both work per 128-bit lane, so the pixel order survives the round trip
+            const __m256i lo = premultiply_half_avx2(_mm256_unpacklo_epi8(px, zero));
+            const __m256i hi = premultiply_half_avx2(_mm256_unpackhi_epi8(px, zero));
+            _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+        }
+        premultiply_ssse3(pixels + i * 4, count - i);
+    }
+#endif
+#endif
+
+    struct kernels {
+        expand_fn to_rgba = expand_scalar<0, 2>;
+        expand_fn to_bgra = expand_scalar<2, 0>;
+        premultiply_fn premultiply = premultiply_scalar;
+        half_fn to_half = half_scalar;
+        const char *isa = "scalar";
+    };
+
+    const kernels &active() noexcept {
+        static const kernels k = [] {
+            kernels r;
+#if defined(SGL_PIXEL_X86) && defined(__GNUC__)
+            if (__builtin_cpu_supports("avx2")) {
+                r = {expand_avx2<0, 2>, expand_avx2<2, 0>, premultiply_avx2, half_scalar, "avx2"};
+            } else if (__builtin_cpu_supports("ssse3")) {
+                r = {expand_ssse3<0, 2>, expand_ssse3<2, 0>, premultiply_ssse3, half_scalar, "ssse3"};
+            }
+            if (__builtin_cpu_supports("f16c")) {
+                r.to_half = half_f16c;
+            }
+#endif
+            return r;
+        }();
+        return k;
+    }
+
+    struct srgb_tables {
+        std::array<std::uint8_t, 256> to_linear{};
+        std::array<std::uint8_t, 256> to_srgb{};
+    };
+
+    const srgb_tables &tables() noexcept {
+        static const srgb_tables t = [] {
+            srgb_tables r;
+            for (int i = 0; i < 256; ++i) {
+                const float c = static_cast<float>(i) / 255.f;
+                const float l = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                const float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.f / 2.4f) - 0.055f;
+                r.to_linear[i] = static_cast<std::uint8_t>(std::clamp(l * 255.f + 0.5f, 0.f, 255.f));
+                r.to_srgb[i] = static_cast<std::uint8_t>(std::clamp(s * 255.f + 0.5f, 0.f, 255.f));
+            }
+            return r;
+        }();
+        return t;
+    }
+
+    // a table lookup per byte: gathers are slower than scalar loads from L1 here
+    void apply_table(
+        std::uint8_t *pixels, sgl::gl_int channels, std::size_t count, const std::array<std::uint8_t, 256> &t
+    ) noexcept {
+        const sgl::gl_int color = channels == 2 || channels == 4 ? channels - 1 : channels;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint8_t *p = pixels + i * channels;
+            for (sgl::gl_int c = 0; c < color; ++c) {
+                p[c] = t[p[c]];
+            }
+        }
+    }
+}
+
+namespace sgl {
+    void rgb_to_rgba(const std::uint8_t *src, std::uint8_t *dst, std::size_t count, std::uint8_t alpha) noexcept {
+        active().to_rgba(src, dst, count, alpha);
+    }
+
+    void rgb_to_bgra(const std::uint8_t *src, std::uint8_t *dst, std::size_t count, std::uint8_t alpha) noexcept {
+        active().to_bgra(src, dst, count, alpha);
+    }
+
+    void premultiply_rgba(std::uint8_t *pixels, std::size_t count) noexcept {
+        active().premultiply(pixels, count);
+    }
+
+    void extract_channel(
+        const std::uint8_t *src, gl_int channels, gl_int channel, std::uint8_t *dst, std::size_t count
+    ) noexcept {
+        // strided byte loads already run at memory speed, the compiler vectorizes the fixed-stride cases
+        switch (channels) {
+            case 3:
+                for (std::size_t i = 0; i < count; ++i) {
+                    dst[i] = src[i * 3 + channel];
+                }
+                break;
+            case 4:
+                for (std::size_t i = 0; i < count; ++i) {
+                    dst[i] = src[i * 4 + channel];
+                }
+                break;
+            default:
+                for (std::size_t i = 0; i < count; ++i) {
+                    dst[i] = src[i * channels + channel];
+                }
+                break;
+        }
+    }
+
+    void srgb_to_linear(std::uint8_t *pixels, gl_int channels, std::size_t count) noexcept {
+        apply_table(pixels, channels, count, tables().to_linear);
+    }
+
+    void linear_to_srgb(std::uint8_t *pixels, gl_int channels, std::size_t count) noexcept {
+        apply_table(pixels, channels, count, tables().to_srgb);
+    }
+
+    void float_to_half(const float *src, std::uint16_t *dst, std::size_t count) noexcept {
+        active().to_half(src, dst, count);
+    }
+
+    void pack_r11g11b10f(const float *src, gl_int channels, std::uint32_t *dst, std::size_t count) noexcept {
+        // no SIMD form of this format: three scalar conversions per texel
+        for (std::size_t i = 0; i < count; ++i) {
+            const float *p = src + i * channels;
+            dst[i] = unsigned_small_float(p[0], 6) |
+                     unsigned_small_float(p[1], 6) << 11 |
+                     unsigned_small_float(p[2], 5) << 22;
+        }
+    }
+
+    const char *pixel_convert_isa() noexcept {
+        return active().isa;
+    }
+}
@@ -0,0 +1,303 @@
+#include "internal/sgl_png.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <utility>
+
+#include "internal/sgl_job.h"
+#include "internal/sgl_log.h"
+
+namespace {
+    // crc32 / adler32
+
+    const std::array<std::uint32_t, 256> &crc_table() noexcept {
+        static const std::array<std::uint32_t, 256> table = [] {
+            std::array<std::uint32_t, 256> t{};
+            for (std::uint32_t n = 0; n < 256; ++n) {
+                std::uint32_t c = n;
+                for (int k = 0; k < 8; ++k) {
+                    c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[n] = c;
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    std::uint32_t crc32(const std::uint8_t *data, std::size_t len, std::uint32_t crc = 0) noexcept {
+        const auto &t = crc_table();
+        crc = ~crc;
+        for (std::size_t i = 0; i < len; ++i) {
+            crc = t[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    std::uint32_t adler32(const std::uint8_t *data, std::size_t len) noexcept {
+        constexpr std::uint32_t mod = 65521;
+        std::uint32_t a = 1, b = 0;
+        while (len > 0) {
+            // 5552 is the largest block that cannot overflow before the modulo
+            const std::size_t n = len < 5552 ? len : 5552;
+            for (std::size_t i = 0; i < n; ++i) {
+                a += data[i];
+                b += a;
+            }
+            a %= mod;
+            b %= mod;
+            data += n;
+            len -= n;
+        }
+        return b << 16 | a;
+    }
+
+    // deflate: greedy LZ77 over a single-entry hash table, fixed huffman codes
+
+    class bit_writer {
+    public:
+        explicit bit_writer(std::vector<std::uint8_t> &out) noexcept : m_out{out} {
+        }
+
+        void put(std::uint32_t bits, int count) {
+            m_acc |= bits << m_count;
+            m_count += count;
+            while (m_count >= 8) {
+                m_out.push_back(static_cast<std::uint8_t>(m_acc));
+                m_acc >>= 8;
+                m_count -= 8;
+            }
+        }
+
+        // huffman codes go MSB first
+        void put_code(std::uint32_t code, int count) {
+            std::uint32_t rev = 0;
+            for (int i = 0; i < count; ++i) {
+                rev = rev << 1 | (code >> i & 1);
+            }
+            put(rev, count);
+        }
+
+        void flush() {
+            if (m_count > 0) {
+                m_out.push_back(static_cast<std::uint8_t>(m_acc));
+            }
+            m_acc = 0;
+            m_count = 0;
+        }
+
+    private:
+        std::vector<std::uint8_t> &m_out;
+        std::uint32_t m_acc = 0;
+        int m_count = 0;
+    };
+
+    constexpr std::array<std::uint16_t, 29> len_base{
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    constexpr std::array<std::uint8_t, 29> len_extra{
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    constexpr std::array<std::uint16_t, 30> dist_base{
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+        6145, 8193, 12289, 16385, 24577
+    };
+    constexpr std::array<std::uint8_t, 30> dist_extra{
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+    };
+
+    void put_litlen(bit_writer &bw, int sym) {
+        if (sym < 144) {
+            bw.put_code(0x30 + sym, 8);
+        } else if (sym < 256) {
+            bw.put_code(0x190 + sym - 144, 9);
+        } else if (sym < 280) {
+            bw.put_code(sym - 256, 7);
+        } else {
+            bw.put_code(0xC0 + sym - 280, 8);
+        }
+    }
+
+    void put_match(bit_writer &bw, int len, int dist) {
+        int li = 28;
+        while (len_base[li] > len) {
+            --li;
+        }
+        put_litlen(bw, 257 + li);
+        bw.put(static_cast<std::uint32_t>(len - len_base[li]), len_extra[li]);
+
+        int di = 29;
+        while (dist_base[di] > dist) {
+            --di;
+        }
+        bw.put_code(static_cast<std::uint32_t>(di), 5);
+        bw.put(static_cast<std::uint32_t>(dist - dist_base[di]), dist_extra[di]);
+    }
+
+    void deflate(const std::uint8_t *data, std::size_t len, std::vector<std::uint8_t> &out) {
+        constexpr int hash_bits = 15;
+        constexpr std::size_t window = 32768;
+        constexpr std::size_t max_match = 258;
+
+        std::vector<std::int64_t> head(std::size_t{1} << hash_bits, -1);
+        const auto hash = [data](std::size_t i) {
+            const std::uint32_t v = data[i] | data[i + 1] << 8 | data[i + 2] << 16;
+            return (v * 2654435761u) >> (32 - hash_bits);
+        };
+
+        bit_writer bw{out};
+        bw.put(1, 1); // final block
+        bw.put(1, 2); // fixed huffman
+
+        std::size_t i = 0;
+        while (i < len) {
+            std::size_t best = 0;
+            std::size_t dist = 0;
+
+            if (i + 3 <= len) {
+                const auto h = hash(i);
+                const std::int64_t cand = head[h];
+                head[h] = static_cast<std::int64_t>(i);
+
+                if (cand >= 0 && i - static_cast<std::size_t>(cand) <= window) {
+                    const auto c = static_cast<std::size_t>(cand);
+                    const std::size_t limit = std::min(max_match, len - i);
+                    while (best < limit && data[c + best] == data[i + best]) {
+                        ++best;
+                    }
+                    dist = i - c;
+                }
+            }
+
+            if (best >= 3) {
+                put_match(bw, static_cast<int>(best), static_cast<int>(dist));
+                // keep the hash warm inside the match
+                for (std::size_t k = i + 1; k < i + best && k + 3 <= len; ++k) {
+                    head[hash(k)] = static_cast<std::int64_t>(k);
+                }
+                i += best;
+            } else {
+                put_litlen(bw, data[i]);
+                ++i;
+            }
+        }
+
+        put_litlen(bw, 256); // end of block
+        bw.flush();
+    }
+
+    void put_u32_be(std::vector<std::uint8_t> &out, std::uint32_t v) {
+        out.push_back(static_cast<std::uint8_t>(v >> 24));
+        out.push_back(static_cast<std::uint8_t>(v >> 16));
+        out.push_back(static_cast<std::uint8_t>(v >> 8));
+        out.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    void put_chunk(std::vector<std::uint8_t> &out, const char *type, const std::uint8_t *data, std::size_t len) {
+        put_u32_be(out, static_cast<std::uint32_t>(len));
+        const std::size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        if (len > 0) {
+            out.insert(out.end(), data, data + len);
+        }
+        put_u32_be(out, crc32(out.data() + start, len + 4));
+    }
+
+    constexpr std::uint8_t color_type_for(sgl::gl_int channels) noexcept {
+        switch (channels) {
+            case 1: return 0; // gray
+            case 2: return 4; // gray + alpha
+            case 3: return 2; // rgb
+            default: return 6; // rgba
+        }
+    }
+}
+
+namespace sgl {
+    bool encode_png(
+        const std::uint8_t *pixels, gl_sizei width, gl_sizei height, gl_int channels, std::vector<std::uint8_t> &out
+    ) noexcept {
+        if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+            return false;
+        }
+
+        const std::size_t stride = static_cast<std::size_t>(width) * channels;
+
+        // "sub" filter on every row: cheap and compresses gradients well
+        std::vector<std::uint8_t> filtered((stride + 1) * height);
+        for (gl_sizei y = 0; y < height; ++y) {
+            const std::uint8_t *src = pixels + y * stride;
+            std::uint8_t *dst = filtered.data() + y * (stride + 1);
+            dst[0] = 1;
+            for (std::size_t x = 0; x < stride; ++x) {
+                const std::uint8_t left = x >= static_cast<std::size_t>(channels) ? src[x - channels] : 0;
+                dst[x + 1] = static_cast<std::uint8_t>(src[x] - left);
+            }
+        }
+
+        std::vector<std::uint8_t> z;
+        z.reserve(filtered.size() / 2);
+        z.push_back(0x78); // zlib: deflate, 32k window
+        z.push_back(0x01);
+        deflate(filtered.data(), filtered.size(), z);
+        put_u32_be(z, adler32(filtered.data(), filtered.size()));
+
+        const auto w = static_cast<std::uint32_t>(width);
+        const auto h = static_cast<std::uint32_t>(height);
+        const std::array<std::uint8_t, 13> ihdr{
+            static_cast<std::uint8_t>(w >> 24), static_cast<std::uint8_t>(w >> 16),
+            static_cast<std::uint8_t>(w >> 8), static_cast<std::uint8_t>(w),
+            static_cast<std::uint8_t>(h >> 24), static_cast<std::uint8_t>(h >> 16),
+            static_cast<std::uint8_t>(h >> 8), static_cast<std::uint8_t>(h),
+            8, color_type_for(channels), 0, 0, 0
+        };
+
+        static constexpr std::array<std::uint8_t, 8> signature{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+        out.clear();
+        out.reserve(z.size() + 64);
+        out.insert(out.end(), signature.begin(), signature.end());
+        put_chunk(out, "IHDR", ihdr.data(), ihdr.size());
+        put_chunk(out, "IDAT", z.data(), z.size());
+        put_chunk(out, "IEND", nullptr, 0);
+
+        return true;
+    }
+
+    bool write_png(const char *path, const std::uint8_t *pixels, gl_sizei width, gl_sizei height, gl_int channels) noexcept {
+        if (!path) {
+            return false;
+        }
+
+        std::vector<std::uint8_t> png;
+        if (!encode_png(pixels, width, height, channels, png)) {
+            log_error(log_subsystem::texture, "write_png: invalid image for '{}'", path);
+            return false;
+        }
+
+        FILE *f = std::fopen(path, "wb");
+        if (!f) {
+            log_error(log_subsystem::texture, "write_png: failed to open '{}'", path);
+            return false;
+        }
+
+        const bool ok = std::fwrite(png.data(), 1, png.size(), f) == png.size();
+        std::fclose(f);
+
+        if (!ok) {
+            log_error(log_subsystem::texture, "write_png: failed to write '{}'", path);
+        }
+        return ok;
+    }
+
+    std::future<bool> write_png_async(
+        std::string path, std::vector<std::uint8_t> pixels, gl_sizei width, gl_sizei height, gl_int channels
+    ) noexcept {
+        return detail::async(
+            [path = std::move(path), pixels = std::move(pixels), width, height, channels] {
+                return write_png(path.c_str(), pixels.data(), width, height, channels);
+            }
+        );
+    }
+}
@@ -0,0 +1,250 @@
+#include "internal/sgl_profiler.h"
+
+#include <iterator>
+
+#include <fmt/format.h>
+
+#if SGL_PROFILER
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "internal/sgl_log.h"
+
+namespace {
+    static_assert((sgl::profiler_ring_size & (sgl::profiler_ring_size - 1)) == 0, "ring size must be a power of 2");
+
+    struct profiler_event {
+        const char *name;
+        std::uint64_t begin_ns;
+        std::uint64_t end_ns;
+        std::uint32_t depth;
+        std::uint32_t gpu;
+    };
+
+    // single producer (the owning thread), read by the exporter. head only grows, the exporter
+    // re-reads it after copying and discards whatever the producer may have overwritten meanwhile
+    struct thread_ring {
+        std::unique_ptr<profiler_event[]> events{new profiler_event[sgl::profiler_ring_size]};
+        std::atomic<std::uint64_t> head{0};
+        std::uint64_t tail = 0; // first event not cleared, g_rings_mutex
+        std::uint32_t id = 0;
+        std::string name; // g_rings_mutex
+    };
+
+    // rings outlive their threads so late exports still see them
+    std::mutex g_rings_mutex;
+    std::vector<std::unique_ptr<thread_ring> > g_rings;
+
+    thread_local thread_ring *t_ring = nullptr;
+
+    thread_ring &this_thread_ring() noexcept {
+        if (!t_ring) {
+            auto ring = std::make_unique<thread_ring>();
+            std::lock_guard lock{g_rings_mutex};
+            ring->id = static_cast<std::uint32_t>(g_rings.size() + 1);
+            ring->name = fmt::format("thread {}", ring->id);
+            t_ring = ring.get();
+            g_rings.push_back(std::move(ring));
+        }
+        return *t_ring;
+    }
+
+    struct snapshot {
+        std::uint32_t id;
+        std::string name;
+        std::vector<profiler_event> events;
+    };
+
+    // copies every thread's events still in its ring
+    std::vector<snapshot> snapshot_rings() {
+        std::vector<snapshot> threads;
+
+        std::lock_guard lock{g_rings_mutex};
+        threads.reserve(g_rings.size());
+        for (const auto &ring: g_rings) {
+            const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+            const std::uint64_t first = std::max(
+                ring->tail, head > sgl::profiler_ring_size ? head - sgl::profiler_ring_size : 0
+            );
+
+            snapshot snap{.id = ring->id, .name = ring->name, .events = {}};
+            snap.events.reserve(static_cast<std::size_t>(head - first));
+            for (std::uint64_t i = first; i < head; ++i) {
+                snap.events.push_back(ring->events[i & (sgl::profiler_ring_size - 1)]);
+            }
+
+            // the producer kept going while we copied: the oldest entries may be torn
+            const std::uint64_t head_after = ring->head.load(std::memory_order_acquire);
+            if (head_after > sgl::profiler_ring_size && head_after - sgl::profiler_ring_size > first) {
+                const auto torn = std::min<std::uint64_t>(head_after - sgl::profiler_ring_size - first,
+                                                          snap.events.size());
+                snap.events.erase(snap.events.begin(), snap.events.begin() + static_cast<std::ptrdiff_t>(torn));
+            }
+            threads.push_back(std::move(snap));
+        }
+        return threads;
+    }
+
+    void append_thread_name(std::string &out, int pid, const snapshot &t) {
+        fmt::format_to(std::back_inserter(out),
+                       R"(,{{"ph":"M","name":"thread_name","pid":{},"tid":{},"args":{{"name":)", pid, t.id);
+        sgl::detail::append_json_string(out, t.name);
+        out += "}}";
+    }
+
+    void append_event(std::string &out, const profiler_event &e, std::uint32_t tid, std::uint64_t origin_ns) {
+        out += R"(,{"ph":"X","name":)";
+        sgl::detail::append_json_string(out, e.name ? e.name : "?");
+        fmt::format_to(std::back_inserter(out), R"(,"pid":{},"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                       e.gpu ? 2 : 1, tid, static_cast<double>(e.begin_ns - origin_ns) * 1e-3,
+                       static_cast<double>(e.end_ns - e.begin_ns) * 1e-3);
+    }
+}
+
+namespace sgl {
+    void profiler_set_thread_name(const char *name) noexcept {
+        if (!name) {
+            return;
+        }
+        thread_ring &ring = this_thread_ring();
+        std::lock_guard lock{g_rings_mutex};
+        ring.name = name;
+    }
+
+    bool profiler_write_chrome_trace(const char *path) noexcept {
+        if (!path) {
+            return false;
+        }
+
+        const std::vector<snapshot> threads = snapshot_rings();
+
+        std::uint64_t origin = UINT64_MAX;
+        std::size_t total = 0;
+        for (const auto &t: threads) {
+            for (const auto &e: t.events) {
+                origin = std::min(origin, e.begin_ns);
+            }
+            total += t.events.size();
+        }
+
+        std::string out;
+        out.reserve(256 + total * 96);
+        out += R"({"displayTimeUnit":"ms","traceEvents":[)";
+        out += R"({"ph":"M","name":"process_name","pid":1,"tid":0,"args":{"name":"sgl cpu"}},)";
+        out += R"({"ph":"M","name":"process_name","pid":2,"tid":0,"args":{"name":"sgl gpu"}})";
+
+        for (const auto &t: threads) {
+            const bool has_gpu = std::any_of(t.events.begin(), t.events.end(), [](const auto &e) { return e.gpu; });
+            append_thread_name(out, 1, t);
+            if (has_gpu) {
+                append_thread_name(out, 2, t);
+            }
+
+            for (const auto &e: t.events) {
+                append_event(out, e, t.id, origin);
+            }
+        }
+        out += "]}\n";
+
+        FILE *f = std::fopen(path, "wb");
+        if (!f) {
+            log_error(log_subsystem::profiling, "profiler: failed to open '{}'", path);
+            return false;
+        }
+        const bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+        if (std::fclose(f) != 0 || !ok) {
+            log_error(log_subsystem::profiling, "profiler: failed to write '{}'", path);
+            return false;
+        }
+
+        log_info(log_subsystem::profiling, "profiler: wrote {} events from {} threads to '{}'",
+                 total, threads.size(), path);
+        return true;
+    }
+
+    void profiler_clear() noexcept {
+        std::lock_guard lock{g_rings_mutex};
+        for (const auto &ring: g_rings) {
+            ring->tail = ring->head.load(std::memory_order_acquire);
+        }
+    }
+
+    namespace detail {
+        void profiler_append_cpu_events(std::string &out, std::uint64_t begin_ns, std::uint64_t end_ns,
+                                        std::uint64_t origin_ns) noexcept {
+            for (const auto &t: snapshot_rings()) {
+                bool named = false;
+                for (const auto &e: t.events) {
+                    if (e.gpu || e.end_ns < begin_ns || e.begin_ns > end_ns || e.begin_ns < origin_ns) {
+                        continue;
+                    }
+                    if (!named) {
+                        append_thread_name(out, 1, t);
+                        named = true;
+                    }
+                    append_event(out, e, t.id, origin_ns);
+                }
+            }
+        }
+
+        void profiler_record(const char *name, std::uint64_t begin_ns, std::uint64_t end_ns, std::uint32_t depth,
+                             bool gpu) noexcept {
+            thread_ring &ring = this_thread_ring();
+            const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+            ring.events[head & (profiler_ring_size - 1)] = profiler_event{
+                .name = name, .begin_ns = begin_ns, .end_ns = end_ns, .depth = depth, .gpu = gpu ? 1u : 0u
+            };
+            ring.head.store(head + 1, std::memory_order_release);
+        }
+    }
+}
+
+#else
+
+#include "internal/sgl_log.h"
+
+namespace sgl {
+    void profiler_set_thread_name(const char *) noexcept {
+    }
+
+    bool profiler_write_chrome_trace(const char *path) noexcept {
+        log_warn(log_subsystem::profiling, "profiler: built without SGL_PROFILER, '{}' not written", path ? path : "");
+        return false;
+    }
+
+    void profiler_clear() noexcept {
+    }
+
+    namespace detail {
+        void profiler_append_cpu_events(std::string &, std::uint64_t, std::uint64_t, std::uint64_t) noexcept {
+        }
+
+        void profiler_record(const char *, std::uint64_t, std::uint64_t, std::uint32_t, bool) noexcept {
+        }
+    }
+}
+
+#endif
+
+namespace sgl::detail {
+    void append_json_string(std::string &out, std::string_view s) noexcept {
+        out += '"';
+        for (const char c: s) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+            } else {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+}
@@ -0,0 +1,213 @@
+#include "internal/sgl_qoi.h"
+
+#include <array>
+#include <cstring>
+
+namespace {
+    constexpr std::uint8_t op_index = 0x00; // 00xxxxxx
+    constexpr std::uint8_t op_diff = 0x40; // 01xxxxxx
+    constexpr std::uint8_t op_luma = 0x80; // 10xxxxxx
+    constexpr std::uint8_t op_run = 0xC0; // 11xxxxxx
+    constexpr std::uint8_t op_rgb = 0xFE;
+    constexpr std::uint8_t op_rgba = 0xFF;
+    constexpr std::uint8_t mask_2 = 0xC0;
+
+    constexpr std::size_t header_size = 14;
+    constexpr std::array<std::uint8_t, 8> padding{0, 0, 0, 0, 0, 0, 0, 1};
+
+    // qoi refuses images above 400 million pixels
+    constexpr std::uint64_t max_pixels = 400'000'000;
+
+    struct rgba {
+        std::uint8_t r = 0, g = 0, b = 0, a = 255;
+
+        bool operator==(const rgba &) const noexcept = default;
+    };
+
+    // the index starts all zero, alpha included: only the running pixel starts opaque
+    using color_index = std::array<rgba, 64>;
+
+    constexpr color_index empty_index() noexcept {
+        color_index index;
+        index.fill(rgba{0, 0, 0, 0});
+        return index;
+    }
+
+    constexpr std::size_t hash(const rgba &p) noexcept {
+        return (p.r * 3u + p.g * 5u + p.b * 7u + p.a * 11u) % 64u;
+    }
+
+    std::uint32_t read_u32_be(const std::uint8_t *p) noexcept {
+        return static_cast<std::uint32_t>(p[0]) << 24 | static_cast<std::uint32_t>(p[1]) << 16 |
+               static_cast<std::uint32_t>(p[2]) << 8 | p[3];
+    }
+
+    void put_u32_be(std::vector<std::uint8_t> &out, std::uint32_t v) {
+        out.push_back(static_cast<std::uint8_t>(v >> 24));
+        out.push_back(static_cast<std::uint8_t>(v >> 16));
+        out.push_back(static_cast<std::uint8_t>(v >> 8));
+        out.push_back(static_cast<std::uint8_t>(v));
+    }
+}
+
+namespace sgl {
+    bool is_qoi(const std::uint8_t *data, std::size_t size) noexcept {
+        return data && size >= header_size && std::memcmp(data, "qoif", 4) == 0;
+    }
+
+    bool decode_qoi(const std::uint8_t *data, std::size_t size, qoi_image &out) noexcept {
+        if (!is_qoi(data, size) || size < header_size + padding.size()) {
+            return false;
+        }
+
+        const std::uint32_t w = read_u32_be(data + 4);
+        const std::uint32_t h = read_u32_be(data + 8);
+        const std::uint8_t channels = data[12];
+        if (w == 0 || h == 0 || (channels != 3 && channels != 4) ||
+            static_cast<std::uint64_t>(w) * h > max_pixels) {
+            return false;
+        }
+
+        const std::size_t count = static_cast<std::size_t>(w) * h;
+        out.width = static_cast<gl_int>(w);
+        out.height = static_cast<gl_int>(h);
+        out.channels = channels;
+        out.pixels.resize(count * channels);
+
+        color_index index = empty_index();
+        rgba px{};
+        int run = 0;
+
+        const std::uint8_t *p = data + header_size;
+        const std::uint8_t *end = data + size - padding.size();
+        std::uint8_t *dst = out.pixels.data();
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (run > 0) {
+                --run;
+            } else if (p < end) {
+                const std::uint8_t b1 = *p++;
+
+                if (b1 == op_rgb) {
+                    if (end - p < 3) {
+                        return false;
+                    }
+                    px.r = p[0];
+                    px.g = p[1];
+                    px.b = p[2];
+                    p += 3;
+                } else if (b1 == op_rgba) {
+                    if (end - p < 4) {
+                        return false;
+                    }
+                    px = {p[0], p[1], p[2], p[3]};
+                    p += 4;
+                } else if ((b1 & mask_2) == op_index) {
+                    px = index[b1];
+                } else if ((b1 & mask_2) == op_diff) {
+                    px.r = static_cast<std::uint8_t>(px.r + ((b1 >> 4 & 0x03) - 2));
+                    px.g = static_cast<std::uint8_t>(px.g + ((b1 >> 2 & 0x03) - 2));
+                    px.b = static_cast<std::uint8_t>(px.b + ((b1 & 0x03) - 2));
+                } else if ((b1 & mask_2) == op_luma) {
+                    if (p >= end) {
+                        return false;
+                    }
+                    const std::uint8_t b2 = *p++;
+                    const int vg = (b1 & 0x3F) - 32;
+                    px.r = static_cast<std::uint8_t>(px.r + vg - 8 + (b2 >> 4 & 0x0F));
+                    px.g = static_cast<std::uint8_t>(px.g + vg);
+                    px.b = static_cast<std::uint8_t>(px.b + vg - 8 + (b2 & 0x0F));
+                } else {
+                    run = b1 & 0x3F;
+                }
+
+                index[hash(px)] = px;
+            } else {
+                return false;
+            }
+
+            dst[0] = px.r;
+            dst[1] = px.g;
+            dst[2] = px.b;
+            if (channels == 4) {
+                dst[3] = px.a;
+            }
+            dst += channels;
+        }
+
+        return true;
+    }
+
+    bool encode_qoi(
+        const std::uint8_t *pixels, gl_int width, gl_int height, gl_int channels, std::vector<std::uint8_t> &out
+    ) noexcept {
+        if (!pixels || width <= 0 || height <= 0 || (channels != 3 && channels != 4) ||
+            static_cast<std::uint64_t>(width) * height > max_pixels) {
+            return false;
+        }
+
+        const std::size_t count = static_cast<std::size_t>(width) * height;
+
+        out.clear();
+        out.reserve(header_size + count * (channels + 1) / 2 + padding.size());
+        out.insert(out.end(), {'q', 'o', 'i', 'f'});
+        put_u32_be(out, static_cast<std::uint32_t>(width));
+        put_u32_be(out, static_cast<std::uint32_t>(height));
+        out.push_back(static_cast<std::uint8_t>(channels));
+        out.push_back(0); // sRGB with linear alpha, informative only
+
+        color_index index = empty_index();
+        rgba prev{};
+        int run = 0;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint8_t *s = pixels + i * channels;
+            const rgba px{s[0], s[1], s[2], channels == 4 ? s[3] : std::uint8_t{255}};
+
+            if (px == prev) {
+                ++run;
+                if (run == 62 || i + 1 == count) {
+                    out.push_back(static_cast<std::uint8_t>(op_run | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0) {
+                out.push_back(static_cast<std::uint8_t>(op_run | (run - 1)));
+                run = 0;
+            }
+
+            const std::size_t h = hash(px);
+            if (index[h] == px) {
+                out.push_back(static_cast<std::uint8_t>(op_index | h));
+            } else {
+                index[h] = px;
+
+                if (px.a == prev.a) {
+                    const auto vr = static_cast<std::int8_t>(px.r - prev.r);
+                    const auto vg = static_cast<std::int8_t>(px.g - prev.g);
+                    const auto vb = static_cast<std::int8_t>(px.b - prev.b);
+                    const int vg_r = vr - vg;
+                    const int vg_b = vb - vg;
+
+                    if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                        out.push_back(static_cast<std::uint8_t>(op_diff | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2)));
+                    } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+                        out.push_back(static_cast<std::uint8_t>(op_luma | (vg + 32)));
+                        out.push_back(static_cast<std::uint8_t>((vg_r + 8) << 4 | (vg_b + 8)));
+                    } else {
+                        out.insert(out.end(), {op_rgb, px.r, px.g, px.b});
+                    }
+                } else {
+                    out.insert(out.end(), {op_rgba, px.r, px.g, px.b, px.a});
+                }
+            }
+
+            prev = px;
+        }
+
+        out.insert(out.end(), padding.begin(), padding.end());
+        return true;
+    }
+}
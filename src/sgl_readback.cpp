@@ -0,0 +1,251 @@
+#include "internal/sgl_readback.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <cassert>
+
+#include "glad/glad.h"
+
+#include "internal/sgl_framebuffer.h"
+#include "internal/sgl_log.h"
+#include "internal/sgl_log_deferred.h"
+
+namespace sgl {
+    // ctors and assignments
+
+    readback_queue::readback_queue(readback_queue &&other) noexcept : m_slots{std::move(other.m_slots)},
+                                                                      m_frame{other.m_frame},
+                                                                      m_next_seq{other.m_next_seq} {
+        other.m_slots.clear();
+    }
+
+    readback_queue &readback_queue::operator=(readback_queue &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        destroy();
+
+        m_slots = std::move(other.m_slots);
+        m_frame = other.m_frame;
+        m_next_seq = other.m_next_seq;
+        other.m_slots.clear();
+
+        return *this;
+    }
+
+    readback_queue::~readback_queue() {
+        destroy();
+    }
+
+    // fabrics
+
+    readback_queue::result readback_queue::create(const readback_params &params) noexcept {
+        if (params.ring_size <= 0) {
+            return unexpected{error::invalid_params};
+        }
+
+        readback_queue q;
+        q.m_slots.resize(static_cast<std::size_t>(params.ring_size));
+
+        for (auto &s: q.m_slots) {
+            glGenBuffers(1, &s.pbo);
+            if (s.pbo == 0) {
+                log_error(log_subsystem::buffer, "glGenBuffers() returned 0");
+                return unexpected{error::gl_gen_failed};
+            }
+        }
+
+        return q;
+    }
+
+    // try wrappers
+
+    readback_queue readback_queue::create_try(const readback_params &params) noexcept {
+        auto res = create(params);
+        if (!res) {
+            log_fatal("failed to create readback_queue: {}", err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
+    // api
+
+    bool readback_queue::request(gl_int x, gl_int y, gl_sizei width, gl_sizei height, readback_callback cb) noexcept {
+        if (width <= 0 || height <= 0 || !cb) {
+            return false;
+        }
+
+        const auto it = std::find_if(m_slots.begin(), m_slots.end(), [](const slot &s) { return !s.fence; });
+        if (it == m_slots.end()) {
+            SGL_DLOG_WARN(log_subsystem::buffer,
+                          "readback_queue::request: all {} slots in flight, request dropped", m_slots.size());
+            return false;
+        }
+
+        slot &s = *it;
+        const auto size = static_cast<gl_sizeiptr>(width) * height * 4;
+
+        GLint prev_pbo = 0;
+        glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prev_pbo);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        if (s.capacity < size) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            s.capacity = size;
+        }
+
+        // tightly packed rows whatever the caller left in the pack state
+        GLint prev_alignment = 0;
+        glGetIntegerv(GL_PACK_ALIGNMENT, &prev_alignment);
+
+        GLint prev_row_length = 0;
+        glGetIntegerv(GL_PACK_ROW_LENGTH, &prev_row_length);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+        glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        glPixelStorei(GL_PACK_ROW_LENGTH, prev_row_length);
+        glPixelStorei(GL_PACK_ALIGNMENT, prev_alignment);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, static_cast<GLuint>(prev_pbo));
+
+        s.width = width;
+        s.height = height;
+        s.frame = m_frame;
+        s.seq = m_next_seq++;
+        s.cb = std::move(cb);
+
+        return true;
+    }
+
+    bool readback_queue::request(const framebuffer &fb, readback_callback cb) noexcept {
+        if (fb.params().samples > 0) {
+            log_error(log_subsystem::buffer,
+                      "readback_queue::request: multisampled framebuffer, resolve it with blit_to() first");
+            return false;
+        }
+
+        GLint prev_read = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_read);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.id());
+        const bool ok = request(0, 0, fb.width(), fb.height(), std::move(cb));
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(prev_read));
+        return ok;
+    }
+
+    void readback_queue::poll() noexcept {
+        ++m_frame;
+
+        // deliver oldest first and stop at the first unfinished one to keep the order
+        while (slot *s = oldest_in_flight()) {
+            if (!deliver(*s, false)) {
+                return;
+            }
+        }
+    }
+
+    bool readback_queue::flush() noexcept {
+        while (slot *s = oldest_in_flight()) {
+            if (!deliver(*s, true)) {
+                // one bounded wait per request: the rest stays in flight for poll()
+                log_warn(log_subsystem::buffer, "readback_queue::flush: fence not signaled after 1s, {} still pending",
+                         in_flight());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::size_t readback_queue::in_flight() const noexcept {
+        return static_cast<std::size_t>(std::count_if(
+            m_slots.begin(), m_slots.end(), [](const slot &s) { return s.fence != nullptr; }
+        ));
+    }
+
+    // internal
+
+    readback_queue::slot *readback_queue::oldest_in_flight() noexcept {
+        slot *oldest = nullptr;
+        for (auto &s: m_slots) {
+            if (s.fence && (!oldest || s.seq < oldest->seq)) {
+                oldest = &s;
+            }
+        }
+        return oldest;
+    }
+
+    bool readback_queue::deliver(slot &s, bool wait) noexcept {
+        assert(s.fence);
+
+        auto fence = static_cast<GLsync>(s.fence);
+        constexpr GLuint64 wait_ns = 1'000'000'000;
+
+        const GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? wait_ns : 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return false;
+        }
+        if (status == GL_WAIT_FAILED) {
+            // drop the request instead of spinning on a broken fence forever
+            log_error(log_subsystem::buffer, "readback_queue: glClientWaitSync() failed, request dropped");
+            glDeleteSync(fence);
+            s.fence = nullptr;
+            s.cb = nullptr;
+            return true;
+        }
+
+        glDeleteSync(fence);
+        s.fence = nullptr;
+
+        readback_image image{.width = s.width, .height = s.height, .pixels = {}, .frame = s.frame};
+        const std::size_t stride = static_cast<std::size_t>(s.width) * 4;
+        const std::size_t size = stride * s.height;
+        image.pixels.resize(size);
+
+        GLint prev_pbo = 0;
+        glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prev_pbo);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        const auto *src = static_cast<const std::uint8_t *>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT)
+        );
+
+        if (src) {
+            // GL rows are bottom-up
+            for (gl_sizei y = 0; y < s.height; ++y) {
+                std::memcpy(image.pixels.data() + y * stride, src + (s.height - 1 - y) * stride, stride);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else {
+            log_error(log_subsystem::buffer, "readback_queue: glMapBufferRange() failed");
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, static_cast<GLuint>(prev_pbo));
+
+        auto cb = std::move(s.cb);
+        s.cb = nullptr;
+        if (src) {
+            cb(std::move(image));
+        }
+        return true;
+    }
+
+    void readback_queue::destroy() noexcept {
+        for (auto &s: m_slots) {
+            if (s.fence) {
+                glDeleteSync(static_cast<GLsync>(s.fence));
+                s.fence = nullptr;
+            }
+            if (s.pbo != 0) {
+                glDeleteBuffers(1, &s.pbo);
+                s.pbo = 0;
+            }
+        }
+        m_slots.clear();
+    }
+}
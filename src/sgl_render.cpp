@@ -1,11 +1,34 @@
 #include "internal/sgl_render.h"
 
+#include <cstdint>
+
 #include "glad/glad.h"
+#include "internal/sgl_metrics.h"
 #include "internal/sgl_type.h"
 
 namespace sgl::render {
     namespace detail {
         inline constexpr float inv_255 = 1.f / 255.f;
+
+        std::uint64_t triangle_count(gl_enum mode, gl_sizei count) noexcept {
+            switch (mode) {
+                case GL_TRIANGLES: return static_cast<std::uint64_t>(count / 3);
+                case GL_TRIANGLE_STRIP:
+                case GL_TRIANGLE_FAN: return count > 2 ? static_cast<std::uint64_t>(count - 2) : 0;
+                default: return 0;
+            }
+        }
+
+        void count_draw(gl_enum mode, gl_sizei count, gl_sizei instances) noexcept {
+            metrics::add(metrics::counter::draw_calls);
+            metrics::add(
+                metrics::counter::triangles, triangle_count(mode, count) * static_cast<std::uint64_t>(instances)
+            );
+        }
+
+        void count_state_change() noexcept {
+            metrics::add(metrics::counter::state_changes);
+        }
     }
 
     void set_clear_color(float r, float g, float b, float a) noexcept {
@@ -47,6 +70,7 @@ namespace sgl::render {
         } else {
             glDisable(GL_DEPTH_TEST);
         }
+        detail::count_state_change();
     }
 
     void enable_blend(bool enabled) noexcept {
@@ -55,25 +79,53 @@ namespace sgl::render {
         } else {
             glDisable(GL_BLEND);
         }
+        detail::count_state_change();
     }
 
     void set_viewport(int x, int y, int w, int h) noexcept {
         glViewport(x, y, w, h);
+        detail::count_state_change();
     }
 
     void set_polygon_mode_fill() noexcept {
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        detail::count_state_change();
     }
 
     void set_polygon_mode_line() noexcept {
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        detail::count_state_change();
     }
 
     void set_polygon_mode_point() noexcept {
         glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
+        detail::count_state_change();
     }
 
     void set_line_width(float width) noexcept {
         glLineWidth(width);
+        detail::count_state_change();
+    }
+
+    void draw_arrays(gl_enum mode, gl_int first, gl_sizei count) noexcept {
+        glDrawArrays(mode, first, count);
+        detail::count_draw(mode, count, 1);
+    }
+
+    void draw_arrays_instanced(gl_enum mode, gl_int first, gl_sizei count, gl_sizei instances) noexcept {
+        glDrawArraysInstanced(mode, first, count, instances);
+        detail::count_draw(mode, count, instances);
+    }
+
+    void draw_elements(gl_enum mode, gl_sizei count, gl_enum index_type, const void *offset) noexcept {
+        glDrawElements(mode, count, index_type, offset);
+        detail::count_draw(mode, count, 1);
+    }
+
+    void draw_elements_instanced(
+        gl_enum mode, gl_sizei count, gl_enum index_type, gl_sizei instances, const void *offset
+    ) noexcept {
+        glDrawElementsInstanced(mode, count, index_type, offset, instances);
+        detail::count_draw(mode, count, instances);
     }
 }
@@ -0,0 +1,113 @@
+#include "internal/sgl_sampler.h"
+
+#include <utility>
+#include <cassert>
+
+#include "glad/glad.h"
+
+#include "internal/sgl_log.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_texture_bind.h"
+
+namespace sgl {
+    // ctors and assignments
+
+    sampler::sampler(sampler &&other) noexcept : m_id{std::exchange(other.m_id, 0)}, m_params{other.m_params} {
+    }
+
+    sampler &sampler::operator=(sampler &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        destroy();
+
+        m_id = std::exchange(other.m_id, 0);
+        m_params = other.m_params;
+
+        return *this;
+    }
+
+    sampler::~sampler() {
+        destroy();
+    }
+
+    // fabrics
+
+    sampler::result sampler::create(const sampler_params &params) noexcept {
+        gl_uint id = 0;
+        glGenSamplers(1, &id);
+        if (id == 0) {
+            log_error(log_subsystem::texture, "glGenSamplers() returned 0");
+            return unexpected{error::gl_gen_failed};
+        }
+
+        glSamplerParameteri(id, GL_TEXTURE_WRAP_S, static_cast<GLint>(params.wrap_s));
+        glSamplerParameteri(id, GL_TEXTURE_WRAP_T, static_cast<GLint>(params.wrap_t));
+        glSamplerParameteri(id, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(params.min_filter));
+        glSamplerParameteri(id, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(params.mag_filter));
+
+        return sampler{id, params};
+    }
+
+    // try wrappers
+
+    sampler sampler::create_try(const sampler_params &params) noexcept {
+        auto res = create(params);
+        if (!res) {
+            log_fatal("failed to create sampler: {}", err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
+    // api
+
+    void sampler::bind(gl_uint unit) const noexcept {
+        assert(m_id);
+
+        glBindSampler(unit, m_id);
+        detail::on_sampler_bound(unit, m_id);
+        metrics::add(metrics::counter::state_changes);
+    }
+
+    void sampler::unbind(gl_uint unit) noexcept {
+        glBindSampler(unit, 0);
+        detail::on_sampler_bound(unit, 0);
+        metrics::add(metrics::counter::state_changes);
+    }
+
+    // internal
+
+    void sampler::destroy() noexcept {
+        if (m_id != 0) {
+            glDeleteSamplers(1, &m_id);
+            detail::on_sampler_deleted(m_id);
+            m_id = 0;
+        }
+    }
+
+    // sampler_cache
+
+    const sampler *sampler_cache::get(const sampler_params &params) noexcept {
+        const auto key = key_of(params);
+
+        if (const auto it = m_samplers.find(key); it != m_samplers.end()) {
+            return &it->second;
+        }
+
+        auto res = sampler::create(params);
+        if (!res) {
+            return nullptr;
+        }
+
+        return &m_samplers.emplace(key, std::move(*res)).first->second;
+    }
+
+    std::uint64_t sampler_cache::key_of(const sampler_params &params) noexcept {
+        // every field is a GL enum below 0x10000
+        return static_cast<std::uint64_t>(params.wrap_s) << 48 |
+               static_cast<std::uint64_t>(params.wrap_t) << 32 |
+               static_cast<std::uint64_t>(params.min_filter) << 16 |
+               static_cast<std::uint64_t>(params.mag_filter);
+    }
+}
@@ -7,7 +7,12 @@
 #include "glad/glad.h"
 
 #include "internal/sgl_log.h"
-#include "internal/sgl_file.h"
+#include "internal/sgl_log_deferred.h"
+#include "internal/sgl_flight_recorder.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_pack.h"
+#include "internal/sgl_profiler.h"
+#include "internal/sgl_shader_include.h"
 #include "internal/sgl_util.h"
 
 namespace sgl {
@@ -43,7 +48,7 @@ namespace sgl {
 
         const gl_uint program = glCreateProgram();
         if (!program) {
-            log_error("glCreateProgram() failed");
+            log_error(log_subsystem::shader, "glCreateProgram() failed");
             return unexpected{error::gl_create_program_failed};
         }
 
@@ -59,6 +64,8 @@ namespace sgl {
             return unexpected{error::gl_program_link_failed};
         }
 
+        metrics::add(metrics::counter::shaders_created);
+        flight_recorder::resource_created(flight_recorder::resource_kind::shader, program);
         return shader{program};
     }
 
@@ -67,6 +74,12 @@ namespace sgl {
             return unexpected{error::invalid_params};
         }
 
+        return create_from_source(std::string_view{vertex_src}, std::string_view{fragment_src});
+    }
+
+    shader::result shader::create_from_source(std::string_view vertex_src, std::string_view fragment_src) noexcept {
+        SGL_ZONE("shader::create_from_source");
+
         auto err = error::invalid_params;
 
         const gl_uint vs = compile_shader(GL_VERTEX_SHADER, vertex_src, err);
@@ -89,29 +102,44 @@ namespace sgl {
     }
 
     shader::result shader::create_from_files(const char *vertex_path, const char *fragment_path) noexcept {
+        SGL_ZONE("shader::create_from_files");
+
         if (!vertex_path || !fragment_path) {
             return unexpected{error::invalid_params};
         }
 
-        std::string vs_src;
-        std::string fs_src;
-
-        if (!detail::read_text_file(vertex_path, vs_src)) {
-            log_error("failed to read vertex shader file: {}", vertex_path);
+        // compiled straight from the file views, no intermediate strings
+        const auto vs_file = asset_file::create(vertex_path);
+        if (!vs_file) {
+            log_error(log_subsystem::shader, "failed to read vertex shader file: {}", vertex_path);
             return unexpected{error::file_io_failed};
         }
 
-        if (!detail::read_text_file(fragment_path, fs_src)) {
-            log_error("failed to read fragment shader file: {}", fragment_path);
+        const auto fs_file = asset_file::create(fragment_path);
+        if (!fs_file) {
+            log_error(log_subsystem::shader, "failed to read fragment shader file: {}", fragment_path);
             return unexpected{error::file_io_failed};
         }
 
         log_info(
+            log_subsystem::shader,
             "shader: loaded files vs='{}' ({} bytes), fs='{}' ({} bytes)",
-            vertex_path, vs_src.size(), fragment_path, fs_src.size()
+            vertex_path, vs_file->size(), fragment_path, fs_file->size()
         );
 
-        return create_from_source(vs_src, fs_src);
+        if (!has_shader_includes(vs_file->text()) && !has_shader_includes(fs_file->text())) {
+            return create_from_source(vs_file->text(), fs_file->text());
+        }
+
+        shader_source vs_src, fs_src;
+        std::string include_err;
+        if (!expand_shader_includes(vertex_path, vs_src, include_err) ||
+            !expand_shader_includes(fragment_path, fs_src, include_err)) {
+            log_error(log_subsystem::shader, "shader: {}", include_err);
+            return unexpected{error::file_io_failed};
+        }
+
+        return create_from_source(std::string_view{vs_src.text}, std::string_view{fs_src.text});
     }
 
     // try wrappers
@@ -134,6 +162,15 @@ namespace sgl {
         return std::move(*res);
     }
 
+    shader shader::create_from_source_try(std::string_view vertex_src, std::string_view fragment_src) noexcept {
+        auto res = create_from_source(vertex_src, fragment_src);
+        if (!res) {
+            const auto err = res.error();
+            log_fatal("failed to create shader from source: {}", err_to_str(err));
+        }
+        return std::move(*res);
+    }
+
     shader shader::create_from_files_try(const char *vertex_path, const char *fragment_path) noexcept {
         auto res = create_from_files(vertex_path, fragment_path);
         if (!res) {
@@ -152,6 +189,7 @@ namespace sgl {
         assert(m_program);
 
         glUseProgram(m_program);
+        metrics::add(metrics::counter::state_changes);
     }
 
     gl_int shader::uniform_loc(const char *name) const noexcept {
@@ -178,6 +216,7 @@ namespace sgl {
             return false;
         }
         glUniform1i(loc, v);
+        metrics::add(metrics::counter::uniform_uploads);
         return true;
     }
 
@@ -188,6 +227,7 @@ namespace sgl {
             return false;
         }
         glUniform1ui(loc, v);
+        metrics::add(metrics::counter::uniform_uploads);
         return true;
     }
 
@@ -198,6 +238,7 @@ namespace sgl {
             return false;
         }
         glUniform1f(loc, v);
+        metrics::add(metrics::counter::uniform_uploads);
         return true;
     }
 
@@ -210,6 +251,7 @@ namespace sgl {
             return false;
         }
         glUniform2fv(loc, count, v);
+        metrics::add(metrics::counter::uniform_uploads);
         return true;
     }
 
@@ -220,6 +262,7 @@ namespace sgl {
             return false;
         }
         glUniform3fv(loc, count, v);
+        metrics::add(metrics::counter::uniform_uploads);
         return true;
     }
 
@@ -230,6 +273,7 @@ namespace sgl {
             return false;
         }
         glUniform4fv(loc, count, v);
+        metrics::add(metrics::counter::uniform_uploads);
         return true;
     }
 
@@ -242,6 +286,7 @@ namespace sgl {
             return false;
         }
         glUniformMatrix3fv(loc, count, transpose, m);
+        metrics::add(metrics::counter::uniform_uploads);
         return true;
     }
 
@@ -252,6 +297,7 @@ namespace sgl {
             return false;
         }
         glUniformMatrix4fv(loc, count, transpose, m);
+        metrics::add(metrics::counter::uniform_uploads);
         return true;
     }
 
@@ -266,7 +312,7 @@ namespace sgl {
 
         const gl_int loc = uniform_loc(name);
         if (loc < 0) {
-            log_error("uniform '{}' not found", name);
+            SGL_DLOG_ERROR(log_subsystem::shader, "uniform '{}' not found", name);
             return false;
         }
 
@@ -282,7 +328,7 @@ namespace sgl {
 
         const gl_int loc = uniform_loc(name);
         if (loc < 0) {
-            log_error("uniform '{}' not found", name);
+            SGL_DLOG_ERROR(log_subsystem::shader, "uniform '{}' not found", name);
             return false;
         }
 
@@ -298,7 +344,7 @@ namespace sgl {
 
         const gl_int loc = uniform_loc(name);
         if (loc < 0) {
-            log_error("uniform '{}' not found", name);
+            SGL_DLOG_ERROR(log_subsystem::shader, "uniform '{}' not found", name);
             return false;
         }
 
@@ -316,7 +362,7 @@ namespace sgl {
 
         const gl_int loc = uniform_loc(name);
         if (loc < 0) {
-            log_error("uniform '{}' not found", name);
+            SGL_DLOG_ERROR(log_subsystem::shader, "uniform '{}' not found", name);
             return false;
         }
 
@@ -332,7 +378,7 @@ namespace sgl {
 
         const gl_int loc = uniform_loc(name);
         if (loc < 0) {
-            log_error("uniform '{}' not found", name);
+            SGL_DLOG_ERROR(log_subsystem::shader, "uniform '{}' not found", name);
             return false;
         }
 
@@ -348,7 +394,7 @@ namespace sgl {
 
         const gl_int loc = uniform_loc(name);
         if (loc < 0) {
-            log_error("uniform '{}' not found", name);
+            SGL_DLOG_ERROR(log_subsystem::shader, "uniform '{}' not found", name);
             return false;
         }
 
@@ -367,7 +413,7 @@ namespace sgl {
 
         const gl_int loc = uniform_loc(name);
         if (loc < 0) {
-            log_error("uniform '{}' not found", name);
+            SGL_DLOG_ERROR(log_subsystem::shader, "uniform '{}' not found", name);
             return false;
         }
 
@@ -384,7 +430,7 @@ namespace sgl {
 
         const gl_int loc = uniform_loc(name);
         if (loc < 0) {
-            log_error("uniform '{}' not found", name);
+            SGL_DLOG_ERROR(log_subsystem::shader, "uniform '{}' not found", name);
             return false;
         }
 
@@ -393,17 +439,23 @@ namespace sgl {
 
     // internal
 
-    gl_uint shader::compile_shader(gl_enum type, const char *src, error &out_err) noexcept {
-        SGL_VERIFY(src);
+    gl_uint shader::compile_shader(gl_enum type, std::string_view src, error &out_err) noexcept {
+        if (src.empty()) {
+            log_error(log_subsystem::shader, "shader: empty source");
+            out_err = type == GL_VERTEX_SHADER ? error::gl_vertex_compile_failed : error::gl_fragment_compile_failed;
+            return 0;
+        }
 
         const gl_uint shader = glCreateShader(type);
         if (!shader) {
-            log_error("glCreateShader() failed");
+            log_error(log_subsystem::shader, "glCreateShader() failed");
             out_err = error::gl_create_shader_failed;
             return 0;
         }
 
-        glShaderSource(shader, 1, &src, nullptr);
+        const char *src_ptr = src.data();
+        const auto src_len = static_cast<gl_int>(src.size());
+        glShaderSource(shader, 1, &src_ptr, &src_len);
         glCompileShader(shader);
 
         auto type_name = "SHADER";
@@ -454,7 +506,7 @@ namespace sgl {
         gl_sizei written = 0;
         glGetShaderInfoLog(shader_id, log_len, &written, log.data());
 
-        log_error("'{}' compilation failed:\n{}", type_name, log);
+        log_error(log_subsystem::shader, "'{}' compilation failed:\n{}", type_name, log);
         return false;
     }
 
@@ -478,7 +530,7 @@ namespace sgl {
         gl_sizei written = 0;
         glGetProgramInfoLog(program, log_len, &written, log.data());
 
-        log_error("shader program linking failed:\n{}", log);
+        log_error(log_subsystem::shader, "shader program linking failed:\n{}", log);
         return false;
     }
 
@@ -493,12 +545,12 @@ namespace sgl {
         assert(m_program);
 
         if (loc < 0) {
-            log_warn("shader::set_uniform: location < 0");
+            SGL_DLOG_WARN(log_subsystem::shader, "shader::set_uniform: location < 0");
             return false;
         }
 
         if (!is_valid()) {
-            log_error("shader::set_uniform: called on invalid program");
+            log_error(log_subsystem::shader, "shader::set_uniform: called on invalid program");
             return false;
         }
 
@@ -0,0 +1,123 @@
+#include "internal/sgl_shader_include.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#include "internal/sgl_pack.h"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr std::size_t max_depth = 16;
+
+    bool expand(
+        const fs::path &path, sgl::shader_source &out, std::vector<fs::path> &stack, int &next_id, std::string &error
+    ) {
+        if (stack.size() > max_depth || std::find(stack.begin(), stack.end(), path) != stack.end()) {
+            error = "include cycle at " + path.string();
+            return false;
+        }
+
+        const auto file = sgl::asset_file::create(path.string().c_str());
+        if (!file) {
+            error = "cannot read " + path.string();
+            return false;
+        }
+
+        const int id = stack.empty() ? 0 : next_id++;
+        stack.push_back(path);
+        if (std::find(out.files.begin(), out.files.end(), path.string()) == out.files.end()) {
+            out.files.push_back(path.string());
+        }
+
+        const std::string_view text = file->text();
+        bool seen_version = stack.size() > 1; // includes sit below the #version of the shader
+        std::size_t line_no = 0;
+
+        for (std::size_t pos = 0; pos < text.size();) {
+            std::size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            std::string_view line = text.substr(pos, end - pos);
+            pos = end + 1;
+            ++line_no;
+
+            if (line.ends_with('\r')) {
+                line.remove_suffix(1);
+            }
+
+            const std::size_t first = line.find_first_not_of(" \t");
+            const std::string_view trimmed = first == std::string_view::npos ? std::string_view{} : line.substr(first);
+
+            if (trimmed.starts_with("#version")) {
+                seen_version = true;
+            }
+
+            if (!trimmed.starts_with("#include")) {
+                out.text.append(line);
+                out.text.push_back('\n');
+                continue;
+            }
+
+            const std::size_t q0 = trimmed.find('"');
+            const std::size_t q1 = q0 == std::string_view::npos ? q0 : trimmed.find('"', q0 + 1);
+            if (q1 == std::string_view::npos) {
+                error = path.string() + ":" + std::to_string(line_no) + ": malformed #include";
+                return false;
+            }
+            if (!seen_version) {
+                error = path.string() + ":" + std::to_string(line_no) + ": #include before #version";
+                return false;
+            }
+
+            const fs::path inc =
+                (path.parent_path() / std::string{trimmed.substr(q0 + 1, q1 - q0 - 1)}).lexically_normal();
+
+            // every file is pasted once (diamonds would redefine what it declares), cycles still fail below
+            if (std::find(stack.begin(), stack.end(), inc) == stack.end() &&
+                std::find(out.files.begin(), out.files.end(), inc.string()) != out.files.end()) {
+                out.text.push_back('\n');
+                continue;
+            }
+
+            out.text += "#line 1 " + std::to_string(next_id) + "\n";
+            if (!expand(inc, out, stack, next_id, error)) {
+                return false;
+            }
+            out.text += "#line " + std::to_string(line_no + 1) + " " + std::to_string(id) + "\n";
+        }
+
+        stack.pop_back();
+        return true;
+    }
+}
+
+namespace sgl {
+    bool expand_shader_includes(const char *path, shader_source &out, std::string &error) noexcept {
+        out = {};
+        if (!path) {
+            error = "path is null";
+            return false;
+        }
+
+        std::vector<fs::path> stack;
+        int next_id = 1;
+        return expand(fs::path{path}.lexically_normal(), out, stack, next_id, error);
+    }
+
+    bool has_shader_includes(std::string_view src) noexcept {
+        for (std::size_t pos = src.find("#include"); pos != std::string_view::npos;
+             pos = src.find("#include", pos + 1)) {
+            // only as the first token of a line
+            std::size_t i = pos;
+            while (i > 0 && (src[i - 1] == ' ' || src[i - 1] == '\t')) {
+                --i;
+            }
+            if (i == 0 || src[i - 1] == '\n') {
+                return true;
+            }
+        }
+        return false;
+    }
+}
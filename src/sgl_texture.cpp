@@ -1,6 +1,14 @@
 #include "internal/sgl_texture.h"
 
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string_view>
 #include <utility>
+#include <vector>
 #include <cassert>
 
 #include "glad/glad.h"
@@ -8,37 +16,177 @@
 #include "stb_image.h"
 
 #include "internal/sgl_log.h"
+#include "internal/sgl_flight_recorder.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_job.h"
+#include "internal/sgl_pixel_convert.h"
+#include "internal/sgl_profiler.h"
+#include "internal/sgl_pack.h"
+#include "internal/sgl_qoi.h"
+#include "internal/sgl_texture_bind.h"
 
 namespace {
-    constexpr sgl::gl_enum to_gl(sgl::texture_wrap wrap) noexcept {
-        switch (wrap) {
-            case sgl::texture_wrap::repeat: return GL_REPEAT;
-            case sgl::texture_wrap::mirrored_repeat: return GL_MIRRORED_REPEAT;
-            case sgl::texture_wrap::clamp_to_edge: return GL_CLAMP_TO_EDGE;
-            case sgl::texture_wrap::clamp_to_border: return GL_CLAMP_TO_BORDER;
+    // sampler enums carry their GL values
+    template<typename E>
+    constexpr GLint to_gl(E e) noexcept {
+        return static_cast<GLint>(e);
+    }
+
+    // GL_RGB rows get repacked by most drivers on the CPU: hand them 4-byte pixels instead.
+    // returns the pixels to upload and sets the client format that goes with them
+    const void *expand_rgb(
+        const void *pixels, GLsizei w, GLsizei h, GLenum &format, std::vector<std::uint8_t> &scratch
+    ) noexcept {
+        if (format != GL_RGB || !pixels) {
+            return pixels;
+        }
+
+        const std::size_t count = static_cast<std::size_t>(w) * h;
+        scratch.resize(count * 4);
+        sgl::rgb_to_rgba(static_cast<const std::uint8_t *>(pixels), scratch.data(), count);
+        format = GL_RGBA;
+        return scratch.data();
+    }
+
+    // GL_UNSIGNED_BYTE uploads
+    std::uint64_t upload_bytes(GLenum format, GLsizei w, GLsizei h) noexcept {
+        std::uint64_t channels = 4;
+        switch (format) {
+            case GL_RED: channels = 1; break;
+            case GL_RG: channels = 2; break;
+            case GL_RGB:
+            case GL_BGR: channels = 3; break;
+            default: break;
+        }
+        return static_cast<std::uint64_t>(w) * static_cast<std::uint64_t>(h) * channels;
+    }
+
+    bool needs_cpu_path(const sgl::texture_2d_params &params) noexcept {
+        return params.cpu_mipmaps || params.premultiply_alpha || params.compaction != sgl::texture_compaction::none;
+    }
+
+    // optional format compaction + mips, no GL
+    sgl::texture_2d_data make_data(
+        const std::uint8_t *pixels, int width, int height, int channels, const sgl::texture_2d_params &params
+    ) noexcept {
+        sgl::texture_2d_data data{.mips = {}, .params = params, .format = {}};
+        data.format.source_channels = channels;
+        data.format.channels = channels;
+
+        std::vector<std::uint8_t> packed;
+        if (params.compaction != sgl::texture_compaction::none) {
+            data.format = sgl::choose_texture_format(
+                sgl::analyze_pixels(pixels, width, height, channels), channels, params.srgb, params.compaction,
+                params.normal_map
+            );
+            packed = sgl::repack_pixels(pixels, width, height, data.format);
+            if (!packed.empty()) {
+                pixels = packed.data();
+            }
+        }
+
+        const sgl::mip_chain_params mip_params{
+            .srgb = params.srgb,
+            .premultiply_alpha = params.premultiply_alpha,
+            .max_levels = params.generate_mipmaps ? 0 : 1,
+        };
+        data.mips = sgl::build_mip_chain(pixels, width, height, data.format.channels, mip_params);
+
+        return data;
+    }
+
+    bool has_extension(const char *path, std::string_view ext) noexcept {
+        const std::string_view p{path};
+        return p.size() >= ext.size() && p.substr(p.size() - ext.size()) == ext;
+    }
+
+    void flip_rows(std::uint8_t *pixels, std::size_t stride, int height) noexcept {
+        std::vector<std::uint8_t> tmp(stride);
+        for (int y = 0; y < height / 2; ++y) {
+            std::uint8_t *a = pixels + static_cast<std::size_t>(y) * stride;
+            std::uint8_t *b = pixels + static_cast<std::size_t>(height - 1 - y) * stride;
+            std::memcpy(tmp.data(), a, stride);
+            std::memcpy(a, b, stride);
+            std::memcpy(b, tmp.data(), stride);
+        }
+    }
+
+    bool load_qoi(const char *path, bool flip, sgl::qoi_image &out) noexcept {
+        auto file = sgl::asset_file::create(path);
+        if (!file || !sgl::decode_qoi(file->data(), file->size(), out)) {
+            return false;
+        }
+        if (flip) {
+            flip_rows(out.pixels.data(), static_cast<std::size_t>(out.width) * out.channels, out.height);
         }
-        return GL_REPEAT;
+        return true;
     }
 
-    constexpr sgl::gl_enum to_gl(sgl::texture_min_filter f) noexcept {
-        switch (f) {
-            case sgl::texture_min_filter::nearest: return GL_NEAREST;
-            case sgl::texture_min_filter::linear: return GL_LINEAR;
-            case sgl::texture_min_filter::nearest_mipmap_nearest: return GL_NEAREST_MIPMAP_NEAREST;
-            case sgl::texture_min_filter::linear_mipmap_nearest: return GL_LINEAR_MIPMAP_NEAREST;
-            case sgl::texture_min_filter::nearest_mipmap_linear: return GL_NEAREST_MIPMAP_LINEAR;
-            case sgl::texture_min_filter::linear_mipmap_linear: return GL_LINEAR_MIPMAP_LINEAR;
+    // stb decodes from the file bytes instead of its own buffered stdio reads.
+    // the flip flag is per thread: loaders run on workers concurrently
+    stbi_uc *decode_stbi(
+        std::span<const std::uint8_t> bytes, bool flip, int &width, int &height, int &channels
+    ) noexcept {
+        if (bytes.empty() || bytes.size() > static_cast<std::size_t>(INT_MAX)) {
+            return nullptr;
         }
-        return GL_LINEAR;
+        stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
+        return stbi_load_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, &channels, 0);
     }
 
-    constexpr sgl::gl_enum to_gl(sgl::texture_mag_filter f) noexcept {
-        switch (f) {
-            case sgl::texture_mag_filter::nearest: return GL_NEAREST;
-            case sgl::texture_mag_filter::linear: return GL_LINEAR;
+    float *decode_stbi_hdr(
+        std::span<const std::uint8_t> bytes, bool flip, int &width, int &height, int &channels, int desired
+    ) noexcept {
+        if (bytes.empty() || bytes.size() > static_cast<std::size_t>(INT_MAX)) {
+            return nullptr;
         }
-        return GL_LINEAR;
+        stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
+        return stbi_loadf_from_memory(
+            bytes.data(), static_cast<int>(bytes.size()), &width, &height, &channels, desired
+        );
+    }
+
+    bool is_hdr_image(std::span<const std::uint8_t> bytes) noexcept {
+        return !bytes.empty() && bytes.size() <= static_cast<std::size_t>(INT_MAX) &&
+               stbi_is_hdr_from_memory(bytes.data(), static_cast<int>(bytes.size()));
+    }
+
+    // .sgltex: header, level table, then every level at a 16-byte aligned offset. little endian,
+    // pixels are exactly what glTexSubImage2D takes (1, 2 or 4 bytes, 3-channel images are stored as 4)
+
+    constexpr std::array<char, 4> sgltex_magic{'S', 'G', 'L', 'T'};
+    constexpr std::uint32_t sgltex_version = 1;
+    constexpr std::uint32_t sgltex_flag_srgb = 1u << 0;
+    constexpr std::uint32_t sgltex_flag_premultiplied = 1u << 1;
+    constexpr std::size_t sgltex_align = 16;
+
+    struct sgltex_header {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t channels;
+        std::uint32_t internal_format;
+        std::array<std::uint32_t, 4> swizzle;
+        std::uint32_t levels;
+        std::uint32_t flags;
+    };
+
+    struct sgltex_level {
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint32_t width;
+        std::uint32_t height;
+    };
+
+    static_assert(sizeof(sgltex_header) == 48 && sizeof(sgltex_level) == 24);
+
+    constexpr std::size_t align_up(std::size_t v) noexcept {
+        return (v + sgltex_align - 1) & ~(sgltex_align - 1);
     }
+
+    // running totals of create_from_data() compaction
+    sgl::texture_compaction_stats g_compaction_stats{};
 }
 
 namespace sgl {
@@ -48,6 +196,7 @@ namespace sgl {
         : m_id{std::exchange(other.m_id, 0)},
           m_width{std::exchange(other.m_width, 0)},
           m_height{std::exchange(other.m_height, 0)},
+          m_levels{std::exchange(other.m_levels, 0)},
           m_internal_format{std::exchange(other.m_internal_format, 0)},
           m_format{std::exchange(other.m_format, 0)} {
     }
@@ -62,6 +211,7 @@ namespace sgl {
         m_id = std::exchange(other.m_id, 0);
         m_width = std::exchange(other.m_width, 0);
         m_height = std::exchange(other.m_height, 0);
+        m_levels = std::exchange(other.m_levels, 0);
         m_internal_format = std::exchange(other.m_internal_format, 0);
         m_format = std::exchange(other.m_format, 0);
 
@@ -80,25 +230,71 @@ namespace sgl {
     }
 
     texture_2d::result texture_2d::create_from_file(const char *path, const texture_2d_params &params) noexcept {
+        SGL_ZONE("texture_2d::create_from_file");
+
         if (!path) {
-            log_error("texture_2d::create_from_file: path is null");
+            log_error(log_subsystem::texture, "texture_2d::create_from_file: path is null");
             return unexpected(error::invalid_params);
         }
 
+        if (has_extension(path, ".sgltex")) {
+            return create_from_sgltex(path, params);
+        }
+
+        if (has_extension(path, ".qoi")) {
+            qoi_image img;
+            if (!load_qoi(path, params.flip_vertically_on_load, img)) {
+                log_error(log_subsystem::texture, "texture_2d::create_from_file: failed to decode qoi image: {}", path);
+                return unexpected{error::file_invalid};
+            }
+            return create_from_pixels(img.pixels.data(), img.width, img.height, img.channels, params);
+        }
+
         int width = 0, height = 0, nr_channels = 0;
+        stbi_uc *data = nullptr;
+        {
+            const auto file = asset_file::create(path);
+            if (!file) {
+                log_error(
+                    log_subsystem::texture,
+                    "texture_2d::create_from_file: failed to open '{}': {}",
+                    path, mapped_file::err_to_str(file.error())
+                );
+                return unexpected(error::stbi_load_failed);
+            }
+
+            if (is_hdr_image(file->bytes())) {
+                auto hdr = decode_hdr_data(file->bytes(), path, params);
+                if (!hdr) {
+                    return unexpected{hdr.error()};
+                }
+                return create_from_hdr_data(*hdr);
+            }
 
-        stbi_set_flip_vertically_on_load(params.flip_vertically_on_load ? 1 : 0);
+            data = decode_stbi(file->bytes(), params.flip_vertically_on_load, width, height, nr_channels);
+        }
 
-        stbi_uc *data = stbi_load(path, &width, &height, &nr_channels, 0);
         if (!data) {
-            log_error("texture_2d::create_from_file: failed to load image: {}", path);
+            log_error(log_subsystem::texture, "texture_2d::create_from_file: failed to load image: {}", path);
             return unexpected(error::stbi_load_failed);
         }
 
+        if (needs_cpu_path(params)) {
+            const texture_2d_data cpu = make_data(data, width, height, nr_channels, params);
+            stbi_image_free(data);
+
+            if (cpu.mips.levels.empty()) {
+                log_error(log_subsystem::texture, "texture_2d::create_from_file: unsupported image '{}' ({} channels)",
+                          path, nr_channels);
+                return unexpected{error::invalid_params};
+            }
+            return create_from_data(cpu);
+        }
+
         gl_uint id = 0;
         glGenTextures(1, &id);
         if (id == 0) {
-            log_error("texture_2d::create_from_file: glGenTextures() returned 0");
+            log_error(log_subsystem::texture, "texture_2d::create_from_file: glGenTextures() returned 0");
             stbi_image_free(data);
             return unexpected(error::gl_gen_failed);
         }
@@ -118,36 +314,25 @@ namespace sgl {
 
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-        GLenum format = 0;
-        GLint internal_format = 0;
+        gl_enum format = 0;
+        gl_int internal_format = 0;
 
-        switch (nr_channels) {
-            case 1:
-                format = GL_RED;
-                internal_format = GL_R8;
-                break;
-            case 2:
-                format = GL_RG;
-                internal_format = GL_RG8;
-                break;
-            case 3:
-                format = GL_RGB;
-                internal_format = params.srgb ? GL_SRGB8 : GL_RGB8;
-                break;
-            case 4:
-                format = GL_RGBA;
-                internal_format = params.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
-                break;
-            default:
-                log_error("texture_2d::create_from_file: unsupported channel count {}", nr_channels);
-                glPixelStorei(GL_UNPACK_ALIGNMENT, prev_alignment);
-                glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(prev_tex));
-                glDeleteTextures(1, &id);
-                stbi_image_free(data);
-                return unexpected{error::invalid_params};
+        if (!pick_formats(nr_channels, params.srgb, format, internal_format)) {
+            log_error(log_subsystem::texture, "texture_2d::create_from_file: unsupported channel count {}",
+                      nr_channels);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, prev_alignment);
+            glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(prev_tex));
+            glDeleteTextures(1, &id);
+            stbi_image_free(data);
+            return unexpected{error::invalid_params};
         }
 
-        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        std::vector<std::uint8_t> rgba;
+        GLenum upload_format = format;
+        const void *upload = expand_rgb(data, width, height, upload_format, rgba);
+
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, upload_format, GL_UNSIGNED_BYTE, upload);
+        metrics::add(metrics::counter::texture_bytes, upload_bytes(upload_format, width, height));
 
         if (params.generate_mipmaps) {
             glGenerateMipmap(GL_TEXTURE_2D);
@@ -160,9 +345,493 @@ namespace sgl {
         stbi_image_free(data);
 
         // TODO: expand info
-        log_info("texture_2d: loaded '{}' ({}x{})", path, width, height);
+        log_info(log_subsystem::texture, "texture_2d: loaded '{}' ({}x{})", path, width, height);
+
+        const gl_int levels = params.generate_mipmaps ? mip_level_count(width, height) : 1;
+        metrics::add(metrics::counter::textures_created);
+        flight_recorder::resource_created(flight_recorder::resource_kind::texture, id,
+                                          upload_bytes(upload_format, width, height));
+        return texture_2d{id, width, height, static_cast<gl_enum>(internal_format), format, levels};
+    }
+
+    texture_2d::result texture_2d::create_from_data(const texture_2d_data &data) noexcept {
+        SGL_ZONE("texture_2d::create_from_data");
+
+        const auto &levels = data.mips.levels;
+        if (levels.empty()) {
+            log_error(log_subsystem::texture, "texture_2d::create_from_data: empty mip chain");
+            return unexpected{error::invalid_params};
+        }
+
+        const auto &base = levels.front();
+        const auto &fmt = data.format;
+        auto res = create_empty(
+            base.width, base.height, data.mips.channels, static_cast<gl_int>(levels.size()), data.params,
+            fmt.internal_format
+        );
+        if (!res) {
+            return res;
+        }
+
+        // one bind and unpack setup for the whole chain, rgb levels share the scratch buffer
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        GLint prev_alignment = 0;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_alignment);
+
+        glBindTexture(GL_TEXTURE_2D, res->id());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        std::vector<std::uint8_t> rgba;
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            const auto level = static_cast<gl_int>(i);
+            const GLsizei w = std::max(1, res->width() >> level);
+            const GLsizei h = std::max(1, res->height() >> level);
+
+            GLenum format = res->format();
+            const void *upload = expand_rgb(levels[i].pixels.data(), w, h, format, rgba);
+
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, w, h, format, GL_UNSIGNED_BYTE, upload);
+            metrics::add(metrics::counter::texture_bytes, upload_bytes(format, w, h));
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, prev_alignment);
+        glBindTexture(GL_TEXTURE_2D, prev_tex);
+
+        if (!fmt.is_identity()) {
+            res->set_swizzle(fmt.swizzle);
+
+            // what the uncompacted source would have taken
+            gl_enum format = 0;
+            gl_int full_format = 0;
+            pick_formats(fmt.source_channels, data.params.srgb, format, full_format);
+
+            const gl_sizeiptr full = texture_vram_bytes(
+                static_cast<gl_enum>(full_format), res->width(), res->height(), res->levels()
+            );
+            const gl_sizeiptr saved = full - res->vram_bytes();
+
+            ++g_compaction_stats.textures;
+            g_compaction_stats.saved_bytes += saved;
+
+            log_info(
+                log_subsystem::texture,
+                "texture_2d: {}x{} stored as {} instead of {}, saved {} KiB ({} KiB total)",
+                res->width(), res->height(), internal_format_name(res->internal_format()),
+                internal_format_name(static_cast<gl_enum>(full_format)), saved / 1024,
+                g_compaction_stats.saved_bytes / 1024
+            );
+        }
+
+        return res;
+    }
+
+    texture_2d::result texture_2d::create_from_sgltex(const char *path, const texture_2d_params &params) noexcept {
+        if (!path) {
+            log_error(log_subsystem::texture, "texture_2d::create_from_sgltex: path is null");
+            return unexpected{error::invalid_params};
+        }
+
+        auto file = asset_file::create(path);
+        if (!file) {
+            log_error(log_subsystem::texture, "texture_2d::create_from_sgltex: failed to open '{}': {}",
+                      path, mapped_file::err_to_str(file.error()));
+            return unexpected{error::file_invalid};
+        }
+
+        const auto invalid = [path](const char *what) {
+            log_error(log_subsystem::texture, "texture_2d::create_from_sgltex: '{}': {}", path, what);
+            return unexpected{error::file_invalid};
+        };
+
+        sgltex_header header{};
+        if (file->size() < sizeof(header)) {
+            return invalid("truncated header");
+        }
+        std::memcpy(&header, file->data(), sizeof(header));
+
+        if (header.magic != sgltex_magic || header.version != sgltex_version) {
+            return invalid("not an sgltex file or unsupported version");
+        }
+
+        const auto width = static_cast<gl_int>(header.width);
+        const auto height = static_cast<gl_int>(header.height);
+        const auto levels = static_cast<gl_int>(header.levels);
+        const auto channels = static_cast<gl_int>(header.channels);
+
+        if (width <= 0 || height <= 0 || levels <= 0 || levels > mip_level_count(width, height) ||
+            (channels != 1 && channels != 2 && channels != 4) ||
+            file->size() < sizeof(header) + sizeof(sgltex_level) * header.levels) {
+            return invalid("bad header");
+        }
+
+        std::vector<sgltex_level> table(header.levels);
+        std::memcpy(table.data(), file->data() + sizeof(header), sizeof(sgltex_level) * table.size());
+
+        for (gl_int i = 0; i < levels; ++i) {
+            const auto &l = table[i];
+            const auto w = static_cast<std::uint32_t>(std::max(1, width >> i));
+            const auto h = static_cast<std::uint32_t>(std::max(1, height >> i));
+            if (l.width != w || l.height != h || l.size != static_cast<std::uint64_t>(w) * h * header.channels ||
+                l.offset > file->size() || l.size > file->size() - l.offset) {
+                return invalid("bad level table");
+            }
+        }
+
+        texture_2d_params p = params;
+        p.srgb = (header.flags & sgltex_flag_srgb) != 0;
+
+        auto res = create_empty(width, height, channels, levels, p, header.internal_format);
+        if (!res) {
+            return res;
+        }
+
+        // no decode and no copy: straight from the page cache into the driver
+        for (gl_int i = 0; i < levels; ++i) {
+            res->set_level_data(i, file->data() + table[i].offset);
+        }
+
+        const texture_format_choice identity{};
+        if (header.swizzle != identity.swizzle) {
+            res->set_swizzle(header.swizzle);
+        }
+
+        log_info(
+            log_subsystem::texture,
+            "texture_2d: loaded '{}' ({}x{}, {}, {} mips)",
+            path, width, height, internal_format_name(res->internal_format()), levels
+        );
+
+        return res;
+    }
+
+    texture_2d::result texture_2d::create_from_hdr_file(const char *path, const texture_2d_params &params) noexcept {
+        auto data = load_hdr_data(path, params);
+        if (!data) {
+            return unexpected{data.error()};
+        }
+        return create_from_hdr_data(*data);
+    }
+
+    texture_2d::result texture_2d::create_from_hdr_data(const texture_2d_hdr_data &data) noexcept {
+        const bool packed = data.params.hdr_format == texture_hdr_format::r11g11b10f;
+        const std::size_t texel = packed ? 4 : 8;
+
+        if (data.width <= 0 || data.height <= 0 ||
+            data.pixels.size() != static_cast<std::size_t>(data.width) * data.height * texel) {
+            log_error(log_subsystem::texture, "texture_2d::create_from_hdr_data: invalid data ({}x{}, {} bytes)",
+                data.width, data.height, data.pixels.size());
+            return unexpected{error::invalid_params};
+        }
+
+        const gl_int levels = data.params.generate_mipmaps ? mip_level_count(data.width, data.height) : 1;
+
+        auto res = create_empty(
+            data.width, data.height, packed ? 3 : 4, levels, data.params, static_cast<gl_enum>(data.params.hdr_format)
+        );
+        if (!res) {
+            return res;
+        }
+
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        GLint prev_alignment = 0;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_alignment);
+
+        // rows are tightly packed, whatever alignment the caller left set
+        glBindTexture(GL_TEXTURE_2D, res->id());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(
+            GL_TEXTURE_2D, 0, 0, 0, data.width, data.height, packed ? GL_RGB : GL_RGBA,
+            packed ? GL_UNSIGNED_INT_10F_11F_11F_REV : GL_HALF_FLOAT, data.pixels.data()
+        );
+        metrics::add(metrics::counter::texture_bytes, data.pixels.size());
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, prev_alignment);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(prev_tex));
+
+        res->generate_mipmaps();
+
+        return res;
+    }
+
+    texture_2d::result texture_2d::create_from_pixels(
+        const void *pixels, gl_int width, gl_int height, gl_int channels, const texture_2d_params &params
+    ) noexcept {
+        if (pixels && needs_cpu_path(params)) {
+            return create_from_data(make_data(static_cast<const std::uint8_t *>(pixels), width, height, channels, params));
+        }
+
+        const gl_int levels = params.generate_mipmaps && width > 0 && height > 0 ? mip_level_count(width, height) : 1;
+
+        auto res = create_empty(width, height, channels, levels, params);
+        if (!res || !pixels) {
+            return res;
+        }
+
+        res->set_level_data(0, pixels);
+        if (levels > 1) {
+            res->generate_mipmaps();
+        }
+
+        return res;
+    }
+
+    texture_2d::result texture_2d::create_empty(
+        gl_int width, gl_int height, gl_int channels, gl_int levels, const texture_2d_params &params,
+        gl_enum internal_format_override
+    ) noexcept {
+        if (width <= 0 || height <= 0 || levels <= 0 || levels > mip_level_count(width, height)) {
+            log_error(log_subsystem::texture, "texture_2d::create_empty: invalid size {}x{} with {} levels",
+                      width, height, levels);
+            return unexpected{error::invalid_params};
+        }
+
+        gl_enum format = 0;
+        gl_int internal_format = 0;
+        if (!pick_formats(channels, params.srgb, format, internal_format)) {
+            log_error(log_subsystem::texture, "texture_2d::create_empty: unsupported channel count {}", channels);
+            return unexpected{error::invalid_params};
+        }
+        if (internal_format_override != 0) {
+            internal_format = static_cast<gl_int>(internal_format_override);
+        }
+
+        gl_uint id = 0;
+        glGenTextures(1, &id);
+        if (id == 0) {
+            log_error(log_subsystem::texture, "texture_2d::create_empty: glGenTextures() returned 0");
+            return unexpected{error::gl_gen_failed};
+        }
+
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        glBindTexture(GL_TEXTURE_2D, id);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, to_gl(params.wrap_s));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, to_gl(params.wrap_t));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, to_gl(params.min_filter));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, to_gl(params.mag_filter));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+        for (gl_int i = 0; i < levels; ++i) {
+            glTexImage2D(
+                GL_TEXTURE_2D, i, internal_format, std::max(1, width >> i), std::max(1, height >> i), 0,
+                format, GL_UNSIGNED_BYTE, nullptr
+            );
+        }
+
+        glBindTexture(GL_TEXTURE_2D, prev_tex);
+
+        metrics::add(metrics::counter::textures_created);
+        flight_recorder::resource_created(flight_recorder::resource_kind::texture, id);
+        return texture_2d{id, width, height, static_cast<gl_enum>(internal_format), format, levels};
+    }
+
+    // cpu side
+
+    texture_2d::data_result texture_2d::load_data(const char *path, const texture_2d_params &params) noexcept {
+        if (!path) {
+            log_error(log_subsystem::texture, "texture_2d::load_data: path is null");
+            return unexpected{error::invalid_params};
+        }
+
+        int width = 0, height = 0, nr_channels = 0;
+        stbi_uc *pixels = nullptr;
+        qoi_image qoi;
+
+        if (has_extension(path, ".qoi")) {
+            if (!load_qoi(path, params.flip_vertically_on_load, qoi)) {
+                log_error(log_subsystem::texture, "texture_2d::load_data: failed to decode qoi image: {}", path);
+                return unexpected{error::file_invalid};
+            }
+            width = qoi.width;
+            height = qoi.height;
+            nr_channels = qoi.channels;
+        } else {
+            if (const auto file = asset_file::create(path)) {
+                pixels = decode_stbi(file->bytes(), params.flip_vertically_on_load, width, height, nr_channels);
+            }
+            if (!pixels) {
+                log_error(log_subsystem::texture, "texture_2d::load_data: failed to load image: {}", path);
+                return unexpected{error::stbi_load_failed};
+            }
+        }
+
+        texture_2d_data data = make_data(pixels ? pixels : qoi.pixels.data(), width, height, nr_channels, params);
+
+        if (pixels) {
+            stbi_image_free(pixels);
+        }
+
+        if (data.mips.levels.empty()) {
+            log_error(log_subsystem::texture, "texture_2d::load_data: unsupported image '{}' ({} channels)",
+                      path, nr_channels);
+            return unexpected{error::invalid_params};
+        }
+
+        log_info(
+            log_subsystem::texture,
+            "texture_2d: decoded '{}' ({}x{}, {} mips)",
+            path, width, height, data.mips.levels.size()
+        );
+
+        return data;
+    }
+
+    texture_2d::hdr_data_result texture_2d::load_hdr_data(const char *path, const texture_2d_params &params) noexcept {
+        if (!path) {
+            log_error(log_subsystem::texture, "texture_2d::load_hdr_data: path is null");
+            return unexpected{error::invalid_params};
+        }
+
+        const auto file = asset_file::create(path);
+        if (!file) {
+            log_error(log_subsystem::texture, "texture_2d::load_hdr_data: failed to load image: {}", path);
+            return unexpected{error::stbi_load_failed};
+        }
+        return decode_hdr_data(file->bytes(), path, params);
+    }
+
+    texture_2d::hdr_data_result texture_2d::decode_hdr_data(
+        std::span<const std::uint8_t> bytes, const char *path, const texture_2d_params &params
+    ) noexcept {
+        const bool packed = params.hdr_format == texture_hdr_format::r11g11b10f;
+        const int channels = packed ? 3 : 4;
+        int width = 0, height = 0, nr_channels = 0;
+
+        float *pixels = decode_stbi_hdr(bytes, params.flip_vertically_on_load, width, height, nr_channels, channels);
+        if (!pixels) {
+            log_error(log_subsystem::texture, "texture_2d::load_hdr_data: failed to load image: {}", path);
+            return unexpected{error::stbi_load_failed};
+        }
+
+        const std::size_t count = static_cast<std::size_t>(width) * height;
+        texture_2d_hdr_data data{.width = width, .height = height, .pixels = {}, .params = params};
+
+        // never the 16 bytes per texel of RGBA32F: halves are 8, the packed format 4
+        if (packed) {
+            data.pixels.resize(count * sizeof(std::uint32_t));
+            pack_r11g11b10f(pixels, channels, reinterpret_cast<std::uint32_t *>(data.pixels.data()), count);
+        } else {
+            data.pixels.resize(count * 4 * sizeof(std::uint16_t));
+            float_to_half(pixels, reinterpret_cast<std::uint16_t *>(data.pixels.data()), count * 4);
+        }
+
+        stbi_image_free(pixels);
+
+        log_info(
+            log_subsystem::texture,
+            "texture_2d: decoded '{}' ({}x{}, {})",
+            path, width, height, internal_format_name(static_cast<gl_enum>(params.hdr_format))
+        );
+
+        return data;
+    }
+
+    std::future<texture_2d::hdr_data_result> texture_2d::load_hdr_async(
+        const char *path, const texture_2d_params &params
+    ) noexcept {
+        return detail::async([p = std::string{path ? path : ""}, params] {
+            return load_hdr_data(p.c_str(), params);
+        });
+    }
+
+    bool texture_2d::write_sgltex(const char *path, const texture_2d_data &data) noexcept {
+        const auto &levels = data.mips.levels;
+        const gl_int src_channels = data.mips.channels;
+
+        gl_enum format = 0;
+        gl_int internal_format = 0;
+        if (!path || levels.empty() || !pick_formats(src_channels, data.params.srgb, format, internal_format)) {
+            log_error(log_subsystem::texture, "texture_2d::write_sgltex: invalid data");
+            return false;
+        }
+        if (data.format.internal_format != 0) {
+            internal_format = static_cast<gl_int>(data.format.internal_format);
+        }
+
+        // 3-byte pixels are the slow upload path, store them expanded
+        const gl_int channels = src_channels == 3 ? 4 : src_channels;
+
+        sgltex_header header{
+            .magic = sgltex_magic,
+            .version = sgltex_version,
+            .width = static_cast<std::uint32_t>(levels.front().width),
+            .height = static_cast<std::uint32_t>(levels.front().height),
+            .channels = static_cast<std::uint32_t>(channels),
+            .internal_format = static_cast<std::uint32_t>(internal_format),
+            .swizzle = data.format.swizzle,
+            .levels = static_cast<std::uint32_t>(levels.size()),
+            .flags = (data.params.srgb ? sgltex_flag_srgb : 0u) |
+                     (data.params.premultiply_alpha ? sgltex_flag_premultiplied : 0u),
+        };
+
+        std::vector<sgltex_level> table(levels.size());
+        std::size_t offset = align_up(sizeof(header) + sizeof(sgltex_level) * table.size());
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            const auto &l = levels[i];
+            table[i] = {
+                .offset = offset,
+                .size = static_cast<std::uint64_t>(l.width) * l.height * channels,
+                .width = static_cast<std::uint32_t>(l.width),
+                .height = static_cast<std::uint32_t>(l.height),
+            };
+            offset = align_up(offset + table[i].size);
+        }
+
+        FILE *f = std::fopen(path, "wb");
+        if (!f) {
+            log_error(log_subsystem::texture, "texture_2d::write_sgltex: failed to open '{}'", path);
+            return false;
+        }
 
-        return texture_2d{id, width, height, static_cast<gl_enum>(internal_format), format};
+        std::size_t pos = 0;
+        bool ok = true;
+        const auto write = [&](const void *p, std::size_t n) {
+            ok = ok && std::fwrite(p, 1, n, f) == n;
+            pos += n;
+        };
+        const auto pad_to = [&](std::size_t target) {
+            static constexpr std::array<std::uint8_t, sgltex_align> zeros{};
+            write(zeros.data(), target - pos);
+        };
+
+        write(&header, sizeof(header));
+        write(table.data(), sizeof(sgltex_level) * table.size());
+
+        std::vector<std::uint8_t> rgba;
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            pad_to(table[i].offset);
+
+            const auto &l = levels[i];
+            const std::uint8_t *pixels = l.pixels.data();
+            if (src_channels == 3) {
+                const std::size_t count = static_cast<std::size_t>(l.width) * l.height;
+                rgba.resize(count * 4);
+                rgb_to_rgba(pixels, rgba.data(), count);
+                pixels = rgba.data();
+            }
+            write(pixels, table[i].size);
+        }
+
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok) {
+            log_error(log_subsystem::texture, "texture_2d::write_sgltex: failed to write '{}'", path);
+        }
+        return ok;
+    }
+
+    std::future<texture_2d::data_result> texture_2d::load_async(
+        const char *path, const texture_2d_params &params
+    ) noexcept {
+        return detail::async([p = std::string{path ? path : ""}, params] {
+            return load_data(p.c_str(), params);
+        });
     }
 
     // try wrappers
@@ -183,6 +852,40 @@ namespace sgl {
         return std::move(*res);
     }
 
+    texture_2d texture_2d::create_from_data_try(const texture_2d_data &data) noexcept {
+        auto res = create_from_data(data);
+        if (!res) {
+            log_fatal("failed to create texture_2d from data: {}", err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
+    texture_2d texture_2d::create_from_hdr_file_try(const char *path, const texture_2d_params &params) noexcept {
+        auto res = create_from_hdr_file(path, params);
+        if (!res) {
+            log_fatal("failed to create texture_2d from '{}': {}", path, err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
+    texture_2d texture_2d::create_from_hdr_data_try(const texture_2d_hdr_data &data) noexcept {
+        auto res = create_from_hdr_data(data);
+        if (!res) {
+            log_fatal("failed to create texture_2d from hdr data: {}", err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
+    texture_2d texture_2d::create_from_pixels_try(
+        const void *pixels, gl_int width, gl_int height, gl_int channels, const texture_2d_params &params
+    ) noexcept {
+        auto res = create_from_pixels(pixels, width, height, channels, params);
+        if (!res) {
+            log_fatal("failed to create texture_2d from pixels: {}", err_to_str(res.error()));
+        }
+        return std::move(*res);
+    }
+
     // api
 
     void texture_2d::bind(gl_uint unit) const noexcept {
@@ -190,17 +893,147 @@ namespace sgl {
 
         glActiveTexture(GL_TEXTURE0 + unit);
         glBindTexture(GL_TEXTURE_2D, m_id);
+        detail::on_texture_bound(unit, m_id);
+        metrics::add(metrics::counter::state_changes);
     }
 
     void texture_2d::unbind(gl_uint unit) noexcept {
         glActiveTexture(GL_TEXTURE0 + unit);
         glBindTexture(GL_TEXTURE_2D, 0);
+        detail::on_texture_bound(unit, 0);
+        metrics::add(metrics::counter::state_changes);
+    }
+
+    void texture_2d::set_level_data(gl_int level, const void *pixels) const noexcept {
+        assert(m_id);
+        assert(level >= 0 && level < m_levels);
+
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        GLint prev_alignment = 0;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_alignment);
+
+        const GLsizei w = std::max(1, m_width >> level);
+        const GLsizei h = std::max(1, m_height >> level);
+
+        std::vector<std::uint8_t> rgba;
+        GLenum format = m_format;
+        const void *upload = expand_rgb(pixels, w, h, format, rgba);
+
+        glBindTexture(GL_TEXTURE_2D, m_id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, w, h, format, GL_UNSIGNED_BYTE, upload);
+        metrics::add(metrics::counter::texture_bytes, upload_bytes(format, w, h));
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, prev_alignment);
+        glBindTexture(GL_TEXTURE_2D, prev_tex);
+    }
+
+    void texture_2d::update_region(
+        gl_int x, gl_int y, gl_int width, gl_int height, const void *pixels, gl_int row_length, gl_enum format
+    ) const noexcept {
+        assert(m_id);
+        assert(x >= 0 && y >= 0 && x + width <= m_width && y + height <= m_height);
+
+        GLenum upload_format = format != 0 ? format : m_format;
+        const void *upload = pixels;
+        std::vector<std::uint8_t> rgba;
+        if (upload_format == GL_RGB && pixels) {
+            GLint pbo = 0;
+            glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &pbo);
+            if (pbo == 0) {
+                // strided rows: expand one at a time into a tight copy
+                const std::size_t stride = static_cast<std::size_t>(row_length > 0 ? row_length : width) * 3;
+                const std::size_t row = static_cast<std::size_t>(width) * 4;
+                rgba.resize(row * height);
+                for (gl_int r = 0; r < height; ++r) {
+                    rgb_to_rgba(static_cast<const std::uint8_t *>(pixels) + r * stride, rgba.data() + r * row,
+                                static_cast<std::size_t>(width));
+                }
+                upload = rgba.data();
+                upload_format = GL_RGBA;
+                row_length = 0;
+            }
+        }
+
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        GLint prev_alignment = 0;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_alignment);
+
+        GLint prev_row_length = 0;
+        glGetIntegerv(GL_UNPACK_ROW_LENGTH, &prev_row_length);
+
+        glBindTexture(GL_TEXTURE_2D, m_id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, upload_format, GL_UNSIGNED_BYTE, upload);
+        metrics::add(metrics::counter::texture_bytes, upload_bytes(upload_format, width, height));
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, prev_row_length);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, prev_alignment);
+        glBindTexture(GL_TEXTURE_2D, prev_tex);
+    }
+
+    void texture_2d::generate_mipmaps() const noexcept {
+        assert(m_id);
+
+        if (m_levels <= 1) {
+            return;
+        }
+
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        glBindTexture(GL_TEXTURE_2D, m_id);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glBindTexture(GL_TEXTURE_2D, prev_tex);
+    }
+
+    void texture_2d::set_swizzle(const std::array<gl_enum, 4> &swizzle) const noexcept {
+        assert(m_id);
+
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        const std::array<GLint, 4> values{
+            static_cast<GLint>(swizzle[0]), static_cast<GLint>(swizzle[1]),
+            static_cast<GLint>(swizzle[2]), static_cast<GLint>(swizzle[3])
+        };
+
+        glBindTexture(GL_TEXTURE_2D, m_id);
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, values.data());
+
+        glBindTexture(GL_TEXTURE_2D, prev_tex);
+    }
+
+    texture_compaction_stats texture_2d::compaction_stats() noexcept {
+        return g_compaction_stats;
+    }
+
+    void texture_2d::set_base_level(gl_int level) const noexcept {
+        assert(m_id);
+        assert(level >= 0 && level < m_levels);
+
+        GLint prev_tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_tex);
+
+        glBindTexture(GL_TEXTURE_2D, m_id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+
+        glBindTexture(GL_TEXTURE_2D, prev_tex);
     }
 
     constexpr const char *texture_2d::err_to_str(error e) noexcept {
         switch (e) {
             case error::invalid_params: return "invalid params";
             case error::stbi_load_failed: return "stbi_load() failed";
+            case error::file_invalid: return "unreadable or invalid texture file";
             case error::gl_gen_failed: return "glGenTextures() failed";
             default: return "unknown texture_error";
         }
@@ -208,12 +1041,37 @@ namespace sgl {
 
     // internal
 
+    bool texture_2d::pick_formats(int channels, bool srgb, gl_enum &format, gl_int &internal_format) noexcept {
+        switch (channels) {
+            case 1:
+                format = GL_RED;
+                internal_format = GL_R8;
+                return true;
+            case 2:
+                format = GL_RG;
+                internal_format = GL_RG8;
+                return true;
+            case 3:
+                format = GL_RGB;
+                internal_format = srgb ? GL_SRGB8 : GL_RGB8;
+                return true;
+            case 4:
+                format = GL_RGBA;
+                internal_format = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+                return true;
+            default:
+                return false;
+        }
+    }
+
     void texture_2d::destroy() noexcept {
         if (m_id != 0) {
             glDeleteTextures(1, &m_id);
+            detail::on_texture_deleted(m_id);
             m_id = 0;
             m_width = 0;
             m_height = 0;
+            m_levels = 0;
             m_internal_format = 0;
             m_format = 0;
         }
@@ -0,0 +1,152 @@
+#include "internal/sgl_texture_bind.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+#include "glad/glad.h"
+
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_texture.h"
+#include "internal/sgl_sampler.h"
+
+namespace {
+    constexpr std::size_t cached_units = 32;
+    constexpr sgl::gl_uint unknown = ~0u;
+
+    // last ids bound per unit through sgl, GL defaults on a fresh context
+    std::array<sgl::gl_uint, cached_units> g_textures{};
+    std::array<sgl::gl_uint, cached_units> g_samplers{};
+
+    bool has_multi_bind() noexcept {
+        return GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_multi_bind;
+    }
+
+    // true when the cache says the unit already holds id, updates the cache otherwise
+    bool swap_cached(std::array<sgl::gl_uint, cached_units> &cache, sgl::gl_uint unit, sgl::gl_uint id) noexcept {
+        if (unit >= cached_units) {
+            return false;
+        }
+        if (cache[unit] == id) {
+            return true;
+        }
+        cache[unit] = id;
+        return false;
+    }
+
+    sgl::gl_uint texture_id(const sgl::texture_bind &b) noexcept {
+        return b.texture ? b.texture->id() : 0;
+    }
+
+    sgl::gl_uint sampler_id(const sgl::texture_bind &b) noexcept {
+        return b.sampler ? b.sampler->id() : 0;
+    }
+
+    void bind_sorted_multi(std::span<const sgl::texture_bind> binds) noexcept {
+        std::array<GLuint, cached_units> tex_ids{};
+        std::array<GLuint, cached_units> smp_ids{};
+
+        std::size_t i = 0;
+        while (i < binds.size()) {
+            // contiguous unit run [i, j)
+            std::size_t j = i + 1;
+            while (j < binds.size() && binds[j].unit == binds[j - 1].unit + 1) {
+                ++j;
+            }
+
+            const auto first = binds[i].unit;
+            const auto count = static_cast<GLsizei>(j - i);
+
+            bool tex_dirty = false;
+            bool smp_dirty = false;
+            for (std::size_t k = i; k < j; ++k) {
+                tex_ids[k - i] = texture_id(binds[k]);
+                smp_ids[k - i] = sampler_id(binds[k]);
+                tex_dirty |= !swap_cached(g_textures, binds[k].unit, tex_ids[k - i]);
+                smp_dirty |= !swap_cached(g_samplers, binds[k].unit, smp_ids[k - i]);
+            }
+
+            if (tex_dirty) {
+                glBindTextures(first, count, tex_ids.data());
+                sgl::metrics::add(sgl::metrics::counter::state_changes);
+            }
+            if (smp_dirty) {
+                glBindSamplers(first, count, smp_ids.data());
+                sgl::metrics::add(sgl::metrics::counter::state_changes);
+            }
+
+            i = j;
+        }
+    }
+
+    void bind_sorted_fallback(std::span<const sgl::texture_bind> binds) noexcept {
+        for (const auto &b: binds) {
+            if (const auto id = texture_id(b); !swap_cached(g_textures, b.unit, id)) {
+                glActiveTexture(GL_TEXTURE0 + b.unit);
+                glBindTexture(GL_TEXTURE_2D, id);
+                sgl::metrics::add(sgl::metrics::counter::state_changes);
+            }
+            if (const auto id = sampler_id(b); !swap_cached(g_samplers, b.unit, id)) {
+                glBindSampler(b.unit, id);
+                sgl::metrics::add(sgl::metrics::counter::state_changes);
+            }
+        }
+    }
+
+    void forget(std::array<sgl::gl_uint, cached_units> &cache, sgl::gl_uint id) noexcept {
+        // GL reverts deleted objects to 0 on every unit of the current context
+        std::replace(cache.begin(), cache.end(), id, 0u);
+    }
+}
+
+namespace sgl {
+    void bind_textures(std::span<const texture_bind> binds) noexcept {
+        // a material rarely exceeds a handful of maps: sort a copy on the stack
+        std::array<texture_bind, cached_units> sorted{};
+
+        while (!binds.empty()) {
+            const std::size_t n = std::min(binds.size(), sorted.size());
+            std::copy_n(binds.begin(), n, sorted.begin());
+            std::sort(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(n),
+                      [](const texture_bind &a, const texture_bind &b) { return a.unit < b.unit; });
+
+#ifndef NDEBUG
+            for (std::size_t i = 1; i < n; ++i) {
+                assert(sorted[i - 1].unit != sorted[i].unit && "bind_textures: duplicate unit");
+            }
+#endif
+
+            const std::span<const texture_bind> batch{sorted.data(), n};
+            if (has_multi_bind()) {
+                bind_sorted_multi(batch);
+            } else {
+                bind_sorted_fallback(batch);
+            }
+
+            binds = binds.subspan(n);
+        }
+    }
+
+    void invalidate_texture_binds() noexcept {
+        g_textures.fill(unknown);
+        g_samplers.fill(unknown);
+    }
+}
+
+namespace sgl::detail {
+    void on_texture_bound(gl_uint unit, gl_uint id) noexcept {
+        swap_cached(g_textures, unit, id);
+    }
+
+    void on_sampler_bound(gl_uint unit, gl_uint id) noexcept {
+        swap_cached(g_samplers, unit, id);
+    }
+
+    void on_texture_deleted(gl_uint id) noexcept {
+        forget(g_textures, id);
+    }
+
+    void on_sampler_deleted(gl_uint id) noexcept {
+        forget(g_samplers, id);
+    }
+}
@@ -0,0 +1,161 @@
+#include "internal/sgl_texture_format.h"
+
+#include <algorithm>
+
+#include "glad/glad.h"
+
+#include "internal/sgl_pixel_convert.h"
+
+namespace sgl {
+    pixel_analysis analyze_pixels(const std::uint8_t *data, gl_int width, gl_int height, gl_int channels) noexcept {
+        pixel_analysis a;
+        if (!data || width <= 0 || height <= 0) {
+            return a;
+        }
+
+        const std::size_t count = static_cast<std::size_t>(width) * height;
+        const bool has_alpha = channels == 2 || channels == 4;
+        const bool has_color = channels >= 3;
+
+        // accumulate with bitwise ops so the loop has no early exit and vectorizes
+        std::uint8_t alpha_and = 0xFF;
+        bool alpha_binary = true;
+        bool gray = true;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint8_t *p = data + i * channels;
+            if (has_alpha) {
+                const std::uint8_t alpha = p[channels - 1];
+                alpha_and &= alpha;
+                alpha_binary &= alpha == 0 || alpha == 0xFF;
+            }
+            if (has_color) {
+                gray &= p[0] == p[1] && p[1] == p[2];
+            }
+        }
+
+        a.opaque = alpha_and == 0xFF;
+        a.binary_alpha = alpha_binary;
+        a.gray = gray;
+        return a;
+    }
+
+    texture_format_choice choose_texture_format(
+        const pixel_analysis &analysis, gl_int channels, bool srgb, texture_compaction compaction, bool normal_map
+    ) noexcept {
+        texture_format_choice c{.source_channels = channels, .channels = channels};
+        if (compaction == texture_compaction::none) {
+            return c;
+        }
+
+        if (normal_map && channels >= 3) {
+            c.channels = 2;
+            c.internal_format = GL_RG8;
+            c.swizzle = {GL_RED, GL_GREEN, GL_ZERO, GL_ONE};
+            return c;
+        }
+
+        // gray+alpha with constant alpha is plain gray
+        if (channels == 2 && analysis.opaque) {
+            c.channels = 1;
+            c.internal_format = GL_R8;
+            c.swizzle = {GL_RED, GL_RED, GL_RED, GL_ONE};
+            return c;
+        }
+
+        // there is no core single-channel sRGB format: sRGB gray stays as it is
+        if (channels >= 3 && analysis.gray && !srgb) {
+            if (analysis.opaque) {
+                c.channels = 1;
+                c.internal_format = GL_R8;
+                c.swizzle = {GL_RED, GL_RED, GL_RED, GL_ONE};
+            } else {
+                c.channels = 2;
+                c.internal_format = GL_RG8;
+                c.swizzle = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+            }
+            return c;
+        }
+
+        // 16-bit formats have no sRGB variant. RGB8 takes 4 bytes a texel anyway, so constant alpha is only
+        // dropped together with a format that is really smaller
+        if (compaction == texture_compaction::lossy && !srgb && channels >= 3) {
+            if (analysis.opaque) {
+                c.channels = 3;
+                c.internal_format = GL_RGB565;
+            } else if (analysis.binary_alpha) {
+                c.internal_format = GL_RGB5_A1;
+            }
+        }
+
+        return c;
+    }
+
+    std::vector<std::uint8_t> repack_pixels(
+        const std::uint8_t *data, gl_int width, gl_int height, const texture_format_choice &choice
+    ) noexcept {
+        std::vector<std::uint8_t> out;
+        if (choice.channels == choice.source_channels) {
+            return out;
+        }
+
+        const std::size_t count = static_cast<std::size_t>(width) * height;
+        const gl_int src_ch = choice.source_channels;
+        out.resize(count * choice.channels);
+
+        if (choice.channels == 1) {
+            extract_channel(data, src_ch, 0, out.data(), count);
+            return out;
+        }
+
+        // 2 kept channels are x/y of a normal map or gray + alpha, 3 are rgb without alpha
+        const gl_int second = choice.swizzle[3] == GL_GREEN ? src_ch - 1 : 1;
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint8_t *p = data + i * src_ch;
+            std::uint8_t *o = out.data() + i * choice.channels;
+            o[0] = p[0];
+            o[1] = p[second];
+            if (choice.channels == 3) {
+                o[2] = p[2];
+            }
+        }
+        return out;
+    }
+
+    gl_sizeiptr texture_vram_bytes(gl_enum internal_format, gl_int width, gl_int height, gl_int levels) noexcept {
+        gl_sizeiptr texel = 4;
+        switch (internal_format) {
+            case GL_R8: texel = 1;
+                break;
+            case GL_RG8:
+            case GL_RGB565:
+            case GL_RGB5_A1: texel = 2;
+                break;
+            case GL_RGBA16F: texel = 8;
+                break;
+            default: break;
+        }
+
+        gl_sizeiptr total = 0;
+        for (gl_int i = 0; i < levels; ++i) {
+            total += static_cast<gl_sizeiptr>(std::max(1, width >> i)) * std::max(1, height >> i) * texel;
+        }
+        return total;
+    }
+
+    const char *internal_format_name(gl_enum internal_format) noexcept {
+        switch (internal_format) {
+            case GL_R8: return "R8";
+            case GL_RG8: return "RG8";
+            case GL_RGB8: return "RGB8";
+            case GL_RGBA8: return "RGBA8";
+            case GL_SRGB8: return "SRGB8";
+            case GL_SRGB8_ALPHA8: return "SRGB8_ALPHA8";
+            case GL_RGB565: return "RGB565";
+            case GL_RGB5_A1: return "RGB5_A1";
+            case GL_RGBA16F: return "RGBA16F";
+            case GL_R11F_G11F_B10F: return "R11F_G11F_B10F";
+            default: return "unknown";
+        }
+    }
+}
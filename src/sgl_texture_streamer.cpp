@@ -0,0 +1,143 @@
+#include "internal/sgl_texture_streamer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+#include "internal/sgl_log.h"
+
+namespace {
+    sgl::gl_sizeiptr level_bytes(const sgl::mip_chain &mips, sgl::gl_int level) noexcept {
+        return static_cast<sgl::gl_sizeiptr>(mips.levels[static_cast<std::size_t>(level)].pixels.size());
+    }
+
+    // finest level whose larger side still covers the requested texel count
+    sgl::gl_int level_for(const sgl::texture_2d &tex, float texels) noexcept {
+        const float full = static_cast<float>(std::max(tex.width(), tex.height()));
+        if (texels <= 0.f) {
+            return tex.levels() - 1;
+        }
+        if (texels >= full) {
+            return 0;
+        }
+        const auto level = static_cast<sgl::gl_int>(std::floor(std::log2(full / texels)));
+        return std::clamp(level, 0, tex.levels() - 1);
+    }
+}
+
+namespace sgl {
+    // fabrics
+
+    texture_streamer texture_streamer::create(const texture_streamer_params &params) noexcept {
+        return texture_streamer{params};
+    }
+
+    // api
+
+    expected<texture_streamer::handle, texture_streamer::error> texture_streamer::add(texture_2d_data data) noexcept {
+        const auto &levels = data.mips.levels;
+        if (levels.empty()) {
+            log_error(log_subsystem::texture, "texture_streamer::add: empty mip chain");
+            return unexpected{error::invalid_params};
+        }
+
+        auto tex = texture_2d::create_empty(
+            levels.front().width, levels.front().height, data.mips.channels,
+            static_cast<gl_int>(levels.size()), data.params
+        );
+        if (!tex) {
+            return unexpected{tex.error()};
+        }
+
+        const gl_int count = tex->levels();
+        tex->set_base_level(count - 1);
+
+        for (gl_int i = 0; i < count; ++i) {
+            m_pending_bytes += level_bytes(data.mips, i);
+        }
+
+        m_entries.push_back(entry{
+            .tex = std::move(*tex),
+            .mips = std::move(data.mips),
+            .resident = count,
+            .wanted = 0,
+        });
+
+        return m_entries.size() - 1;
+    }
+
+    void texture_streamer::request_resolution(handle h, float texels) noexcept {
+        assert(h < m_entries.size());
+
+        auto &e = m_entries[h];
+        e.wanted = level_for(e.tex, texels);
+    }
+
+    void texture_streamer::update() noexcept {
+        gl_sizeiptr uploaded = 0;
+
+        while (entry *e = pick_next()) {
+            const gl_int level = e->resident - 1;
+            const gl_sizeiptr bytes = level_bytes(e->mips, level);
+
+            // always allow one upload per frame, otherwise levels above the budget would never arrive
+            if (uploaded > 0 && uploaded + bytes > m_params.frame_budget_bytes) {
+                break;
+            }
+
+            auto &pixels = e->mips.levels[static_cast<std::size_t>(level)].pixels;
+            e->tex.set_level_data(level, pixels.data());
+            e->tex.set_base_level(level);
+            e->resident = level;
+
+            // the level lives on the GPU now
+            pixels.clear();
+            pixels.shrink_to_fit();
+
+            uploaded += bytes;
+            m_pending_bytes -= bytes;
+        }
+
+        m_uploaded_last_frame = uploaded;
+    }
+
+    const texture_2d &texture_streamer::texture(handle h) const noexcept {
+        assert(h < m_entries.size());
+
+        return m_entries[h].tex;
+    }
+
+    gl_int texture_streamer::resident_level(handle h) const noexcept {
+        assert(h < m_entries.size());
+
+        return m_entries[h].resident;
+    }
+
+    // internal
+
+    texture_streamer::entry *texture_streamer::pick_next() noexcept {
+        // invisible textures first, then the largest gap between resident and wanted level,
+        // ties go to the cheaper upload
+        entry *best = nullptr;
+        gl_int best_gap = 0;
+        gl_sizeiptr best_bytes = 0;
+
+        for (auto &e: m_entries) {
+            if (e.resident <= e.wanted) {
+                continue;
+            }
+
+            const gl_int gap = e.resident == e.tex.levels() ? e.tex.levels() + 1 : e.resident - e.wanted;
+            const gl_sizeiptr bytes = level_bytes(e.mips, e.resident - 1);
+
+            if (!best || gap > best_gap || (gap == best_gap && bytes < best_bytes)) {
+                best = &e;
+                best_gap = gap;
+                best_bytes = bytes;
+            }
+        }
+
+        return best;
+    }
+}
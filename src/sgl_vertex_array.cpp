@@ -6,6 +6,7 @@
 #include "glad/glad.h"
 
 #include "internal/sgl_log.h"
+#include "internal/sgl_metrics.h"
 #include "internal/sgl_util.h"
 
 namespace sgl {
@@ -36,7 +37,7 @@ namespace sgl {
         gl_uint id = 0;
         glGenVertexArrays(1, &id);
         if (id == 0) {
-            log_error("glGenVertexArrays() returned 0");
+            log_error(log_subsystem::buffer, "glGenVertexArrays() returned 0");
             return unexpected{error::gl_gen_vertex_arrays_failed};
         }
         return vertex_array{id};
@@ -58,10 +59,12 @@ namespace sgl {
         assert(m_id);
 
         glBindVertexArray(m_id);
+        metrics::add(metrics::counter::state_changes);
     }
 
     void vertex_array::unbind() noexcept {
         glBindVertexArray(0);
+        metrics::add(metrics::counter::state_changes);
     }
 
     void vertex_array::enable_attrib(gl_uint idx) const noexcept {
@@ -6,6 +6,9 @@
 #include "glad/glad.h"
 
 #include "internal/sgl_log.h"
+#include "internal/sgl_flight_recorder.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_profiler.h"
 #include "internal/sgl_util.h"
 
 namespace sgl {
@@ -37,6 +40,8 @@ namespace sgl {
     // fabrics
 
     vertex_buffer::result vertex_buffer::create(const void *data, gl_sizeiptr size, gl_enum usage) noexcept {
+        SGL_ZONE("vertex_buffer::create");
+
         if (size <= 0) {
             return unexpected{error::invalid_params};
         }
@@ -44,7 +49,7 @@ namespace sgl {
         gl_uint id = 0;
         glGenBuffers(1, &id);
         if (id == 0) {
-            log_error("glGenBuffers() returned 0");
+            log_error(log_subsystem::buffer, "glGenBuffers() returned 0");
             return unexpected{error::gl_gen_buffers_failed};
         }
 
@@ -53,6 +58,9 @@ namespace sgl {
 
         glBindBuffer(GL_ARRAY_BUFFER, id);
         glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+        if (data) {
+            metrics::add(metrics::counter::buffer_bytes, static_cast<std::uint64_t>(size));
+        }
 
 #ifndef NDEBUG
         const bool ok = check_created_size_bound(GL_ARRAY_BUFFER, size);
@@ -63,11 +71,13 @@ namespace sgl {
         glBindBuffer(GL_ARRAY_BUFFER, prev);
 
         if (!ok) {
-            log_error("glBufferData() failed to allocate {} bytes", size);
+            log_error(log_subsystem::buffer, "glBufferData() failed to allocate {} bytes", size);
             glDeleteBuffers(1, &id);
             return unexpected{error::gl_alloc_failed};
         }
 
+        flight_recorder::resource_created(flight_recorder::resource_kind::vertex_buffer, id,
+                                          static_cast<std::uint64_t>(size));
         return vertex_buffer{id, size, usage};
     }
 
@@ -94,16 +104,21 @@ namespace sgl {
     }
 
     void vertex_buffer::set_data(const void *data, gl_sizeiptr size) noexcept {
+        SGL_ZONE("vertex_buffer::set_data");
+
         assert(m_id);
 
         if (size <= 0) {
-            log_error("vertex_buffer::set_data(): invalid size={}", size);
+            log_error(log_subsystem::buffer, "vertex_buffer::set_data(): invalid size={}", size);
             return;
         }
 
         debug_assert_bound(m_id);
 
         glBufferData(GL_ARRAY_BUFFER, size, data, m_usage);
+        if (data) {
+            metrics::add(metrics::counter::buffer_bytes, static_cast<std::uint64_t>(size));
+        }
 
         m_size = size;
     }
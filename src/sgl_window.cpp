@@ -1,9 +1,11 @@
 #include "internal/sgl_window.h"
 
 #include <utility>
-#include <cstdio>
+#include <iterator>
 #include <cassert>
 
+#include <fmt/format.h>
+
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 
@@ -13,13 +15,16 @@
 #include "internal/sgl_backend.h"
 #include "internal/sgl_time.h"
 #include "internal/sgl_input.h"
+#include "internal/sgl_metrics.h"
+#include "internal/sgl_flight_recorder.h"
+#include "internal/sgl_profiler.h"
 
 namespace sgl {
     int window::s_window_count = 0;
 
     // ctors
 
-    window::window(window &&other) noexcept : m_fps_state{std::move(other.m_fps_state)},
+    window::window(window &&other) noexcept : m_frame_state{std::move(other.m_frame_state)},
                                               m_window{std::exchange(other.m_window, nullptr)} {
     }
 
@@ -30,7 +35,7 @@ namespace sgl {
 
         destroy_window();
 
-        m_fps_state = std::move(other.m_fps_state);
+        m_frame_state = std::move(other.m_frame_state);
         m_window = std::exchange(other.m_window, nullptr);
 
         return *this;
@@ -115,20 +120,12 @@ namespace sgl {
     void window::set_show_fps(bool enabled) const noexcept {
         assert(m_window);
 
-        m_fps_state.enabled = enabled;
-
-        if (enabled) {
-            m_fps_state.frames = 0;
-            m_fps_state.cur_fps = 0.0;
-            m_fps_state.last_time = time();
+        m_frame_state.show_fps = enabled;
+        m_frame_state.last_title_time = time();
 
-            if (!m_fps_state.base_title.empty()) {
-                glfwSetWindowTitle(m_window, m_fps_state.base_title.c_str());
-            }
-        } else {
-            if (!m_fps_state.base_title.empty()) {
-                glfwSetWindowTitle(m_window, m_fps_state.base_title.c_str());
-            }
+        if (m_frame_state.title != m_frame_state.base_title) {
+            m_frame_state.title = m_frame_state.base_title;
+            glfwSetWindowTitle(m_window, m_frame_state.title.c_str());
         }
     }
 
@@ -139,17 +136,42 @@ namespace sgl {
     }
 
     void window::swap_buffers() const noexcept {
+        SGL_ZONE("window::swap_buffers");
+
         assert(m_window);
 
+        const std::uint64_t swap_begin_ns = profiler_now_ns();
         glfwSwapBuffers(m_window);
 
         new_frame_time();
+        metrics::end_frame();
+        flight_recorder::end_frame(swap_begin_ns, profiler_now_ns());
 
-        if (m_fps_state.enabled) {
-            count_fps();
+        // not dt(): that one is clamped for simulation, hitches must show up here as they are
+        const double now = time();
+        if (m_frame_state.last_swap >= 0.0) {
+            m_frame_state.times->record((now - m_frame_state.last_swap) * 1000.0);
+        }
+        m_frame_state.last_swap = now;
+
+        if (m_frame_state.show_fps && now - m_frame_state.last_title_time >= m_frame_state.title_interval_sec) {
+            m_frame_state.last_title_time = now;
+            update_title();
         }
     }
 
+    frame_time_stats window::frame_stats() const noexcept {
+        assert(m_window);
+
+        return m_frame_state.times->stats();
+    }
+
+    const frame_time_tracker &window::frame_times() const noexcept {
+        assert(m_window);
+
+        return *m_frame_state.times;
+    }
+
     int window::width() const noexcept {
         assert(m_window);
 
@@ -185,6 +207,8 @@ namespace sgl {
     }
 
     void window::poll_events() noexcept {
+        SGL_ZONE("window::poll_events");
+
         detail::input::new_frame();
         glfwPollEvents();
     }
@@ -231,23 +255,24 @@ namespace sgl {
         detail::input::on_scroll(x_offset, y_offset);
     }
 
-    void window::count_fps() const noexcept {
+    void window::update_title() const noexcept {
         assert(m_window);
 
-        const double now = time();
-        ++m_fps_state.frames;
-
-        if (const auto dt = now - m_fps_state.last_time; dt >= m_fps_state.interval_sec && dt > 0.0) {
-            m_fps_state.cur_fps = static_cast<double>(m_fps_state.frames) / dt;
-            m_fps_state.frames = 0;
-            m_fps_state.last_time = now;
-
-            char buf[128];
-            std::snprintf(
-                buf, sizeof(buf), "%s [%.0f FPS]",
-                m_fps_state.base_title.c_str(),
-                m_fps_state.cur_fps
-            );
+        const frame_time_stats stats = m_frame_state.times->stats();
+        if (stats.frames == 0) {
+            return;
+        }
+
+        char buf[256];
+        const auto res = fmt::format_to_n(
+            buf, sizeof(buf) - 1, "{} [{:.0f} FPS | p99 {:.1f} ms | {} stutters]",
+            m_frame_state.base_title, stats.fps, stats.p99_ms, stats.stutters
+        );
+        *res.out = '\0';
+
+        // glfwSetWindowTitle() is a round trip to the window system: only when the text changes
+        if (m_frame_state.title != buf) {
+            m_frame_state.title = buf;
             glfwSetWindowTitle(m_window, buf);
         }
     }
@@ -309,8 +334,9 @@ namespace sgl {
         }
 
         auto win = window{handle};
-        win.m_fps_state.base_title = title;
-        win.m_fps_state.last_time = time();
+        win.m_frame_state.base_title = title;
+        win.m_frame_state.title = title;
+        win.m_frame_state.title_interval_sec = params->title_interval_sec;
 
         win.set_vsync(params->vsync);
         win.set_cursor_enabled(params->cursor_enabled);
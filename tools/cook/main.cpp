@@ -0,0 +1,425 @@
+/*
+cook a source asset tree into runtime-ready files, one job per file across the sgl workers:
+  images  -> .sgltex: mips prebuilt and optionally compacted, nothing is decoded at runtime
+  shaders -> #include "..." expanded and checked (.vert .frag .geom .comp .tesc .tese; .glsl are include-only)
+  others  -> copied
+a manifest in the output dir keeps a content hash per output (source, includes, options), unchanged
+assets are skipped and outputs whose source is gone are removed
+*/
+
+#include "sgl.h"
+#include "internal/sgl_job.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// bump when the output of any cook step changes
+static constexpr std::string_view cook_version = "sgl_cook 1";
+static constexpr std::string_view manifest_name = ".sgl_cook";
+
+enum class asset_kind { image, shader, shader_include, copy };
+
+struct cook_options {
+    bool srgb = true;
+    bool mips = true;
+    sgl::texture_compaction compaction = sgl::texture_compaction::none;
+    bool force = false;
+};
+
+struct cook_job {
+    asset_kind kind;
+    fs::path src;
+    std::string out_rel;
+};
+
+struct cook_result {
+    std::string out_rel;
+    std::uint64_t key = 0;
+    enum { cooked, skipped, failed } status = failed;
+    std::string message;
+};
+
+using manifest = std::unordered_map<std::string, std::uint64_t>;
+
+static void usage() {
+    std::fputs(
+        "usage: sgl_cook <source dir> <output dir> [options]\n"
+        "  --linear       images are not sRGB (default: color images are sRGB, *_n/*_normal/*_nrm are normal maps)\n"
+        "  --no-mips      base level only\n"
+        "  --compact      lossless format compaction\n"
+        "  --lossy        also RGB565 / RGB5_A1\n"
+        "  --force        ignore the manifest, cook everything\n"
+        "  --pack <file>  also pack the output dir into an .sglpack\n",
+        stderr
+    );
+}
+
+static asset_kind classify(const fs::path &p) {
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    for (const char *e: {".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".gif", ".pnm", ".pgm", ".ppm", ".qoi"}) {
+        if (ext == e) {
+            return asset_kind::image;
+        }
+    }
+    for (const char *e: {".vert", ".frag", ".geom", ".comp", ".tesc", ".tese"}) {
+        if (ext == e) {
+            return asset_kind::shader;
+        }
+    }
+    // .hdr and friends stay float: there is no 8-bit .sgltex for them, they are copied
+    return ext == ".glsl" ? asset_kind::shader_include : asset_kind::copy;
+}
+
+static bool is_normal_map(const fs::path &p) {
+    const std::string stem = p.stem().string();
+    for (std::string_view suffix: {"_n", "_normal", "_nrm"}) {
+        if (std::string_view{stem}.ends_with(suffix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool write_file(const fs::path &path, std::string_view bytes) {
+    std::ofstream f{path, std::ios::binary | std::ios::trunc};
+    f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(f);
+}
+
+static std::uint64_t hash_str(std::string_view s, std::uint64_t h = sgl::fnv1a_64_offset) {
+    return sgl::fnv1a_64(s, h);
+}
+
+// shaders
+
+// comments blanked out (newlines kept) so the checks below do not trip over them
+static std::string strip_comments(std::string_view src) {
+    std::string out{src};
+    for (std::size_t i = 0; i + 1 < out.size(); ++i) {
+        if (out[i] == '/' && out[i + 1] == '/') {
+            while (i < out.size() && out[i] != '\n') {
+                out[i++] = ' ';
+            }
+        } else if (out[i] == '/' && out[i + 1] == '*') {
+            out[i] = out[i + 1] = ' ';
+            i += 2;
+            while (i + 1 < out.size() && !(out[i] == '*' && out[i + 1] == '/')) {
+                if (out[i] != '\n') {
+                    out[i] = ' ';
+                }
+                ++i;
+            }
+            if (i + 1 < out.size()) {
+                out[i] = out[i + 1] = ' ';
+                ++i;
+            }
+        }
+    }
+    return out;
+}
+
+// empty when the source looks like a complete shader
+static std::string validate_shader(std::string_view src) {
+    const std::string code = strip_comments(src);
+
+    const std::size_t first = code.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos || code.compare(first, 8, "#version") != 0) {
+        return "#version must come first";
+    }
+
+    int braces = 0, parens = 0, brackets = 0;
+    for (const char c: code) {
+        braces += c == '{' ? 1 : c == '}' ? -1 : 0;
+        parens += c == '(' ? 1 : c == ')' ? -1 : 0;
+        brackets += c == '[' ? 1 : c == ']' ? -1 : 0;
+        if (braces < 0 || parens < 0 || brackets < 0) {
+            return "unbalanced closing bracket";
+        }
+    }
+    if (braces != 0 || parens != 0 || brackets != 0) {
+        return "unbalanced brackets";
+    }
+
+    if (code.find("void main") == std::string::npos) {
+        return "no main()";
+    }
+    return {};
+}
+
+// jobs
+
+static cook_result cook(const cook_job &job, const fs::path &out_root, const cook_options &opt, const manifest &old) {
+    cook_result r;
+    r.out_rel = job.out_rel;
+    const fs::path out = out_root / job.out_rel;
+
+    const auto up_to_date = [&](std::uint64_t key) {
+        const auto it = old.find(job.out_rel);
+        return !opt.force && it != old.end() && it->second == key && fs::exists(out);
+    };
+
+    if (job.kind == asset_kind::shader) {
+        sgl::shader_source expanded;
+        if (!sgl::expand_shader_includes(job.src.string().c_str(), expanded, r.message)) {
+            return r;
+        }
+        const std::string &src = expanded.text;
+
+        // the expanded text covers the includes too
+        r.key = hash_str(src, hash_str(cook_version));
+        if (up_to_date(r.key)) {
+            r.status = cook_result::skipped;
+            return r;
+        }
+
+        r.message = validate_shader(src);
+        if (!r.message.empty()) {
+            return r;
+        }
+        if (!write_file(out, src)) {
+            r.message = "cannot write " + out.string();
+            return r;
+        }
+        r.status = cook_result::cooked;
+        return r;
+    }
+
+    const auto file = sgl::mapped_file::create(job.src.string());
+    if (!file) {
+        r.message = "cannot read " + job.src.string();
+        return r;
+    }
+
+    if (job.kind == asset_kind::copy) {
+        r.key = hash_str(file->text(), hash_str(cook_version));
+        if (up_to_date(r.key)) {
+            r.status = cook_result::skipped;
+            return r;
+        }
+        if (!write_file(out, file->text())) {
+            r.message = "cannot write " + out.string();
+            return r;
+        }
+        r.status = cook_result::cooked;
+        return r;
+    }
+
+    sgl::texture_2d_params params{};
+    params.generate_mipmaps = opt.mips;
+    params.compaction = opt.compaction;
+    params.normal_map = is_normal_map(job.src);
+    params.srgb = opt.srgb && !params.normal_map;
+    if (params.normal_map && params.compaction == sgl::texture_compaction::none) {
+        params.compaction = sgl::texture_compaction::lossless;
+    }
+
+    const std::string settings = std::to_string(params.generate_mipmaps) + std::to_string(params.srgb) +
+                                 std::to_string(params.normal_map) +
+                                 std::to_string(static_cast<int>(params.compaction));
+    r.key = hash_str(file->text(), hash_str(settings, hash_str(cook_version)));
+    if (up_to_date(r.key)) {
+        r.status = cook_result::skipped;
+        return r;
+    }
+
+    const auto data = sgl::texture_2d::load_data(job.src.string(), params);
+    if (!data) {
+        r.message = "cannot decode " + job.src.string();
+        return r;
+    }
+    if (!sgl::texture_2d::write_sgltex(out.string(), *data)) {
+        r.message = "cannot write " + out.string();
+        return r;
+    }
+    r.status = cook_result::cooked;
+    return r;
+}
+
+static manifest read_manifest(const fs::path &path) {
+    manifest m;
+    std::ifstream f{path};
+    std::string header;
+    if (!std::getline(f, header) || header != cook_version) {
+        return m; // missing or from another version: everything is rebuilt
+    }
+
+    std::string key, rel;
+    while (f >> key && std::getline(f >> std::ws, rel)) {
+        m[rel] = std::stoull(key, nullptr, 16);
+    }
+    return m;
+}
+
+static bool write_manifest(const fs::path &path, const std::vector<cook_result> &results) {
+    std::ofstream f{path, std::ios::trunc};
+    f << cook_version << '\n';
+    for (const auto &r: results) {
+        if (r.status != cook_result::failed) {
+            char key[17];
+            std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(r.key));
+            f << key << ' ' << r.out_rel << '\n';
+        }
+    }
+    return static_cast<bool>(f);
+}
+
+static bool write_pack(const fs::path &out_root, const char *pack_path) {
+    std::vector<sgl::pack_source> sources;
+    for (const auto &e: fs::recursive_directory_iterator{out_root}) {
+        if (e.is_regular_file() && e.path().filename() != manifest_name) {
+            sources.push_back(sgl::pack_source{
+                .name = e.path().lexically_relative(out_root).generic_string(),
+                .path = e.path().string(),
+            });
+        }
+    }
+    std::sort(sources.begin(), sources.end(), [](const auto &a, const auto &b) { return a.name < b.name; });
+    return sgl::pack::write(pack_path, sources);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    const fs::path src_root{argv[1]};
+    const fs::path out_root{argv[2]};
+    const char *pack_path = nullptr;
+
+    cook_options opt{};
+    for (int i = 3; i < argc; ++i) {
+        const std::string_view a{argv[i]};
+        if (a == "--linear") {
+            opt.srgb = false;
+        } else if (a == "--no-mips") {
+            opt.mips = false;
+        } else if (a == "--compact") {
+            opt.compaction = sgl::texture_compaction::lossless;
+        } else if (a == "--lossy") {
+            opt.compaction = sgl::texture_compaction::lossy;
+        } else if (a == "--force") {
+            opt.force = true;
+        } else if (a == "--pack" && i + 1 < argc) {
+            pack_path = argv[++i];
+        } else {
+            std::fprintf(stderr, "sgl_cook: unknown option '%s'\n", argv[i]);
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::error_code ec;
+    std::vector<cook_job> jobs;
+    for (fs::recursive_directory_iterator it{src_root, ec}, end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file()) {
+            continue;
+        }
+
+        const fs::path rel = it->path().lexically_relative(src_root);
+        const asset_kind kind = classify(rel);
+        if (kind == asset_kind::shader_include) {
+            continue;
+        }
+
+        fs::path out_rel = rel;
+        if (kind == asset_kind::image) {
+            out_rel.replace_extension(".sgltex");
+        }
+        jobs.push_back(cook_job{.kind = kind, .src = it->path(), .out_rel = out_rel.generic_string()});
+    }
+    if (ec) {
+        std::fprintf(stderr, "sgl_cook: failed to walk '%s': %s\n", argv[1], ec.message().c_str());
+        return EXIT_FAILURE;
+    }
+    std::sort(jobs.begin(), jobs.end(), [](const auto &a, const auto &b) { return a.out_rel < b.out_rel; });
+
+    // a.png and a.jpg both cook to a.sgltex: two workers would write the same file
+    std::size_t collisions = 0;
+    for (std::size_t i = 1; i < jobs.size(); ++i) {
+        if (jobs[i].out_rel == jobs[i - 1].out_rel) {
+            std::fprintf(stderr, "sgl_cook: '%s' and '%s' both cook to '%s'\n", jobs[i - 1].src.string().c_str(),
+                         jobs[i].src.string().c_str(), jobs[i].out_rel.c_str());
+            ++collisions;
+        }
+    }
+    if (collisions > 0) {
+        return EXIT_FAILURE;
+    }
+
+    // directories up front, the workers only write files
+    for (const auto &job: jobs) {
+        fs::create_directories((out_root / job.out_rel).parent_path(), ec);
+    }
+
+    const fs::path manifest_path = out_root / manifest_name;
+    const manifest old = read_manifest(manifest_path);
+
+    std::vector<std::future<cook_result> > futures;
+    futures.reserve(jobs.size());
+    for (const auto &job: jobs) {
+        futures.push_back(sgl::detail::async([&job, &out_root, &opt, &old] { return cook(job, out_root, opt, old); }));
+    }
+
+    std::vector<cook_result> results;
+    results.reserve(jobs.size());
+    std::size_t cooked = 0, skipped = 0, failed = 0;
+    for (auto &f: futures) {
+        results.push_back(f.get());
+        const auto &r = results.back();
+        if (r.status == cook_result::cooked) {
+            ++cooked;
+        } else if (r.status == cook_result::skipped) {
+            ++skipped;
+        } else {
+            ++failed;
+            std::fprintf(stderr, "sgl_cook: %s: %s\n", r.out_rel.c_str(), r.message.c_str());
+        }
+    }
+
+    // outputs whose source was removed or renamed
+    std::unordered_set<std::string_view> live;
+    for (const auto &r: results) {
+        live.insert(r.out_rel);
+    }
+    std::size_t removed = 0;
+    for (const auto &[rel, key]: old) {
+        if (!live.contains(rel) && fs::remove(out_root / rel, ec)) {
+            ++removed;
+        }
+    }
+
+    if (!write_manifest(manifest_path, results)) {
+        std::fprintf(stderr, "sgl_cook: failed to write '%s'\n", manifest_path.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (pack_path && !write_pack(out_root, pack_path)) {
+        std::fprintf(stderr, "sgl_cook: failed to write '%s'\n", pack_path);
+        return EXIT_FAILURE;
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf(
+        "sgl_cook: %zu cooked, %zu up to date, %zu failed, %zu removed in %.1f ms (%zu workers)\n",
+        cooked, skipped, failed, removed, ms, sgl::detail::worker_count()
+    );
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,38 @@
+/*
+turn a binary log (sgl::set_log_binary) into the text it would have printed
+*/
+
+#include "sgl.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+static void usage() {
+    std::fputs(
+        "usage: sgl_logdec <file.sgllog> [output.txt]\n"
+        "  without an output the text goes to stdout\n",
+        stderr
+    );
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = stdout;
+    if (argc == 3) {
+        out = std::fopen(argv[2], "wb");
+        if (!out) {
+            std::fprintf(stderr, "sgl_logdec: failed to open '%s'\n", argv[2]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const bool ok = sgl::decode_log(argv[1], out);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,85 @@
+/*
+pack a directory into an .sglpack (names are paths relative to the directory), or list one
+*/
+
+#include "sgl.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static void usage() {
+    std::fputs(
+        "usage: sgl_pack <dir> <output.sglpack> [--store]\n"
+        "       sgl_pack --list <file.sglpack>\n"
+        "  --store  no LZ4, every entry is readable in place from the mapping\n",
+        stderr
+    );
+}
+
+static int list(const char *path) {
+    const auto p = sgl::pack::create(path);
+    if (!p) {
+        std::fprintf(stderr, "sgl_pack: failed to open '%s': %s\n", path, sgl::pack::err_to_str(p.error()));
+        return EXIT_FAILURE;
+    }
+
+    std::size_t size = 0, stored = 0;
+    for (std::size_t i = 0; i < p->size(); ++i) {
+        const auto e = p->entry(i);
+        std::printf(
+            "%10zu %10zu %s %.*s\n",
+            e.size, e.stored_size, e.compressed ? "lz4" : "raw", static_cast<int>(e.name.size()), e.name.data()
+        );
+        size += e.size;
+        stored += e.stored_size;
+    }
+    std::printf("%zu entries, %zu -> %zu bytes\n", p->size(), size, stored);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && std::string_view{argv[1]} == "--list") {
+        return list(argv[2]);
+    }
+
+    if (argc < 3 || argc > 4 || (argc == 4 && std::string_view{argv[3]} != "--store")) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    const fs::path root{argv[1]};
+    const bool compress = argc == 3;
+
+    std::vector<sgl::pack_source> sources;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it{root, ec}, end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        sources.push_back(sgl::pack_source{
+            .name = it->path().lexically_relative(root).generic_string(),
+            .path = it->path().string(),
+        });
+    }
+    if (ec) {
+        std::fprintf(stderr, "sgl_pack: failed to walk '%s': %s\n", argv[1], ec.message().c_str());
+        return EXIT_FAILURE;
+    }
+
+    // stable output for the same input
+    std::sort(sources.begin(), sources.end(), [](const auto &a, const auto &b) { return a.name < b.name; });
+
+    if (!sgl::pack::write(argv[2], sources, compress)) {
+        std::fprintf(stderr, "sgl_pack: failed to write '%s'\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    std::printf("sgl_pack: %zu files -> %s\n", sources.size(), argv[2]);
+    return EXIT_SUCCESS;
+}
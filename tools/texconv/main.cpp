@@ -0,0 +1,125 @@
+/*
+convert any image stb_image reads (or .qoi) to .sgltex (mips prebuilt, upload-ready) or .qoi
+*/
+
+#include "sgl.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+static void usage() {
+    std::fputs(
+        "usage: sgl_texconv <input> <output.sgltex|output.qoi> [options]\n"
+        "  --srgb         color is sRGB encoded (gamma-correct mips, SRGB8 formats)\n"
+        "  --no-mips      base level only\n"
+        "  --premultiply  store premultiplied alpha\n"
+        "  --compact      lossless format compaction (R8/RG8 for gray, drop constant alpha)\n"
+        "  --lossy        also RGB565 / RGB5_A1\n"
+        "  --normal-map   keep x/y only (RG8)\n"
+        "  --no-flip      keep rows top-down (default flips for GL, like create_from_file)\n",
+        stderr
+    );
+}
+
+static bool write_file(const char *path, const std::vector<std::uint8_t> &bytes) {
+    FILE *f = std::fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    const bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+static bool write_qoi(const char *path, const sgl::mip_level &level, sgl::gl_int channels) {
+    const std::size_t count = static_cast<std::size_t>(level.width) * level.height;
+
+    // qoi only knows rgb and rgba: widen gray
+    std::vector<std::uint8_t> wide;
+    const std::uint8_t *pixels = level.pixels.data();
+    sgl::gl_int out_channels = channels;
+    if (channels <= 2) {
+        out_channels = channels + 2;
+        wide.resize(count * out_channels);
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint8_t *s = pixels + i * channels;
+            std::uint8_t *d = wide.data() + i * out_channels;
+            d[0] = d[1] = d[2] = s[0];
+            if (channels == 2) {
+                d[3] = s[1];
+            }
+        }
+        pixels = wide.data();
+    }
+
+    std::vector<std::uint8_t> qoi;
+    return sgl::encode_qoi(pixels, level.width, level.height, out_channels, qoi) && write_file(path, qoi);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    const char *in = argv[1];
+    const char *out = argv[2];
+    const std::string_view out_sv{out};
+    const bool to_qoi = out_sv.ends_with(".qoi");
+
+    if (!to_qoi && !out_sv.ends_with(".sgltex")) {
+        std::fprintf(stderr, "sgl_texconv: output must end in .sgltex or .qoi\n");
+        return EXIT_FAILURE;
+    }
+
+    sgl::texture_2d_params params{};
+    for (int i = 3; i < argc; ++i) {
+        const std::string_view a{argv[i]};
+        if (a == "--srgb") {
+            params.srgb = true;
+        } else if (a == "--no-mips") {
+            params.generate_mipmaps = false;
+        } else if (a == "--premultiply") {
+            params.premultiply_alpha = true;
+        } else if (a == "--compact") {
+            params.compaction = sgl::texture_compaction::lossless;
+        } else if (a == "--lossy") {
+            params.compaction = sgl::texture_compaction::lossy;
+        } else if (a == "--normal-map") {
+            params.normal_map = true;
+            if (params.compaction == sgl::texture_compaction::none) {
+                params.compaction = sgl::texture_compaction::lossless;
+            }
+        } else if (a == "--no-flip") {
+            params.flip_vertically_on_load = false;
+        } else {
+            std::fprintf(stderr, "sgl_texconv: unknown option '%s'\n", argv[i]);
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (to_qoi) {
+        // a plain image: no mips, no format games, rows as they are in the source
+        params.generate_mipmaps = false;
+        params.compaction = sgl::texture_compaction::none;
+        params.flip_vertically_on_load = false;
+    }
+
+    const auto data = sgl::texture_2d::load_data(in, params);
+    if (!data) {
+        std::fprintf(stderr, "sgl_texconv: failed to load '%s'\n", in);
+        return EXIT_FAILURE;
+    }
+
+    const bool ok = to_qoi
+                        ? write_qoi(out, data->mips.levels.front(), data->mips.channels)
+                        : sgl::texture_2d::write_sgltex(out, *data);
+    if (!ok) {
+        std::fprintf(stderr, "sgl_texconv: failed to write '%s'\n", out);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}